@@ -12,6 +12,11 @@ let analytics_data = {
 	fs_total: <number[]>[],
 	core_temp: <number[]>[],
 	lps: <number[]>[], // 🌙
+	current_estimate: <number[]>[], // 🌙
+	current: <number[]>[], // 🌙
+	frame_jitter: <number[]>[], // 🌙
+	frame_overruns: <number[]>[], // 🌙
+	changed: <number[]>[], // 🌙
 	free_psram: <number[]>[],
 	used_psram: <number[]>[],
 	psram_size: <number[]>[],
@@ -43,6 +48,11 @@ function createAnalytics() {
 				fs_total: [...analytics_data.fs_total, content.fs_total / 1000].slice(-maxAnalyticsData),
 				core_temp: [...analytics_data.core_temp, content.core_temp].slice(-maxAnalyticsData),
 				lps: [...analytics_data.lps, content.lps].slice(-maxAnalyticsData), // 🌙
+				current_estimate: [...analytics_data.current_estimate, content.current_estimate].slice(-maxAnalyticsData), // 🌙
+				current: [...analytics_data.current, content.current ?? NaN].slice(-maxAnalyticsData), // 🌙 NaN: not drawn
+				frame_jitter: [...analytics_data.frame_jitter, content.frame_jitter].slice(-maxAnalyticsData), // 🌙
+				frame_overruns: [...analytics_data.frame_overruns, content.frame_overruns].slice(-maxAnalyticsData), // 🌙
+				changed: [...analytics_data.changed, content.changed].slice(-maxAnalyticsData), // 🌙
 				free_psram: [...analytics_data.free_psram, content.free_psram / 1000].slice(-maxAnalyticsData),
 				used_psram: [...analytics_data.used_psram, content.used_psram / 1000].slice(-maxAnalyticsData),
 				psram_size: [...analytics_data.psram_size, content.psram_size / 1000].slice(-maxAnalyticsData),
@@ -1,3 +1,5 @@
+import msgpack from 'msgpack-lite';
+
 function isLowerCase(s: string) {
     return s.toLowerCase() == s
 }
@@ -34,3 +36,87 @@ export function getTimeAgo(timestamp: number, currentTime: number = Date.now()):
     if (minutes > 0) return `${minutes} minute${minutes > 1 ? 's' : ''} ago`;
     return `${seconds} second${seconds > 1 ? 's' : ''} ago`;
 }
+
+let crcTable: Uint32Array | null = null;
+
+// CRC-32 (as zlib), crc: of the previous bytes, to calculate it chunk by chunk
+export function crc32(bytes: Uint8Array, crc: number = 0): number {
+    if (!crcTable) {
+        crcTable = new Uint32Array(256);
+        for (let n = 0; n < 256; n++) {
+            let c = n;
+            for (let k = 0; k < 8; k++) c = c & 1 ? 0xedb88320 ^ (c >>> 1) : c >>> 1;
+            crcTable[n] = c;
+        }
+    }
+    crc = ~crc;
+    for (let i = 0; i < bytes.length; i++) crc = crcTable[(crc ^ bytes[i]) & 0xff] ^ (crc >>> 8);
+    return ~crc >>> 0;
+}
+
+// send a file to the device in chunks (see FileManager::uploadChunk), the last chunk has the CRC of the file.
+// A failed chunk is resent from the size the device received. Returns true if the file is written
+export async function uploadFile(path: string, data: Blob, authorization: string, chunkSize: number = 32 * 1024): Promise<boolean> {
+    let offset = 0;
+    let crc = 0;
+    let retries = 3;
+    while (offset < data.size || offset == 0) {
+        const chunk = new Uint8Array(await data.slice(offset, offset + chunkSize).arrayBuffer());
+        const chunkCrc = crc32(chunk, crc);
+        const last = offset + chunk.length >= data.size;
+        let url = '/rest/FileManager/upload?path=' + encodeURIComponent(path) + '&offset=' + offset;
+        if (last) url += '&crc=' + chunkCrc.toString(16).padStart(8, '0');
+        try {
+            const response = await fetch(url, {
+                method: 'POST',
+                headers: { Authorization: authorization, 'Content-Type': 'application/octet-stream' },
+                body: chunk
+            });
+            if (response.status == 200) {
+                offset += chunk.length;
+                crc = chunkCrc;
+                if (last) return true;
+                continue;
+            }
+            if (response.status != 409) return false;
+            // device has a different size: start again (sizes in between are not kept on the client)
+            offset = 0;
+            crc = 0;
+        } catch (error) {
+            console.error('uploadFile', path, error);
+        }
+        if (--retries < 0) return false;
+    }
+    return true;
+}
+
+// GET a module url as MsgPack (see Module::send), JSON if the device sends JSON
+export async function fetchMsgPack(url: string, authorization: string, headers: Record<string, string> = {}): Promise<Response> {
+    return fetch(url, { method: 'GET', headers: { Authorization: authorization, Accept: 'application/msgpack', ...headers } });
+}
+
+export async function decodeResponse(response: Response): Promise<any> {
+    if (response.headers.get('Content-Type')?.includes('application/msgpack')) return msgpack.decode(new Uint8Array(await response.arrayBuffer()));
+    return response.json();
+}
+
+// the definition of a module is kept in localStorage with its ETag (hash), it is only downloaded again if it changed on the device (see Module::sendDefinition)
+export async function fetchDefinition(moduleName: string, authorization: string): Promise<any> {
+    const key = 'definition.' + moduleName;
+    let cached: { etag: string; definition: any } | null = null;
+    try {
+        cached = JSON.parse(localStorage.getItem(key) || 'null');
+    } catch {
+        cached = null;
+    }
+    const response = await fetchMsgPack('/rest/' + moduleName + 'Def', authorization, cached ? { 'If-None-Match': cached.etag } : {});
+    if (response.status == 304 && cached) return cached.definition;
+    const definition = await decodeResponse(response);
+    const etag = response.headers.get('ETag');
+    try {
+        if (etag) localStorage.setItem(key, JSON.stringify({ etag, definition }));
+    } catch {
+        // storage full: not cached
+    }
+    return definition;
+}
@@ -94,10 +94,29 @@ function createWebSocket() {
 		send({ event, data });
 	}
 
+	// 🌙 set one scalar control of a node without sending the whole module, see ControlMessage.h
+	function sendControl(moduleName: string, nodeIndex: number, controlIndex: number, value: number, isFloat: boolean = false) {
+		if (!ws || ws.readyState !== WebSocket.OPEN) return false;
+		let hash = 2166136261; // FNV-1a of the module name
+		for (const c of new TextEncoder().encode(moduleName)) hash = Math.imul(hash ^ c, 16777619) >>> 0;
+		const view = new DataView(new ArrayBuffer(13));
+		view.setUint8(0, 0xc1); // marker, never used by MsgPack
+		view.setUint8(1, 1); // version
+		view.setUint32(2, hash, true);
+		view.setUint8(6, nodeIndex);
+		view.setUint8(7, controlIndex);
+		view.setUint8(8, isFloat ? 1 : 0);
+		if (isFloat) view.setFloat32(9, value, true);
+		else view.setInt32(9, Math.round(value), true);
+		ws.send(view.buffer);
+		return true;
+	}
+
 	return {
 		subscribe,
 		send,
 		sendEvent,
+		sendControl,
 		init,
 		on: <T>(event: string, listener: (data: T) => void): (() => void) => {
 			let eventListeners = listeners.get(event);
@@ -99,6 +99,11 @@ export type Analytics = {
 	fs_used: number;
 	uptime: number;
 	lps: number; // 🌙
+	current_estimate: number; // 🌙
+	current?: number; // 🌙 only with a current sensor
+	frame_jitter: number; // 🌙 ms
+	frame_overruns: number; // 🌙
+	changed: number; // 🌙 %
 };
 
 export type RSSI = {
@@ -5,8 +5,10 @@ export type FilesState = {
 	size: number;
 	time: number;
 	contents: string;
-	files: FilesState[];
+	count?: number; // folders: number of files and folders in it
 	fs_total: number;
 	fs_used: number;
-	showHidden: boolean
+	showHidden: boolean;
+	nrOfFiles?: number; // in the index of the device
+	changed?: string[]; // paths changed since the last update
 };
\ No newline at end of file
@@ -26,6 +26,11 @@ class AnalyticsService
 {
 public:
     uint16_t lps = 0; // 🌙
+    float currentEstimate = 0; // 🌙 A, LED current estimated from the lights
+    float current = -1; // 🌙 A, measured, -1: no current sensor
+    uint32_t frameJitter = 0; // 🌙 µs, average late start of a frame (frame pacing)
+    uint16_t frameOverruns = 0; // 🌙 frames per second which missed their deadline
+    uint8_t changed = 0; // 🌙 % of the channels changed in the last frame (dirty tracking)
 
     AnalyticsService(EventSocket *socket) : _socket(socket) {};
 
@@ -52,6 +57,11 @@ public:
             doc["fs_total"] = ESPFS.totalBytes();
             doc["core_temp"] = temperatureRead();
             doc["lps"] = lps; // 🌙
+            doc["current_estimate"] = currentEstimate; // 🌙
+            if (current >= 0) doc["current"] = current; // 🌙
+            doc["frame_jitter"] = frameJitter / 1000.0; // 🌙 ms
+            doc["frame_overruns"] = frameOverruns; // 🌙
+            doc["changed"] = changed; // 🌙
             if (psramFound())
             {
                 doc["free_psram"] = ESP.getFreePsram();
@@ -59,6 +59,13 @@ esp_err_t EventSocket::onFrame(PsychicWebSocketRequest *request, httpd_ws_frame
     ESP_LOGV(SVK_TAG, "ws[%s][%u] opcode[%d]", request->client()->remoteIP().toString().c_str(),
              request->client()->socket(), frame->type);
 
+    // 🌙 fast path: no JsonDocument for binary messages with their own callback
+    if (frame->type == HTTPD_WS_TYPE_BINARY && binary_callback && frame->len && frame->payload[0] == binary_marker)
+    {
+        binary_callback(frame->payload, frame->len, request->client()->socket());
+        return ESP_OK;
+    }
+
     JsonDocument doc;
 #if FT_ENABLED(EVENT_USE_JSON)
     if (frame->type == HTTPD_WS_TYPE_TEXT)
@@ -252,6 +259,13 @@ void EventSocket::onSubscribe(String event, SubscribeCallback callback)
     ESP_LOGI(SVK_TAG, "onSubscribe for event: %s", event.c_str());
 }
 
+// 🌙
+void EventSocket::onBinary(uint8_t marker, BinaryCallback callback)
+{
+    binary_marker = marker;
+    binary_callback = callback;
+}
+
 bool EventSocket::isEventValid(String event)
 {
     return std::find(events.begin(), events.end(), event) != events.end();
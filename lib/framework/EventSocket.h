@@ -26,6 +26,7 @@
 
 typedef std::function<void(JsonObject &root, int originId)> EventCallback;
 typedef std::function<void(const String &originId)> SubscribeCallback;
+typedef std::function<void(const uint8_t *data, size_t len, int originId)> BinaryCallback; // 🌙
 
 class EventSocket
 {
@@ -40,6 +41,10 @@ public:
 
     void onSubscribe(String event, SubscribeCallback callback);
 
+    // 🌙 binary frames starting with marker are passed as is to callback, not parsed as an event (e.g. control updates, see ControlMessage.h)
+    // marker must be a byte which does not start a MsgPack event (0xC1 is never used by MsgPack)
+    void onBinary(uint8_t marker, BinaryCallback callback);
+
     void emitEvent(const String& event, const JsonObject& jsonObject, const char *originId = "", bool onlyToSameOrigin = false);
     void emitEvent(const JsonDocument &doc, const char *originId = "", bool onlyToSameOrigin = false); // 🌙 jsonDocument contains event
     // if onlyToSameOrigin == true, the message will be sent to the originId only, otherwise it will be broadcasted to all clients except the originId
@@ -57,6 +62,8 @@ private:
     std::map<String, std::list<int>> client_subscriptions;
     std::map<String, std::list<EventCallback>> event_callbacks;
     std::map<String, std::list<SubscribeCallback>> subscribe_callbacks;
+    uint8_t binary_marker = 0;       // 🌙
+    BinaryCallback binary_callback;  // 🌙
     void handleEventCallbacks(String event, JsonObject &jsonObject, int originId);
     void handleSubscribeCallbacks(String event, const String &originId);
 
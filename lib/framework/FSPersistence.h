@@ -19,6 +19,7 @@
 #include <FS.h>
 
 inline std::vector<std::function<void(char)>> delayedWrites; // 🌙 Global vector to store delayed write functions (not in FSPersistence as it has to be used for all T types)
+inline std::function<void(const char *path, const char *originId)> fileChanged = nullptr; // 🌙 call after writing or removing a file, set by the File Manager to keep its index up to date
 
 template <class T>
 class FSPersistence
@@ -88,6 +89,7 @@ public:
         // serialize the data to the file
         serializeJson(jsonDocument, settingsFile);
         settingsFile.close();
+        if (fileChanged) fileChanged(_filePath.c_str(), "FSPersistence"); // 🌙
         return true;
     }
 
@@ -183,6 +183,15 @@ inline bool equalAZaz09(const char* a, const char* b) {
   return true;
 }
 
+// FNV-1a hash of the alphanumeric characters of a char string: equalAZaz09 strings have the same hash
+inline uint32_t hashAZaz09(const char* a) {
+  uint32_t hash = 2166136261;
+  if (a == nullptr) return hash;
+  for (; *a; a++)
+    if ((*a >= '0' && *a <= '9') || (*a >= 'A' && *a <= 'Z') || (*a >= 'a' && *a <= 'z')) hash = (hash ^ (uint8_t)*a) * 16777619;
+  return hash;
+}
+
 inline bool contains(const char* a, const char* b) {
   if (a == nullptr || b == nullptr) {
     return false;
@@ -0,0 +1,75 @@
+/**
+    @title     MoonBase
+    @file      ControlMessage.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/develop/modules/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#pragma once
+
+// Binary message to set one scalar control of a node (slider, number, select, pin, checkbox), sent by the UI while a control is moved.
+// Decoding is tested with messages built as socket.ts does in test/test_control_message.
+//
+// Instead of sending the whole module as JSON (deserializeJson, compareRecursive over the state, postUpdate), the UI sends 13 bytes:
+//   [0]     marker 0xC1: never used by MsgPack, so a binary frame starting with it is not an event
+//   [1]     version
+//   [2..5]  FNV-1a hash of the module name, little endian
+//   [6]     node index in the module
+//   [7]     control index in the node
+//   [8]     value type: 0 int32, 1 float32
+//   [9..12] value, little endian
+// See socket.ts sendControl for the sending side.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace ControlMessage {
+
+static const uint8_t marker = 0xC1;
+static const uint8_t version = 1;
+static const uint8_t size = 13;
+
+enum ValueType { value_int, value_float };
+
+struct Message {
+  uint32_t moduleHash = 0;
+  uint8_t node = 0;
+  uint8_t control = 0;
+  uint8_t type = value_int;
+  union {
+    int32_t i;
+    float f;
+  } value = {0};
+
+  int32_t asInt() const { return type == value_float ? (int32_t)value.f : value.i; }
+  float asFloat() const { return type == value_float ? value.f : (float)value.i; }
+};
+
+inline uint32_t hash(const char* s) {
+  uint32_t hash = 2166136261;
+  while (*s) hash = (hash ^ (uint8_t)*s++) * 16777619;
+  return hash;
+}
+
+inline uint32_t get32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+inline bool isControlMessage(const uint8_t* data, size_t len) { return len >= 1 && data[0] == marker; }
+
+// false if data is not a valid message of this version
+inline bool decode(const uint8_t* data, size_t len, Message& message) {
+  if (len != size || data[0] != marker || data[1] != version || data[8] > value_float) return false;
+  message.moduleHash = get32(data + 2);
+  message.node = data[6];
+  message.control = data[7];
+  message.type = data[8];
+  uint32_t raw = get32(data + 9);
+  memcpy(&message.value, &raw, sizeof(raw));
+  return true;
+}
+
+}  // namespace ControlMessage
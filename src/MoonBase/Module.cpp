@@ -13,8 +13,12 @@
 
   #include "Module.h"
 
+  #include <esp_rom_crc.h>
+
 JsonDocument* gModulesDoc = nullptr;
 
+UpdateBus updateBus;
+
 void setDefaults(JsonObject controls, JsonArray definition) {
   for (JsonObject control : definition) {
     // if (control["type"] == "coord3Dxx") {
@@ -307,7 +311,7 @@ StateUpdateResult ModuleState::update(JsonObject& newData, ModuleState& state, c
 
 Module::Module(const String& moduleName, PsychicHttpServer* server, ESP32SvelteKit* sveltekit)
     : _socket(sveltekit->getSocket()),
-      _fsPersistence(ModuleState::read, ModuleState::update, this, sveltekit->getFS(), String("/.config/" + moduleName + ".json").c_str(), true)  // 🌙 true: delayedWrites
+      _persistence(this, sveltekit->getFS(), String("/.config/" + moduleName + ".json").c_str())  // delayed writes: on save
 {
   _moduleName = moduleName;
 
@@ -322,7 +326,7 @@ Module::Module(const String& moduleName, PsychicHttpServer* server, ESP32SvelteK
 void Module::begin() {
   EXT_LOGV(MB_TAG, "");
 
-  _fsPersistence.readFromFS();  // overwrites the default settings in state
+  _persistence.readFromFS();  // overwrites the default settings in state
 
   // no virtual functions in constructor so this is in begin()
   _state.setupDefinition = [&](const JsonArray& controls) {
@@ -331,18 +335,89 @@ void Module::begin() {
   // _state.setupDefinition = this->setupDefinition;
   _state.setupData();  // if no data readFromFS, using overridden virtual function setupDefinition
 
-  _server->on(String("/rest/" + _moduleName + "Def").c_str(), HTTP_GET, [&](PsychicRequest* request) {
-    PsychicJsonResponse response = PsychicJsonResponse(request, false);
-    JsonArray controls = response.getRoot().to<JsonArray>();
+  _server->on(String("/rest/" + _moduleName + "Def").c_str(), HTTP_GET, [&](PsychicRequest* request) { return sendDefinition(request); });
+}
 
-    setupDefinition(controls);  // virtual function
+// setupDefinition as MsgPack (freeMB by the caller) and its hash, nullptr if out of memory
+uint8_t* Module::buildDefinition(size_t& size) {
+  definitionValid = true;  // before setupDefinition: a definitionChanged during it builds again at the next request
 
-    // char buffer[2048];
-    // serializeJson(controls, buffer, sizeof(buffer));
-    // EXT_LOGD(MB_TAG, "server->on %s moduleDef %s", request->url().c_str(), buffer);
+  JsonDocument doc;
+  JsonArray controls = doc.to<JsonArray>();
+  setupDefinition(controls);  // virtual function
 
+  size = measureMsgPack(doc);
+  uint8_t* buffer = allocMB<uint8_t>(size, "definition");
+  if (!buffer) {
+    definitionValid = false;
+    return nullptr;
+  }
+  size = serializeMsgPack(doc, buffer, size);
+  definitionHash = esp_rom_crc32_le(0, buffer, size);
+  EXT_LOGD(MB_TAG, "%s: %d bytes (json %d) %08x", _moduleName.c_str(), size, measureJson(doc), definitionHash);
+  return buffer;
+}
+
+// in the httpd task. The UI keeps the definition and asks with If-None-Match, so it is only sent again if it changed.
+// Only the hash is kept: the definition is built again when it is sent, and freed after
+esp_err_t Module::sendDefinition(PsychicRequest* request) {
+  char etag[12];
+  snprintf(etag, sizeof(etag), "\"%08x\"", definitionHash);
+  PsychicResponse response(request);
+  response.addHeader("Cache-Control", "no-cache");  // cache, but ask if it is still valid
+  if (definitionValid && request->header("If-None-Match") == etag) {
+    response.addHeader("ETag", etag);
+    response.setCode(304);
     return response.send();
-  });
+  }
+
+  size_t size;
+  uint8_t* definition = buildDefinition(size);
+  if (!definition) return request->reply(500);
+  snprintf(etag, sizeof(etag), "\"%08x\"", definitionHash);
+  response.addHeader("ETag", etag);
+
+  esp_err_t result;
+  if (request->header("If-None-Match") == etag) {  // changed and back again
+    response.setCode(304);
+    result = response.send();
+  } else if (acceptsMsgPack(request)) {
+    response.setContentType("application/msgpack");
+    response.setContent(definition, size);
+    result = response.send();
+  } else {
+    JsonDocument doc;
+    deserializeMsgPack(doc, definition, size);
+    String json;
+    serializeJson(doc, json);
+    response.setContentType("application/json");
+    response.setContent(json.c_str());
+    result = response.send();
+  }
+  freeMB(definition, "definition");
+  return result;
+}
+
+bool Module::acceptsMsgPack(PsychicRequest* request) { return request->header("Accept").indexOf("application/msgpack") >= 0; }
+
+esp_err_t Module::send(PsychicRequest* request, const JsonDocument& doc) {
+  PsychicResponse response(request);
+  if (acceptsMsgPack(request)) {
+    size_t size = measureMsgPack(doc);
+    uint8_t* buffer = allocMB<uint8_t>(size, "msgpack");
+    if (!buffer) return request->reply(500);
+    serializeMsgPack(doc, buffer, size);
+    response.setContentType("application/msgpack");
+    response.setContent(buffer, size);
+    esp_err_t result = response.send();
+    freeMB(buffer, "msgpack");
+    return result;
+  }
+  String json;
+  serializeJson(doc, json);
+  response.setContentType("application/json");
+  response.setContent(json.c_str());
+  return response.send();
 }
 
 // heap-optimization: request heap optimization review
@@ -18,6 +18,9 @@
   #include <FSPersistence.h>
   #include <PsychicHttp.h>
 
+  #include "ControlMessage.h"
+  #include "ModulePersistence.h"
+  #include "UpdateBus.h"
   #include "Utilities.h"
 
 // sizeof was 160 chars -> 80 -> 68 -> 88
@@ -44,6 +47,8 @@ typedef std::function<void(JsonObject data)> ReadHook;
 
 extern JsonDocument* gModulesDoc;  // shared document for all modules, to save RAM
 
+extern UpdateBus updateBus;  // changes of files and module controls, delivered in the sveltekit task
+
 class ModuleState {
  public:
   JsonObject data = JsonObject();  // isNull()
@@ -177,6 +182,27 @@ class Module : public StatefulService<ModuleState> {
       }
       onUpdate(updatedItem);
     }
+
+    // only the changed rows are written to the journal (e.g. nodes/2/controls/5), not changes read from the FS (origin is the file path)
+    if (_state.updateOriginId.c_str()[0] != '/') {
+      if (updatedItem.name == "swap")
+        markDirty(nullptr);
+      else {
+        Char<64> path;
+        if (updatedItem.parent[0] == "")
+          path = updatedItem.name;
+        else if (updatedItem.parent[1] == "")
+          path.format("%s/%d", updatedItem.parent[0].c_str(), updatedItem.index[0]);
+        else
+          path.format("%s/%d/%s/%d", updatedItem.parent[0].c_str(), updatedItem.index[0], updatedItem.parent[1].c_str(), updatedItem.index[1]);
+        markDirty(path.c_str());
+      }
+    }
+
+    // notify subscribers of <module>/<top level control>, e.g. inputoutput/pins (once per deliver if many rows change)
+    Char<64> topic;
+    topic.format("%s/%s", _moduleName.c_str(), updatedItem.parent[0] != "" ? updatedItem.parent[0].c_str() : updatedItem.name.c_str());
+    updateBus.publish(topic.c_str(), _state.updateOriginId.c_str());
   }
 
   virtual void setupDefinition(const JsonArray& controls);
@@ -194,19 +220,39 @@ class Module : public StatefulService<ModuleState> {
   virtual void onUpdate(const UpdatedItem& updatedItem) {};
   virtual void onReOrderSwap(uint8_t stateIndex, uint8_t newIndex) {};
 
+  // binary control update from the UI (see ControlMessage.h), called in the socket task: queue it and apply it in loop(). false if not supported
+  virtual bool postControl(const ControlMessage::Message& message) { return false; }
+  // a node registered a control at another address (e.g. a live script recompiled), the pointers known for postControl are stale
+  virtual void controlsChanged() {}
+
+  // the hash of the definition is the ETag (see sendDefinition), call this when setupDefinition would give another result
+  void definitionChanged() { definitionValid = false; }
+
+  // Accept: application/msgpack
+  static bool acceptsMsgPack(PsychicRequest* request);
+  // send doc as MsgPack or JSON, as the request accepts
+  static esp_err_t send(PsychicRequest* request, const JsonDocument& doc);
+
  protected:
   EventSocket* _socket;
-  void readFromFS() {             // used in ModuleEffects, for live scripts...
-    _fsPersistence.readFromFS();  // overwrites the default settings in state
+  void readFromFS() {           // used in ModuleEffects, for live scripts...
+    _persistence.readFromFS();  // overwrites the default settings in state
   }
+  void markDirty(const char* path) { _persistence.markDirty(path); }  // control or row changed without compareRecursive, e.g. nodes/2/controls/5 (nullptr: not known which)
 
  private:
   // heap-optimization: request heap optimization review
   // on boards without PSRAM, heap is only 60 KB (30KB max alloc) available, need to find out how to increase the heap
   // This module class is used for each module, about 15 times, 1144 bytes each (allocated in main.cpp, in global memory area) + each class allocates it's own heap
 
-  FSPersistence<ModuleState> _fsPersistence;
+  ModulePersistence _persistence;
   PsychicHttpServer* _server;
+
+  uint32_t definitionHash = 0;  // crc32 of setupDefinition as MsgPack, the ETag
+  volatile bool definitionValid = false;
+
+  uint8_t* buildDefinition(size_t& size);
+  esp_err_t sendDefinition(PsychicRequest* request);
 };
 
 #endif
@@ -0,0 +1,362 @@
+/**
+    @title     MoonBase
+    @file      ModulePersistence.cpp
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/develop/modules/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#if FT_MOONBASE == 1
+
+  #include "ModulePersistence.h"
+
+  #include <esp_rom_crc.h>
+
+  #include "Module.h"
+
+std::mutex ModulePersistence::fsMutex;
+std::vector<ModulePersistence*> ModulePersistence::instances;
+
+static const uint8_t recordHeaderSize = 6;  // length u16, crc32 u32
+
+static uint32_t get32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static void set32(uint8_t* p, uint32_t value) {
+  for (uint8_t i = 0; i < 4; i++) p[i] = value >> (8 * i);
+}
+
+// CRC-32 of the contents of file, from the start
+static uint32_t fileCrc(File& file) {
+  uint8_t buffer[256];
+  uint32_t crc = 0;
+  file.seek(0);
+  size_t n;
+  while ((n = file.read(buffer, sizeof(buffer))) > 0) crc = esp_rom_crc32_le(crc, buffer, n);
+  file.seek(0);
+  return crc;
+}
+
+// a path is a top level control or a row / control in it: "brightness", "nodes/2", "nodes/2/controls/5" (object keys and array indexes)
+
+// the value at path in root. length: the part of path which exists, the value is of that part (e.g. "nodes" if the row was removed)
+static JsonVariant walk(JsonVariant root, const std::string& path, size_t& length) {
+  JsonVariant value = root;
+  length = 0;
+  size_t start = 0;
+  while (start < path.size()) {
+    size_t end = path.find('/', start);
+    if (end == std::string::npos) end = path.size();
+    std::string segment = path.substr(start, end - start);
+    JsonVariant next;
+    if (value.is<JsonArray>()) {
+      size_t index = strtoul(segment.c_str(), nullptr, 10);
+      if (index < value.size()) next = value[index];
+    } else if (value.is<JsonObject>())
+      next = value[segment];
+    if (next.isNull()) break;
+    value = next;
+    length = end;
+    start = end + 1;
+  }
+  return value;
+}
+
+// set the value at path in root, rows up to the index are added if the array is shorter. false if path does not fit root
+static bool put(JsonVariant parent, const char* path, JsonVariantConst value) {
+  while (true) {
+    const char* end = strchr(path, '/');
+    std::string segment = end ? std::string(path, end - path) : std::string(path);
+    bool childIsArray = end && isdigit(end[1]);
+    if (parent.is<JsonArray>()) {
+      if (segment.empty() || !isdigit(segment[0])) return false;
+      JsonArray array = parent.as<JsonArray>();
+      size_t index = strtoul(segment.c_str(), nullptr, 10);
+      while (array.size() <= index) array.add<JsonObject>();
+      if (!end) return array[index].set(value);
+      if (childIsArray && !array[index].is<JsonArray>()) array[index].to<JsonArray>();
+      parent = array[index];
+    } else if (parent.is<JsonObject>()) {
+      JsonObject object = parent.as<JsonObject>();
+      if (!end) return object[segment].set(value);
+      if (object[segment].isNull()) {
+        if (childIsArray)
+          object[segment].to<JsonArray>();
+        else
+          object[segment].to<JsonObject>();
+      }
+      parent = object[segment];
+    } else
+      return false;
+    path = end + 1;
+  }
+}
+
+// the snapshot with the records of its journal applied. false if there is no valid snapshot. damaged: a record could not be read
+static bool load(FS* fs, const String& path, const String& journalPath, JsonDocument& doc, bool& damaged) {
+  File file = fs->open(path.c_str(), "r");
+  if (!file) return false;
+  uint32_t crc = fileCrc(file);
+  DeserializationError error = deserializeJson(doc, file);
+  file.close();
+  if (error != DeserializationError::Ok || !doc.is<JsonObject>()) return false;
+
+  File journal = fs->open(journalPath.c_str(), "r");
+  if (!journal) return true;
+  uint8_t header[8];
+  if (journal.read(header, sizeof(header)) != sizeof(header) || memcmp(header, "JNL1", 4) != 0 || get32(header + 4) != crc) {
+    journal.close();
+    EXT_LOGD(MB_TAG, "%s is not of this snapshot, removed", journalPath.c_str());
+    fs->remove(journalPath.c_str());
+    if (fileChanged) fileChanged(journalPath.c_str(), "FSPersistence");
+    return true;
+  }
+
+  JsonObject root = doc.as<JsonObject>();
+  uint16_t records = 0;
+  while (journal.available()) {
+    uint8_t recordHeader[recordHeaderSize];
+    if (journal.read(recordHeader, recordHeaderSize) != recordHeaderSize) {
+      damaged = true;
+      break;
+    }
+    uint16_t length = recordHeader[0] | (recordHeader[1] << 8);
+    uint8_t* buffer = allocMB<uint8_t>(length, "journal");
+    if (!buffer || journal.read(buffer, length) != length || esp_rom_crc32_le(0, buffer, length) != get32(recordHeader + 2)) {
+      if (buffer) freeMB(buffer, "journal");
+      damaged = true;  // e.g. power lost while appending
+      break;
+    }
+    JsonDocument record;
+    if (deserializeMsgPack(record, buffer, length) == DeserializationError::Ok && record.is<JsonObject>()) {
+      for (JsonPair pair : record.as<JsonObject>())
+        if (!put(root, pair.key().c_str(), pair.value())) damaged = true;
+      records++;
+    } else
+      damaged = true;
+    freeMB(buffer, "journal");
+    if (damaged) break;
+  }
+  journal.close();
+  EXT_LOGD(MB_TAG, "%s + %d journal records%s", path.c_str(), records, damaged ? " (damaged)" : "");
+  return true;
+}
+
+// write doc to path.tmp and rename it to path, so path is never half written
+static bool writeJson(FS* fs, const String& path, JsonDocument& doc) {
+  String folder = path.substring(0, path.lastIndexOf('/'));
+  if (folder.length() && !fs->exists(folder.c_str())) fs->mkdir(folder.c_str());
+
+  String tmpPath = path + ".tmp";
+  File file = fs->open(tmpPath.c_str(), "w");
+  if (!file) return false;
+  size_t written = serializeJson(doc, file);
+  file.close();
+  if (!written) {
+    fs->remove(tmpPath.c_str());
+    return false;
+  }
+  if (!fs->rename(tmpPath.c_str(), path.c_str())) {
+    fs->remove(path.c_str());
+    fs->rename(tmpPath.c_str(), path.c_str());
+  }
+  return true;
+}
+
+ModulePersistence::ModulePersistence(Module* module, FS* fs, const char* filePath) : _module(module), _fs(fs), _filePath(filePath) {
+  _journalPath = _filePath.substring(0, _filePath.lastIndexOf('.')) + ".jnl";
+  instances.push_back(this);
+  _module->addUpdateHandler([this](const String& originId) { writeToFS(); });
+}
+
+void ModulePersistence::readFromFS() {
+  JsonDocument doc;
+  bool damaged = false;
+  bool loaded;
+  {
+    std::lock_guard<std::mutex> lock(fsMutex);
+    loaded = load(_fs, _filePath, _journalPath, doc, damaged);
+  }
+
+  if (!loaded) doc.to<JsonObject>();  // defaults (the updater supplies them for an empty object)
+  JsonObject object = doc.as<JsonObject>();
+  _module->updateWithoutPropagation(object, ModuleState::update, _filePath);
+
+  {
+    std::lock_guard<std::mutex> lock(dirtyMutex);
+    dirtyKeys.clear();              // read, not changed
+    dirtyAll = !loaded || damaged;  // write the snapshot at the next write
+  }
+  if (!loaded) writeToFS();  // so the defaults persist between resets (at save)
+}
+
+void ModulePersistence::markDirty(const char* path) {
+  std::lock_guard<std::mutex> lock(dirtyMutex);
+  if (path)
+    dirtyKeys.insert(path);
+  else
+    dirtyAll = true;
+}
+
+void ModulePersistence::writeToFS() {
+  if (hasDelayedWrite) return;
+  ESP_LOGD(SVK_TAG, "delayedWrites: Add %s", _filePath.c_str());
+  delayedWrites.push_back([this](char writeOrCancel) {
+    ESP_LOGD(SVK_TAG, "delayedWrites: %c %s", writeOrCancel, _filePath.c_str());
+    if (writeOrCancel == 'W') {
+      hasDelayedWrite = false;                 // next changes need a new save
+      writeDue = (millis() + debounceMs) | 1;  // not 0, a next save moves it
+    } else
+      cancelRequested = true;  // hasDelayedWrite is reset when read back
+  });
+  hasDelayedWrite = true;
+}
+
+void ModulePersistence::readBack() {
+  readFromFS();
+  // update state to UI
+  _module->update([&](ModuleState& state) { return StateUpdateResult::CHANGED; }, SVK_TAG);
+  hasDelayedWrite = false;
+}
+
+void ModulePersistence::writeNow() {
+  std::set<std::string> keys;
+  bool all;
+  {
+    std::lock_guard<std::mutex> lock(dirtyMutex);
+    keys.swap(dirtyKeys);
+    all = dirtyAll;
+    dirtyAll = false;
+  }
+  std::lock_guard<std::mutex> lock(fsMutex);
+  if (all || keys.empty() || !appendRecord(keys)) writeSnapshot();  // keys empty: not known what changed
+}
+
+bool ModulePersistence::writeSnapshot() {
+  JsonDocument doc;
+  JsonObject root = doc.to<JsonObject>();
+  _module->read(root, ModuleState::read);
+  if (!writeJson(_fs, _filePath, doc)) {
+    EXT_LOGE(MB_TAG, "write %s failed", _filePath.c_str());
+    return false;
+  }
+  bool hadJournal = _fs->exists(_journalPath.c_str());
+  if (hadJournal) _fs->remove(_journalPath.c_str());
+  EXT_LOGD(MB_TAG, "%s written (%d bytes)", _filePath.c_str(), measureJson(doc));
+
+  if (fileChanged) {
+    fileChanged(_filePath.c_str(), "FSPersistence");
+    if (hadJournal) fileChanged(_journalPath.c_str(), "FSPersistence");
+  }
+  return true;
+}
+
+// false if the snapshot should be written instead: no snapshot or the journal would be larger than half of it
+bool ModulePersistence::appendRecord(const std::set<std::string>& keys) {
+  File snapshot = _fs->open(_filePath.c_str(), "r");
+  if (!snapshot) return false;
+  size_t snapshotSize = snapshot.size();
+
+  JsonDocument record;
+  JsonObject root = record.to<JsonObject>();
+  _module->read([&](ModuleState& state) {
+    // a path which does not exist anymore (a row removed) is written as the part which exists
+    std::set<std::string> paths;
+    for (const std::string& key : keys) {
+      size_t length;
+      walk(state.data, key, length);
+      if (length) paths.insert(key.substr(0, length));
+    }
+    for (const std::string& path : paths) {
+      bool within = false;  // leave out paths within another path, e.g. nodes/2/controls/5 if nodes/2 is written
+      for (size_t slash = path.find('/'); slash != std::string::npos && !within; slash = path.find('/', slash + 1)) within = paths.count(path.substr(0, slash));
+      if (within) continue;
+      size_t length;
+      root[path] = walk(state.data, path, length);
+    }
+  });
+  size_t length = measureMsgPack(record);
+
+  File journal = _fs->open(_journalPath.c_str(), "r");
+  size_t journalSize = journal ? journal.size() : 0;
+  if (journal) journal.close();
+  if (length > UINT16_MAX || journalSize + recordHeaderSize + length > snapshotSize / 2) {
+    snapshot.close();
+    return false;  // compaction
+  }
+
+  uint8_t header[8];
+  if (!journalSize) {  // new journal, of this snapshot
+    memcpy(header, "JNL1", 4);
+    set32(header + 4, fileCrc(snapshot));
+  }
+  snapshot.close();
+
+  uint8_t* buffer = allocMB<uint8_t>(recordHeaderSize + length, "journal");
+  if (!buffer) return false;
+  serializeMsgPack(record, buffer + recordHeaderSize, length);
+  buffer[0] = length & 0xFF;
+  buffer[1] = length >> 8;
+  set32(buffer + 2, esp_rom_crc32_le(0, buffer + recordHeaderSize, length));
+
+  journal = _fs->open(_journalPath.c_str(), journalSize ? "a" : "w");
+  bool ok = journal && (journalSize || journal.write(header, sizeof(header)) == sizeof(header)) && journal.write(buffer, recordHeaderSize + length) == recordHeaderSize + length;
+  if (journal) journal.close();
+  freeMB(buffer, "journal");
+  if (!ok) return false;  // write the snapshot, which removes the journal
+
+  EXT_LOGD(MB_TAG, "%s: %d paths appended (%d bytes, journal %d bytes)", _journalPath.c_str(), root.size(), length, journalSize + recordHeaderSize + length);
+  if (fileChanged) fileChanged(_journalPath.c_str(), "FSPersistence");
+  return true;
+}
+
+void ModulePersistence::flush(const char* path) {
+  for (ModulePersistence* persistence : instances) {
+    if (persistence->_filePath != path) continue;
+    if (persistence->writeDue) {
+      persistence->writeDue = 0;
+      persistence->writeNow();
+    }
+    std::lock_guard<std::mutex> lock(fsMutex);
+    if (!persistence->_fs->exists(persistence->_journalPath.c_str())) return;
+    JsonDocument doc;
+    bool damaged = false;
+    if (load(persistence->_fs, persistence->_filePath, persistence->_journalPath, doc, damaged) && writeJson(persistence->_fs, persistence->_filePath, doc)) {
+      persistence->_fs->remove(persistence->_journalPath.c_str());
+      if (fileChanged) fileChanged(persistence->_journalPath.c_str(), "FSPersistence");
+    }
+    return;
+  }
+}
+
+void ModulePersistence::task(void* parameter) {
+  while (true) {
+    uint32_t now = millis();
+    for (ModulePersistence* persistence : instances) {
+      uint32_t due = persistence->writeDue;
+      if (due && (int32_t)(now - due) >= 0) {
+        persistence->writeDue = 0;
+        persistence->writeNow();
+      }
+      if (persistence->cancelRequested && !persistence->writeDue) {  // after a pending write
+        persistence->cancelRequested = false;
+        persistence->readBack();
+      }
+    }
+    vTaskDelay(50 / portTICK_PERIOD_MS);
+  }
+}
+
+void ModulePersistence::begin() {
+  xTaskCreateUniversal(task,                  // task function
+                       "AppPersistenceTask",  // name
+                       6 * 1024,              // stack size: cancel calls the update handlers of the module
+                       NULL,                  // parameter
+                       tskIDLE_PRIORITY + 1,  // priority: below everything else, flash writes should not delay effects, drivers or the UI
+                       NULL,                  // task handle
+                       1                      // core
+  );
+}
+
+#endif
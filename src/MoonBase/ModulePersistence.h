@@ -0,0 +1,82 @@
+/**
+    @title     MoonBase
+    @file      ModulePersistence.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/develop/modules/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#ifndef ModulePersistence_h
+#define ModulePersistence_h
+
+#if FT_MOONBASE == 1
+
+  #include <FS.h>
+
+  #include <mutex>
+  #include <set>
+  #include <string>
+  #include <vector>
+
+class Module;
+
+// Saves the state of a module in /.config/<module>.json (snapshot) and /.config/<module>.jnl (journal), replaces FSPersistence for modules.
+//
+// Changes are saved when the user presses save (delayedWrites, see FileManager /rest/saveConfig), not in the httpd task but in a low priority task,
+// after a debounce window so repeated saves of the same module are written once.
+// Only the controls and rows which changed since the last write (markDirty, a path: "brightness", "nodes/2", "nodes/2/controls/5") are written,
+// as a MsgPack record appended to the journal: [length u16][crc32 u32][MsgPack object {path: value, ...}], replayed path by path.
+// The journal starts with [JNL1][crc32 u32 of the snapshot] so a journal of an older snapshot (e.g. a preset copied over it) is ignored.
+// If the journal is larger than half of the snapshot (or a record is damaged, or it is not known what changed) the snapshot is written again
+// (to .tmp and renamed) and the journal removed: compaction.
+// The snapshot stays JSON, as presets are copies of it and it can be edited in the File Manager: call flush() before copying it.
+class ModulePersistence {
+ public:
+  static const uint16_t debounceMs = 500;
+
+  ModulePersistence(Module* module, FS* fs, const char* filePath);
+
+  // read the snapshot and replay the journal into the state, defaults if no snapshot
+  void readFromFS();
+
+  // path of a control or row which changed after the last write (e.g. nodes/2/controls/5), nullptr: not known which
+  void markDirty(const char* path);
+
+  // start the persistence task
+  static void begin();
+
+  // write pending changes of the module saved in path now and fold its journal into the snapshot, so path can be copied or replaced. Any task
+  static void flush(const char* path);
+
+  static std::mutex fsMutex;  // file operations on snapshots and journals
+
+ private:
+  Module* _module;
+  FS* _fs;
+  String _filePath;
+  String _journalPath;
+
+  std::mutex dirtyMutex;
+  std::set<std::string> dirtyKeys;
+  bool dirtyAll = false;
+
+  bool hasDelayedWrite = false;    // waiting for save or cancel
+  volatile uint32_t writeDue = 0;  // millis, 0: no write requested
+  volatile bool cancelRequested = false;
+
+  void writeToFS();  // add to delayedWrites: write on save
+  void readBack();   // cancel: back to the saved state
+
+  void writeNow();       // in the task
+  bool writeSnapshot();  // from the state, removes the journal
+  bool appendRecord(const std::set<std::string>& keys);
+
+  static std::vector<ModulePersistence*> instances;
+  static void task(void* parameter);
+};
+
+#endif
+#endif
@@ -0,0 +1,210 @@
+/**
+    @title     MoonBase
+    @file      FileIndex.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/moonbase/FileManager/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#pragma once
+
+// In memory index of the files and folders of the FS, used by the File Manager.
+// Only std containers, tested on the host in test/test_file_index.
+//
+// The FS is scanned once, after that the index is kept up to date on create, delete, rename and write (FileManager::changed),
+// so listing a folder does not walk the FS. Entries are stored in one vector and refer to their parent by index,
+// the children of a folder are kept sorted by name, so a path is found by a binary search per folder.
+// Indexes of removed entries are reused.
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+class FileIndex {
+ public:
+  static const int32_t root = 0;
+  static const int32_t notFound = -1;
+
+  struct Entry {
+    std::string name;  // "" for the root
+    int32_t parent = notFound;
+    bool isFile = false;
+    bool used = false;
+    uint32_t size = 0;
+    uint32_t time = 0;
+    std::vector<int32_t> children;  // sorted by name
+  };
+
+  FileIndex() { clear(); }
+
+  void clear() {
+    entries.clear();
+    freeEntries.clear();
+    entries.emplace_back();
+    entries[root].used = true;
+    nrOfEntries = 1;
+  }
+
+  size_t size() const { return nrOfEntries; }  // including the root
+  const Entry& entry(int32_t i) const { return entries[i]; }
+
+  int32_t find(const char* path) const {
+    int32_t i = root;
+    while (i != notFound && *path) {
+      if (*path == '/') {
+        path++;
+        continue;
+      }
+      const char* end = strchr(path, '/');
+      size_t length = end ? end - path : strlen(path);
+      i = child(i, path, length);
+      path += length;
+    }
+    return i;
+  }
+
+  // add or update path, folders on the way which are not indexed yet are added. Returns the entry
+  int32_t set(const char* path, bool isFile, uint32_t size = 0, uint32_t time = 0) {
+    int32_t i = root;
+    while (*path) {
+      if (*path == '/') {
+        path++;
+        continue;
+      }
+      const char* end = strchr(path, '/');
+      size_t length = end ? end - path : strlen(path);
+      int32_t c = child(i, path, length);
+      if (c == notFound) {
+        c = newEntry();
+        entries[c].name.assign(path, length);
+        entries[c].parent = i;
+        insertChild(i, c);
+      }
+      i = c;
+      path += length;
+    }
+    if (i != root) {
+      Entry& e = entries[i];
+      e.isFile = isFile;
+      e.size = isFile ? size : 0;
+      e.time = time;
+      if (isFile) removeChildren(i);
+    }
+    return i;
+  }
+
+  // remove path and everything in it. false if not indexed
+  bool remove(const char* path) {
+    int32_t i = find(path);
+    if (i == notFound || i == root) return false;
+    detach(i);
+    release(i);
+    return true;
+  }
+
+  // move an entry (and its contents) to another path, an entry at the new path is replaced. false if from is not indexed
+  bool rename(const char* from, const char* to) {
+    int32_t i = find(from);
+    if (i == notFound || i == root) return false;
+    int32_t existing = find(to);
+    if (existing == i) return true;
+    if (existing != notFound && existing != root) {
+      detach(existing);
+      release(existing);
+    }
+    detach(i);
+    const char* name = strrchr(to, '/');
+    std::string folder(to, name ? name - to : 0);
+    name = name ? name + 1 : to;
+    int32_t parent = set(folder.c_str(), false);
+    entries[i].name = name;
+    entries[i].parent = parent;
+    insertChild(parent, i);
+    return true;
+  }
+
+  std::string path(int32_t i) const {
+    if (i == root) return "/";
+    std::string path;
+    for (; i != root && i != notFound; i = entries[i].parent) path.insert(0, "/" + entries[i].name);
+    return path;
+  }
+
+  static bool isHidden(const Entry& e) { return !e.name.empty() && e.name[0] == '.'; }
+
+  // number of entries in folder (hidden entries only if showHidden)
+  size_t count(int32_t folder, bool showHidden) const {
+    size_t count = 0;
+    for (int32_t c : entries[folder].children)
+      if (showHidden || !isHidden(entries[c])) count++;
+    return count;
+  }
+
+  // call f(index, entry) for the entries of folder, skipping offset entries and at most limit (0: all). Returns the number of entries in folder
+  template <typename F>
+  size_t list(int32_t folder, bool showHidden, size_t offset, size_t limit, F f) const {
+    size_t n = 0;
+    for (int32_t c : entries[folder].children) {
+      if (!showHidden && isHidden(entries[c])) continue;
+      if (n >= offset && (!limit || n < offset + limit)) f(c, entries[c]);
+      n++;
+    }
+    return n;
+  }
+
+ private:
+  std::vector<Entry> entries;
+  std::vector<int32_t> freeEntries;
+  size_t nrOfEntries = 0;
+
+  int32_t child(int32_t folder, const char* name, size_t length) const {
+    const std::vector<int32_t>& children = entries[folder].children;
+    auto it = std::lower_bound(children.begin(), children.end(), 0, [&](int32_t c, int) { return entries[c].name.compare(0, std::string::npos, name, length) < 0; });
+    if (it != children.end() && entries[*it].name.compare(0, std::string::npos, name, length) == 0) return *it;
+    return notFound;
+  }
+
+  void insertChild(int32_t folder, int32_t c) {
+    std::vector<int32_t>& children = entries[folder].children;
+    auto it = std::lower_bound(children.begin(), children.end(), c, [&](int32_t a, int32_t b) { return entries[a].name < entries[b].name; });
+    children.insert(it, c);
+  }
+
+  void detach(int32_t i) {
+    std::vector<int32_t>& siblings = entries[entries[i].parent].children;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), i));
+  }
+
+  int32_t newEntry() {
+    nrOfEntries++;
+    if (!freeEntries.empty()) {
+      int32_t i = freeEntries.back();
+      freeEntries.pop_back();
+      entries[i].used = true;
+      return i;
+    }
+    entries.emplace_back();
+    entries.back().used = true;
+    return entries.size() - 1;
+  }
+
+  void removeChildren(int32_t i) {
+    for (int32_t c : entries[i].children) release(c);
+    entries[i].children.clear();
+  }
+
+  // free i and its contents (already detached from its parent)
+  void release(int32_t i) {
+    removeChildren(i);
+    Entry& e = entries[i];
+    e = Entry();
+    freeEntries.push_back(i);
+    nrOfEntries--;
+  }
+};
@@ -13,46 +13,53 @@
 
   #include "FileManager.h"
 
+  #include <esp_rom_crc.h>
+
   #include "MoonBase/Utilities.h"
 
-// recursively fill a fileArray with all files and folders on the FS
-void addFolder(File folder, bool showHidden, const JsonArray& fileArray) {
+// recursively add all files and folders on the FS to the index, only at boot, after that the index is updated on each change
+void addFolder(File folder, FileIndex& index) {
   folder.rewindDirectory();
   while (true) {
     File file = folder.openNextFile();
     if (!file) {
       break;
     } else {
-      if (showHidden || file.name()[0] != '.') {
-        JsonObject fileObject = fileArray.add<JsonObject>();
-        fileObject["name"] = (char*)file.name();  // enforces copy, solved in latest arduinojson!, see https://arduinojson.org/news/2024/12/29/arduinojson-7-3/
-        fileObject["path"] = (char*)file.path();  // enforces copy, solved in latest arduinojson!, see https://arduinojson.org/news/2024/12/29/arduinojson-7-3/
-        fileObject["isFile"] = !file.isDirectory();
-        // EXT_LOGI(MB_TAG, "file %s (%d)", file.path(), file.size());
-        if (file.isDirectory()) {
-          addFolder(file, showHidden, fileObject["files"].to<JsonArray>());
-        } else {
-          fileObject["size"] = file.size();
-          fileObject["time"] = file.getLastWrite();
-        }
-        // serializeJson(fileObject, Serial);
-      }
+      // EXT_LOGI(MB_TAG, "file %s (%d)", file.path(), file.size());
+      if (file.isDirectory()) {
+        index.set(file.path(), false);
+        addFolder(file, index);
+      } else
+        index.set(file.path(), true, file.size(), file.getLastWrite());
       file.close();
     }
   }
 }
 
+// update the index entry of path with the FS: added, changed or removed
+void refreshFile(FileIndex& index, const char* path) {
+  File file = ESPFS.open(path);
+  if (!file) {
+    index.remove(path);
+    return;
+  }
+  if (file.isDirectory())
+    index.set(path, false);
+  else
+    index.set(path, true, file.size(), file.getLastWrite());
+  file.close();
+}
+
 void FilesState::read(FilesState& state, JsonObject& stateJson) {
   stateJson["name"] = "/";
   // crashes for some reason: ???
   stateJson["fs_total"] = ESPFS.totalBytes();
   stateJson["fs_used"] = ESPFS.usedBytes();
   stateJson["showHidden"] = state.showHidden;
-  File folder = ESPFS.open("/");
-  addFolder(folder, state.showHidden, stateJson["files"].to<JsonArray>());
-  folder.close();
+  stateJson["nrOfFiles"] = state.index.size() - 1;  // without root
+  JsonArray changed = stateJson["changed"].to<JsonArray>();
+  for (const String& path : state.changedPaths) changed.add(path);
   // print->printJson("FilesState::read", stateJson);
-  EXT_LOGI(MB_TAG, "");
 }
 
 StateUpdateResult FilesState::update(JsonObject& newData, FilesState& state, const String &originId) {
@@ -64,7 +71,7 @@ StateUpdateResult FilesState::update(JsonObject& newData, FilesState& state, con
     changed = true;
   }
 
-  state.updatedItems.clear();
+  state.changedPaths.clear();
 
   JsonArray deletes = newData["deletes"].as<JsonArray>();
   if (!deletes.isNull()) {
@@ -76,7 +83,8 @@ StateUpdateResult FilesState::update(JsonObject& newData, FilesState& state, con
       else
         ESPFS.rmdir(var["path"].as<const char*>());
 
-      state.updatedItems.push_back(var["path"].as<const char*>());
+      state.index.remove(var["path"].as<const char*>());
+      state.changedPaths.push_back(var["path"].as<const char*>());
     }
   }
 
@@ -87,8 +95,8 @@ StateUpdateResult FilesState::update(JsonObject& newData, FilesState& state, con
       // print->printJson("new file", var);
       if (var["isFile"]) {
         File file = ESPFS.open(var["path"].as<const char*>(), FILE_WRITE);
-        const char* contents = var["contents"];
-        if (strlen(contents)) {
+        const char* contents = var["contents"];  // small files only, large files are sent to /rest/FileManager/upload
+        if (contents && strlen(contents)) {
           if (!file.write((byte*)contents, strlen(contents))) {  // changed not true as contents is not part of the state
             EXT_LOGE(MB_TAG, "Write failed");
           }
@@ -97,7 +105,8 @@ StateUpdateResult FilesState::update(JsonObject& newData, FilesState& state, con
       } else {
         ESPFS.mkdir(var["path"].as<const char*>());
       }
-      state.updatedItems.push_back(var["path"].as<const char*>());
+      refreshFile(state.index, var["path"].as<const char*>());
+      state.changedPaths.push_back(var["path"].as<const char*>());
     }
   }
 
@@ -106,12 +115,13 @@ StateUpdateResult FilesState::update(JsonObject& newData, FilesState& state, con
     for (JsonObject var : updates) {
       EXT_LOGI(MB_TAG, "update %s %s", var["path"].as<const char*>(), var["isFile"] ? "File" : "Folder");
       // print->printJson("update file", var);
-      File file = ESPFS.open(var["path"].as<const char*>(), FILE_WRITE);
+      // contents is optional: not send if only renamed or if uploaded to /rest/FileManager/upload
+      File file = var["contents"].is<const char*>() ? ESPFS.open(var["path"].as<const char*>(), FILE_WRITE) : ESPFS.open(var["path"].as<const char*>());
       if (!file) {
         EXT_LOGE(MB_TAG, "Failed to open file");
       } else {
         const char* contents = var["contents"];
-        if (!file.write((byte*)contents, strlen(contents))) {  // changed not true as contents is not part of the state
+        if (contents && !file.write((byte*)contents, strlen(contents))) {  // changed not true as contents is not part of the state
           EXT_LOGE(MB_TAG, "Write failed");
         }
         file.close();
@@ -124,16 +134,18 @@ StateUpdateResult FilesState::update(JsonObject& newData, FilesState& state, con
         EXT_LOGI(MB_TAG, "rename %s to %s", var["path"].as<const char*>(), newPath);
 
         if (strcmp(var["path"], newPath) != 0) {
-          ESPFS.rename(var["path"].as<const char*>(), newPath);
+          if (ESPFS.rename(var["path"].as<const char*>(), newPath)) state.index.rename(var["path"].as<const char*>(), newPath);
+          state.changedPaths.push_back(newPath);
         }
-        state.updatedItems.push_back(var["path"].as<const char*>());
+        refreshFile(state.index, newPath);
+        state.changedPaths.push_back(var["path"].as<const char*>());
       }
     }
   }
 
-  changed |= state.updatedItems.size();
+  changed |= state.changedPaths.size();
 
-  if (changed && state.updatedItems.size()) EXT_LOGV(MB_TAG, "first item %s", state.updatedItems.front().c_str());
+  if (changed && state.changedPaths.size()) EXT_LOGV(MB_TAG, "first item %s", state.changedPaths.front().c_str());
 
   return changed ? StateUpdateResult::CHANGED : StateUpdateResult::UNCHANGED;
 }
@@ -148,13 +160,47 @@ FileManager::FileManager(PsychicHttpServer* server, ESP32SvelteKit* sveltekit)
 }
 
 void FileManager::begin() {
+  // index the FS once
+  updateWithoutPropagation(
+      [&](FilesState& state) {
+        state.index.clear();
+        File folder = ESPFS.open("/");
+        addFolder(folder, state.index);
+        folder.close();
+        EXT_LOGI(MB_TAG, "%d files and folders indexed", state.index.size() - 1);
+        return StateUpdateResult::UNCHANGED;
+      },
+      MB_TAG);
+
   _httpEndpoint.begin();
   _eventEndpoint.begin();
   _webSocketServer.begin();
 
+  // notify the subscribers of the changed paths, see onFileChanged
+  addUpdateHandler(
+      [this](const String& originId) {
+        read([&](FilesState& state) {
+          for (const String& path : state.changedPaths) updateBus.publish(path.c_str(), originId.c_str());
+        });
+      },
+      false);
+
+  // files written by others (e.g. the modules writing their config)
+  fileChanged = [this](const char* path, const char* originId) { changed(path, originId); };
+
   // setup the file server
   _server->serveStatic("/rest/file", ESPFS, "/");
 
+  // one page of a folder
+  _server->on("/rest/FileManager/list", HTTP_GET, _sveltekit->getSecurityManager()->wrapRequest(std::bind(&FileManager::list, this, std::placeholders::_1), AuthenticationPredicates::IS_AUTHENTICATED));
+
+  // file contents in chunks, not as JSON
+  PsychicUploadHandler* uploadHandler = new PsychicUploadHandler();
+  uploadHandler->onUpload(std::bind(&FileManager::uploadChunk, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, std::placeholders::_5, std::placeholders::_6));
+  uploadHandler->onRequest(std::bind(&FileManager::uploadComplete, this, std::placeholders::_1));
+  _server->on("/rest/FileManager/upload", HTTP_POST, uploadHandler);
+  _server->on("/rest/FileManager/download", HTTP_GET, _sveltekit->getSecurityManager()->wrapRequest(std::bind(&FileManager::download, this, std::placeholders::_1), AuthenticationPredicates::IS_AUTHENTICATED));
+
   _server->on("/rest/saveConfig", HTTP_POST,
               _sveltekit->getSecurityManager()->wrapRequest(
                   [this](PsychicRequest* request) {
@@ -182,4 +228,225 @@ void FileManager::begin() {
                   AuthenticationPredicates::IS_AUTHENTICATED));
 }
 
-#endif
\ No newline at end of file
+void FileManager::loop() {
+  if (pendingChanges.empty()) return;
+  std::vector<std::pair<String, String>> changes;
+  xSemaphoreTake(pendingMutex, portMAX_DELAY);
+  changes.swap(pendingChanges);
+  xSemaphoreGive(pendingMutex);
+
+  for (auto& change : changes) {
+    update(
+        [&](FilesState& state) {
+          refreshFile(state.index, change.first.c_str());
+          state.changedPaths.clear();
+          state.changedPaths.push_back(change.first);
+          return StateUpdateResult::CHANGED;
+        },
+        change.second);
+  }
+}
+
+void FileManager::changed(const char* path, const String& originId) {
+  xSemaphoreTake(pendingMutex, portMAX_DELAY);
+  bool found = false;
+  for (auto& change : pendingChanges) {
+    if (change.first == path && change.second == originId) {  // coalesce, e.g. many writes of the same file. Not across origins: subscribers ignore their own writes
+      found = true;
+      break;
+    }
+  }
+  if (!found) pendingChanges.push_back({path, originId});
+  xSemaphoreGive(pendingMutex);
+}
+
+// GET /rest/FileManager/list?path=/.config&offset=0&limit=50: the entries of a folder, limit 0: all
+esp_err_t FileManager::list(PsychicRequest* request) {
+  String path = request->hasParam("path") ? request->getParam("path")->value() : "/";
+  size_t offset = request->hasParam("offset") ? request->getParam("offset")->value().toInt() : 0;
+  size_t limit = request->hasParam("limit") ? request->getParam("limit")->value().toInt() : 50;
+
+  PsychicJsonResponse response = PsychicJsonResponse(request, false);
+  JsonObject root = response.getRoot();
+  root["path"] = path;
+  root["offset"] = offset;
+
+  read([&](FilesState& state) {
+    int32_t folder = state.index.find(path.c_str());
+    if (folder == FileIndex::notFound || state.index.entry(folder).isFile) {
+      root["total"] = 0;
+      root["error"] = "not found";
+      return;
+    }
+    JsonArray files = root["files"].to<JsonArray>();
+    root["total"] = state.index.list(folder, state.showHidden, offset, limit, [&](int32_t i, const FileIndex::Entry& entry) {
+      JsonObject fileObject = files.add<JsonObject>();
+      fileObject["name"] = (char*)entry.name.c_str();         // enforces copy
+      fileObject["path"] = (char*)state.index.path(i).c_str();  // enforces copy
+      fileObject["isFile"] = entry.isFile;
+      if (entry.isFile) {
+        fileObject["size"] = entry.size;
+        fileObject["time"] = entry.time;
+      } else
+        fileObject["count"] = state.index.count(i, state.showHidden);
+    });
+  });
+
+  return response.send();
+}
+
+// POST /rest/FileManager/upload?path=/x.json&offset=0[&crc=1a2b3c4d]: body is a chunk of the file starting at offset, crc (hex) is set on the last chunk.
+// offset 0 starts a new upload. A chunk which does not continue the current upload gets 409 with the size received, so the client can resume from there
+esp_err_t FileManager::uploadChunk(PsychicRequest* request, const String& filename, uint64_t index, uint8_t* data, size_t len, bool final) {
+  if (index == 0) {  // first data of this request
+    upload.error = 0;
+    if (!AuthenticationPredicates::IS_AUTHENTICATED(_sveltekit->getSecurityManager()->authenticateRequest(request))) {
+      upload.error = 403;
+      return ESP_OK;
+    }
+    String path = request->hasParam("path") ? request->getParam("path")->value() : "";
+    size_t offset = request->hasParam("offset") ? request->getParam("offset")->value().toInt() : 0;
+    if (path.length() < 2 || path[0] != '/') {
+      upload.error = 400;
+      return ESP_OK;
+    }
+    if (offset == 0) {
+      abortUpload();
+      upload.file = ESPFS.open((path + ".part").c_str(), FILE_WRITE);
+      if (!upload.file) {
+        upload.error = 507;
+        return ESP_OK;
+      }
+      upload.path = path;
+      upload.size = 0;
+      upload.crc = 0;
+    } else if (!upload.file || path != upload.path || offset != upload.size) {
+      upload.error = 409;
+      return ESP_OK;
+    }
+  }
+  if (upload.error || !len) return ESP_OK;  // skip the rest of the request
+
+  if (upload.file.write(data, len) != len) {
+    EXT_LOGE(MB_TAG, "upload %s: write failed at %d", upload.path.c_str(), upload.size);
+    abortUpload();
+    upload.error = 507;
+    return ESP_OK;
+  }
+  upload.crc = esp_rom_crc32_le(upload.crc, data, len);
+  upload.size += len;
+  return ESP_OK;
+}
+
+esp_err_t FileManager::uploadComplete(PsychicRequest* request) {
+  PsychicJsonResponse response = PsychicJsonResponse(request, false);
+  JsonObject root = response.getRoot();
+  root["path"] = upload.path;
+  root["size"] = upload.size;
+  if (!request->contentLength()) upload.error = 400;  // uploadChunk not called, empty files are created with news
+  if (upload.error) {
+    response.setCode(upload.error);
+    return response.send();
+  }
+  if (!request->hasParam("crc")) return response.send();  // more chunks to come
+
+  upload.file.close();
+  uint32_t crc = strtoul(request->getParam("crc")->value().c_str(), nullptr, 16);
+  String part = upload.path + ".part";
+  if (crc != upload.crc) {
+    EXT_LOGW(MB_TAG, "upload %s: CRC %08x, expected %08x", upload.path.c_str(), upload.crc, crc);
+    ESPFS.remove(part.c_str());
+    upload.path = "";
+    response.setCode(422);
+    root["error"] = "CRC mismatch";
+    return response.send();
+  }
+
+  // replace the file at once, a reader never sees a partial file
+  if (!ESPFS.rename(part.c_str(), upload.path.c_str())) {
+    ESPFS.remove(upload.path.c_str());
+    ESPFS.rename(part.c_str(), upload.path.c_str());
+  }
+  EXT_LOGI(MB_TAG, "uploaded %s (%d bytes)", upload.path.c_str(), upload.size);
+  changed(upload.path.c_str(), "upload");  // one notification for the whole file
+  upload.path = "";
+  return response.send();
+}
+
+// close and remove the .part file of an unfinished upload
+void FileManager::abortUpload() {
+  if (upload.file) {
+    upload.file.close();
+    ESPFS.remove((upload.path + ".part").c_str());
+  }
+  upload.path = "";
+}
+
+// GET /rest/FileManager/download?path=/x.mlf[&crc=1] with optional header Range: bytes=start-[end], sent in chunks.
+// crc=1: header X-CRC32 with the CRC-32 of the bytes sent (reads the range twice)
+esp_err_t FileManager::download(PsychicRequest* request) {
+  String path = request->hasParam("path") ? request->getParam("path")->value() : "";
+  File file = ESPFS.open(path.c_str());
+  if (!file || file.isDirectory()) return request->reply(404);
+
+  size_t size = file.size();
+  size_t start = 0;
+  size_t end = size ? size - 1 : 0;
+  bool partial = false;
+  if (request->hasHeader("Range")) {
+    String range = request->header("Range");  // bytes=start-end, bytes=start- or bytes=-suffix
+    int dash = range.indexOf('-');
+    if (!range.startsWith("bytes=") || dash < 0) return request->reply(416);
+    String from = range.substring(6, dash);
+    String to = range.substring(dash + 1);
+    if (from.length()) {
+      start = from.toInt();
+      if (to.length()) end = std::min((size_t)to.toInt(), end);
+    } else
+      start = size - std::min((size_t)to.toInt(), size);
+    if (start >= size || start > end) return request->reply(416);
+    partial = true;
+  }
+  size_t length = size ? end - start + 1 : 0;
+
+  uint8_t* chunk = (uint8_t*)malloc(FILE_CHUNK_SIZE);
+  if (!chunk) return request->reply(500);
+
+  PsychicResponse response(request);
+  response.setContentType("application/octet-stream");
+  response.addHeader("Accept-Ranges", "bytes");
+  char buffer[48];
+  if (partial) {
+    httpd_resp_set_status(request->request(), "206 Partial Content");
+    snprintf(buffer, sizeof(buffer), "bytes %u-%u/%u", start, end, size);
+    response.addHeader("Content-Range", buffer);
+  }
+  if (request->hasParam("crc")) {
+    uint32_t crc = 0;
+    file.seek(start);
+    for (size_t done = 0; done < length;) {
+      size_t n = file.read(chunk, std::min((size_t)FILE_CHUNK_SIZE, length - done));
+      if (!n) break;
+      crc = esp_rom_crc32_le(crc, chunk, n);
+      done += n;
+    }
+    snprintf(buffer, sizeof(buffer), "%08x", crc);
+    response.addHeader("X-CRC32", buffer);
+  }
+  response.sendHeaders();
+
+  esp_err_t err = ESP_OK;
+  file.seek(start);
+  for (size_t done = 0; done < length && err == ESP_OK;) {
+    size_t n = file.read(chunk, std::min((size_t)FILE_CHUNK_SIZE, length - done));
+    if (!n) break;
+    err = response.sendChunk(chunk, n);
+    done += n;
+  }
+  free(chunk);
+  file.close();
+  if (err == ESP_OK) err = response.finishChunking();
+  return err;
+}
+
+#endif
@@ -9,8 +9,8 @@
     @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
 **/
 
-// * filesState: all files on FS
-// * folderList: all files in a folder
+// * filesState: FS size, showHidden and the paths changed by the last update (not the files, see FileIndex)
+// * folderList: the files in a folder, one page at a time from /rest/FileManager/list?path=...&offset=...&limit=...
 // * editableFile: current file
 // * getState / postFilesState: get filesState and post changes to files (update, delete, new)
 // * addFile / addFolder: create new items
@@ -18,7 +18,8 @@
 // * folderListFromBreadCrumbs: create folderList of current folder
 // * handleEdit: when edit button pressed: navigate back and forward through folders, edit current file
 // * confirmDelete: when delete button pressed
-// * socket files / handleFileState (->folderListFromBreadCrumbs)
+// * socket files / handleFileState (reload the folder if one of its files changed)
+// * file contents are not sent as JSON: POST /rest/FileManager/upload (chunks, CRC checked) and GET /rest/FileManager/download (ranges), see uploadFile in moonbase_utilities.ts
 // Using component FileManager, FileEditWidget and EditRowWidget, see [Components](https://moonmodules.org/MoonLight/components/#FileEditWidget)
 
 #ifndef FileManager_h
@@ -33,9 +34,16 @@
   #include <PsychicHttp.h>
   #include <WebSocketServer.h>
 
+  #include "FileIndex.h"
+  #include "MoonBase/Module.h"  // updateBus
+
+// path: the file or folder which changed (created, written, renamed or deleted), originId: who changed it
+typedef UpdateBus::Callback FileChangedCallback;
+
 class FilesState {
  public:
-  std::vector<String> updatedItems;
+  FileIndex index;
+  std::vector<String> changedPaths;  // by the last update
   bool showHidden = false;
 
   static void read(FilesState& settings, JsonObject& stateJson);
@@ -48,11 +56,38 @@ class FileManager : public StatefulService<FilesState> {
   FileManager(PsychicHttpServer* server, ESP32SvelteKit* sveltekit);
 
   void begin();
+  void loop();  // sveltekit task
+
+  // a file or folder was changed outside the File Manager: the index is updated and subscribers are notified in loop(). Can be called from any task
+  void changed(const char* path, const String& originId);
+
+  // callback is called (in the sveltekit task) for path, or for each changed path in a folder if path ends with / (e.g. "/.config/presets/")
+  UpdateBus::Id onFileChanged(const char* path, FileChangedCallback callback, const char* name = nullptr) { return updateBus.subscribe(path, callback, name); }
 
  protected:
   EventSocket* _socket;
 
  private:
+  std::vector<std::pair<String, String>> pendingChanges;  // path, originId
+  SemaphoreHandle_t pendingMutex = xSemaphoreCreateMutex();
+
+  esp_err_t list(PsychicRequest* request);
+
+  // chunked upload of one file at a time: the chunks are written to <path>.part, which replaces path after the last chunk if its CRC matches
+  struct Upload {
+    String path;
+    File file;
+    uint32_t size = 0;  // bytes received
+    uint32_t crc = 0;   // CRC-32 of the bytes received
+    int error = 0;      // http status of the current request if it failed
+  };
+  Upload upload;
+  esp_err_t uploadChunk(PsychicRequest* request, const String& filename, uint64_t index, uint8_t* data, size_t len, bool final);
+  esp_err_t uploadComplete(PsychicRequest* request);
+  void abortUpload();
+
+  esp_err_t download(PsychicRequest* request);
+
   HttpEndpoint<FilesState> _httpEndpoint;
   EventEndpoint<FilesState> _eventEndpoint;
   WebSocketServer<FilesState> _webSocketServer;
@@ -102,8 +102,11 @@ class ModuleIO : public Module {
     // #endif
 
     _sveltekit = sveltekit;
+  }
 
-    addUpdateHandler([this](const String& originId) { readPins(); }, false);
+  void begin() override {
+    Module::begin();
+    updateBus.subscribe("inputoutput/pins", [this](const char* topic, const char* originId) { readPins(); }, "IO pins");
   }
 
   void setupDefinition(const JsonArray& controls) override {
@@ -136,6 +139,9 @@ class ModuleIO : public Module {
     control = addControl(controls, "maxPower", "number", 0, 500, false, "Watt");
     control["default"] = 10;
 
+    control = addControl(controls, "maxCurrentPerPin", "number", 0, 10000, false, "mA");  // per LED pin, 0: no limit
+    control["default"] = 0;
+
     control = addControl(controls, "switch1", "checkbox");
     control["default"] = false;
 
@@ -568,7 +574,7 @@ class ModuleIO : public Module {
     } else if ((updatedItem.name == "switch1" || updatedItem.name == "switch2") && !_state.updateOriginId.contains("server")) {
       // rebuild with new switch setting
       newBoardID = _state.data["boardPreset"];  // run in sveltekit task
-    } else if (updatedItem.name == "maxPower" && !_state.updateOriginId.contains("server")) {
+    } else if ((updatedItem.name == "maxPower" || updatedItem.name == "maxCurrentPerPin") && !_state.updateOriginId.contains("server")) {
       object["modded"] = true;
     } else if (updatedItem.name == "usage" && !_state.updateOriginId.contains("server")) {  // not done by this module: done by UI
       object["modded"] = true;
@@ -802,12 +808,13 @@ class ModuleIO : public Module {
       uint32_t adc_mv_cinput = analogReadMilliVolts(pinCurrent);
       analogSetAttenuation(ADC_11db);
       current_readout_current_adc_attenuation = adc_get_adjusted_gain(current_readout_current_adc_attenuation, adc_mv_cinput);
+      float current = 0;
       if (adc_mv_cinput > 330)  // datasheet quiescent output voltage of 0.5V, which is ~330mV after the 10k/5k1 voltage divider. Ideally, this value should be measured at boot when nothing is displayed on the LEDs
       {
-        batteryService->updateCurrent((((float)(adc_mv_cinput)-330) * 37.75) / 1000);  // 40mV / A with a 10k/5k1 resistor divider, so a 37.75mA/mV
-      } else {
-        batteryService->updateCurrent(0);
+        current = (((float)(adc_mv_cinput)-330) * 37.75) / 1000;  // 40mV / A with a 10k/5k1 resistor divider, so a 37.75mA/mV
       }
+      batteryService->updateCurrent(current);
+      _sveltekit->getAnalyticsService()->current = current;  // shown next to the estimated current in System Metrics
     }
   #endif
   }
@@ -44,6 +44,18 @@ class ModuleTasks : public Module {
       addControl(rows, "runtime", "text", 0, 32, true);
       addControl(rows, "core", "number", 0, 65538, true);
     }
+
+    control = addControl(controls, "subscribers", "rows");  // of updateBus
+    control["filter"] = "";
+    control["crud"] = "r";
+    rows = control["n"].to<JsonArray>();
+    {
+      addControl(rows, "name", "text", 0, 32, true);
+      addControl(rows, "topic", "text", 0, 64, true);
+      addControl(rows, "calls", "number", 0, UINT16_MAX, true);
+      addControl(rows, "latency", "text", 0, 32, true);
+      addControl(rows, "duration", "text", 0, 32, true);
+    }
   }
 
   void loop1s() {
@@ -125,6 +137,19 @@ class ModuleTasks : public Module {
     controls["core1"] = pcTaskGetName(current1);
   #endif
 
+    JsonArray subscribers = controls["subscribers"].to<JsonArray>();
+    updateBus.forEach([&](const UpdateBus::Subscriber& subscriber) {
+      JsonObject row = subscribers.add<JsonObject>();
+      Char<32> text;
+      row["name"] = (char*)subscriber.name.c_str();  // enforces copy
+      row["topic"] = (char*)subscriber.topic.c_str();
+      row["calls"] = subscriber.stats.calls;
+      text.format("%d / %d µs", subscriber.stats.latencyAvg, subscriber.stats.latencyMax);  // avg / max
+      row["latency"] = (char*)text.c_str();
+      text.format("%d / %d µs", subscriber.stats.durationAvg, subscriber.stats.durationMax);
+      row["duration"] = (char*)text.c_str();
+    });
+
     // UpdatedItem updatedItem;
     // _state.compareRecursive("", _state.data, controls, updatedItem); //fill data with doc
 
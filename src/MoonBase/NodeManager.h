@@ -15,6 +15,7 @@
 #if FT_MOONLIGHT
 
   #include "MoonBase/Module.h"
+  #include "NodeRegistry.h"
   #include "Nodes.h"  //Nodes.h will include VirtualLayer.h which will include PhysicalLayer.h
 
 class NodeManager : public Module {
@@ -35,59 +36,24 @@ class NodeManager : public Module {
 
   void begin() {
     Module::begin();
-    // if (false)
-    // if file changes, read the file and bring into state
-    // create a handler which recompiles the live script when the file of a current running live script changes in the File Manager
-    _fileManager->addUpdateHandler([this](const String& originId) {
-      EXT_LOGV(ML_TAG, "FileManager::updateHandler %s", originId.c_str());
-      // read the file state (read all files and folders on FS and collect changes)
-      _fileManager->read([&](FilesState& filesState) {
-        // loop over all changed files (normally only one)
-        for (auto updatedItem : filesState.updatedItems) {
-          // if file is the current live script, recompile it (to do: multiple live effects)
-          EXT_LOGV(ML_TAG, "updateHandler updatedItem %s", updatedItem.c_str());
-          Char<32> name;
-          name.format("/.config/%s.json", _moduleName);
-          if (equal(updatedItem.c_str(), name.c_str())) {
-            EXT_LOGV(ML_TAG, " %s updated -> call update %s", name.c_str(), updatedItem.c_str());
-            readFromFS();  // repopulates the state, processing file changes
-          }
-          // uint8_t index = 0;
-          // for (JsonObject nodeState: _state.data["nodes"].as<JsonArray>()) {
-
-          //     if (updatedItem == nodeState["name"]) {
-          //         EXT_LOGV(ML_TAG, "updateHandler equals current item -> livescript compile %s", updatedItem.c_str());
-          //         LiveScriptNode *liveScriptNode = (LiveScriptNode *)layerP.layers[0]->findLiveScriptNode(nodeState["name"]);
-          //         if (liveScriptNode) {
-          //             liveScriptNode->compileAndRun();
-
-          //             //wait until setup has been executed?
-
-          //             _moduleEffects->requestUIUpdate = true; //update the Effects UI
-          //         }
-
-          //         EXT_LOGV(ML_TAG, "update due to new node %s done", name.c_str());
-          //     }
-          //     index++;
-          // }
-        }
-      });
-    });
+    // if the config file of this module changes (e.g. a preset is loaded), read the file and bring into state
+    Char<32> name;
+    name.format("/.config/%s.json", _moduleName.c_str());
+    _fileManager->onFileChanged(name.c_str(), [this](const char* path, const char* originId) {
+      if (equal(originId, "FSPersistence")) return;  // written from the state itself
+      EXT_LOGV(ML_TAG, " %s updated -> call update", path);
+      readFromFS();  // repopulates the state, processing file changes
+    }, _moduleName.c_str());
+    // live scripts are listed in the definition (addNodes)
+    _fileManager->onFileChanged("/", [this](const char* path, const char* originId) {
+      if (strstr(path, ".sc")) definitionChanged();
+    }, _moduleName.c_str());
   }
 
   virtual void addNodes(const JsonObject& control) {}
 
   virtual Node* addNode(const uint8_t index, const char* name, const JsonArray& controls) const { return nullptr; }
 
-  template <typename T>
-  Node* checkAndAlloc(const char* name) const {
-    if (equalAZaz09(name, T::name())) {
-      EXT_LOGD(ML_TAG, "Allocate %s", name);
-      return allocMBObject<T>();
-    } else
-      return nullptr;
-  }
-
   // define the data model
   void setupDefinition(const JsonArray& controls) override {
     EXT_LOGV(ML_TAG, "");
@@ -122,6 +88,8 @@ class NodeManager : public Module {
 
   // implement business logic
   void onUpdate(const UpdatedItem& updatedItem) override {
+    controlTableValid = false;  // nodes or controls may have been added or removed
+
     // EXT_LOGD(ML_TAG, "%s[%d]%s[%d].%s = %s -> %s", updatedItem.parent[0].c_str(), updatedItem.index[0], updatedItem.parent[1].c_str(), updatedItem.index[1], updatedItem.name.c_str(), updatedItem.oldValue.c_str(), updatedItem.value.as<String>().c_str());
 
     // handle nodes
@@ -289,6 +257,7 @@ class NodeManager : public Module {
 
   void onReOrderSwap(uint8_t stateIndex, uint8_t newIndex) override {
     EXT_LOGD(ML_TAG, "%d %d %d", nodes->size(), stateIndex, newIndex);
+    controlTableValid = false;
     // swap nodes
     Node* nodeS = (*nodes)[stateIndex];
     Node* nodeN = (*nodes)[newIndex];
@@ -301,6 +270,51 @@ class NodeManager : public Module {
   }
 
  public:
+  // called in the socket task: coalesce with a pending update of the same control, applied in loop()
+  bool postControl(const ControlMessage::Message& message) override {
+    bool accepted = false;
+    portENTER_CRITICAL(&pendingLock);
+    for (uint8_t i = 0; i < nrOfPending; i++) {
+      if (pending[i].node == message.node && pending[i].control == message.control) {
+        pending[i] = message;
+        accepted = true;
+        break;
+      }
+    }
+    if (!accepted && nrOfPending < maxPending) {
+      pending[nrOfPending++] = message;
+      accepted = true;
+    }
+    portEXIT_CRITICAL(&pendingLock);
+    return accepted;
+  }
+
+  void controlsChanged() override { controlTableValid = false; }
+
+  void loop() override {
+    Module::loop();
+    applyControls();
+  }
+
+  // the node named name (without dim and tags, e.g. "Noise2D") or running the live script with file name name (e.g. "E_noise.sc"), nullptr if none
+  Node* findNode(const char* name) {
+    Node* found = nullptr;
+    if (!nodes) return found;
+    size_t length = strlen(name);
+    read([&](ModuleState& state) {
+      uint8_t i = 0;
+      for (JsonObject nodeState : state.data["nodes"].as<JsonArray>()) {
+        const char* nodeName = nodeState["name"];
+        if (!found && nodeName && i < nodes->size()) {
+          const char* fileName = strrchr(nodeName, '/');
+          if ((strncmp(nodeName, name, length) == 0 && (nodeName[length] == ' ' || nodeName[length] == '\0')) || (fileName && equal(fileName + 1, name))) found = (*nodes)[i];
+        }
+        i++;
+      }
+    });
+    return found;
+  }
+
   #if FT_LIVESCRIPT
   Node* findLiveScriptNode(const char* animation) {
     if (!nodes) return nullptr;
@@ -317,6 +331,143 @@ class NodeManager : public Module {
     return nullptr;
   }
   #endif
+
+ private:
+  // Fast path for binary control messages (ControlMessage.h): the value is validated against the control table and written to the variable of the node
+  // directly, without JsonDocument and compareRecursive. Only control["value"] is patched in the state, the state is sent to the UI and saved
+  // (delayed write) once the control stops moving for echoDelay ms.
+  static const uint8_t maxPending = 8;
+  static const uint16_t echoDelay = 250;
+
+  struct ControlSlot {
+    void* pointer;
+    float min;
+    float max;
+    uint8_t size;  // 8, 16, 32, 33 (float) as in Node::addControl, 1: bool (checkbox)
+    uint8_t node;
+    uint8_t control;
+  };
+  std::vector<ControlSlot> controlTable;  // rebuilt after nodes or controls changed
+  std::atomic<bool> controlTableValid = false;
+
+  portMUX_TYPE pendingLock = portMUX_INITIALIZER_UNLOCKED;
+  ControlMessage::Message pending[maxPending];
+  uint8_t nrOfPending = 0;
+  bool echoPending = false;
+  uint32_t lastControlMillis = 0;
+
+  void buildControlTable() {
+    controlTable.clear();
+    uint8_t n = 0;
+    for (JsonObject nodeState : _state.data["nodes"].as<JsonArray>()) {
+      uint8_t c = 0;
+      for (JsonObject control : nodeState["controls"].as<JsonArray>()) {
+        uint32_t pointer = control["p"];
+        uint8_t size = control["size"];
+        if (pointer && !control["ro"].as<bool>()) {
+          if (control["type"] == "checkbox") {
+            if (size == sizeof(bool)) controlTable.push_back({(void*)pointer, 0, 1, 1, n, c});
+          } else if (control["type"] == "slider" || control["type"] == "select" || control["type"] == "pin" || control["type"] == "number") {
+            if (size == 8 || size == 16 || size == 32 || size == 33) {
+              size_t nrOfValues = control["values"].size();  // select
+              float max = !control["max"].isNull() ? control["max"].as<float>() : nrOfValues ? nrOfValues - 1 : UINT8_MAX;
+              controlTable.push_back({(void*)pointer, control["min"] | 0.0f, max, size, n, c});
+            }
+          }
+        }
+        c++;
+      }
+      n++;
+    }
+    controlTableValid = true;
+    EXT_LOGD(ML_TAG, "%s: %d controls", _moduleName.c_str(), controlTable.size());
+  }
+
+  void applyControls() {
+    ControlMessage::Message messages[maxPending];
+    portENTER_CRITICAL(&pendingLock);
+    uint8_t count = nrOfPending;
+    for (uint8_t i = 0; i < count; i++) messages[i] = pending[i];
+    nrOfPending = 0;
+    portEXIT_CRITICAL(&pendingLock);
+
+    if (count) {
+      if (!controlTableValid) buildControlTable();
+      for (uint8_t i = 0; i < count; i++) applyControl(messages[i]);
+      echoPending = true;
+      lastControlMillis = millis();
+    } else if (echoPending && millis() - lastControlMillis >= echoDelay) {
+      echoPending = false;
+      saveNeeded = true;
+      requestUIUpdate = true;  // send the patched state to the UI and write it (ModulePersistence)
+    }
+  }
+
+  const ControlSlot* findControlSlot(uint8_t node, uint8_t control) const {
+    for (const ControlSlot& s : controlTable)
+      if (s.node == node && s.control == control) return &s;
+    return nullptr;
+  }
+
+  void applyControl(const ControlMessage::Message& message) {
+    const ControlSlot* slot = findControlSlot(message.node, message.control);
+    JsonObject control = _state.data["nodes"][message.node]["controls"][message.control];
+    if (slot && slot->pointer != (void*)control["p"].as<uint32_t>()) {  // controls registered again since the table was built
+      buildControlTable();
+      slot = findControlSlot(message.node, message.control);
+    }
+    if (!slot || message.node >= nodes->size() || (*nodes)[message.node] == nullptr) {
+      EXT_LOGW(ML_TAG, "%s: no control %d of node %d", _moduleName.c_str(), message.control, message.node);
+      return;
+    }
+    float value = message.asFloat();
+    if (isnan(value)) return;
+    value = value < slot->min ? slot->min : value > slot->max ? slot->max : value;
+
+    Char<20> oldValue;
+    switch (slot->size) {
+      case 1:
+        oldValue = *(bool*)slot->pointer ? "true" : "false";
+        *(bool*)slot->pointer = value != 0;
+        break;
+      case 8:
+        oldValue.format("%d", *(uint8_t*)slot->pointer);
+        *(uint8_t*)slot->pointer = value;
+        break;
+      case 16:
+        oldValue.format("%d", *(uint16_t*)slot->pointer);
+        *(uint16_t*)slot->pointer = value;
+        break;
+      case 32:
+        oldValue.format("%d", *(int*)slot->pointer);
+        *(int*)slot->pointer = message.type == ControlMessage::value_int ? constrain(message.value.i, (int32_t)slot->min, (int32_t)slot->max) : (int)value;  // int32 is not exact as float
+        break;
+      case 33:
+        oldValue.format("%g", *(float*)slot->pointer);
+        *(float*)slot->pointer = value;
+        break;
+    }
+
+    // patch the state in place: an existing value is overwritten, scalars don't allocate
+    beginTransaction();
+    if (slot->size == 1)
+      control["value"] = *(bool*)slot->pointer;
+    else if (slot->size == 33)
+      control["value"] = *(float*)slot->pointer;
+    else if (slot->size == 32)
+      control["value"] = *(int*)slot->pointer;
+    else
+      control["value"] = (int)value;
+    endTransaction();
+
+    Char<32> path;
+    path.format("nodes/%d/controls/%d", message.node, message.control);
+    markDirty(path.c_str());  // patched without compareRecursive, written at the next save
+
+    Node* nodeClass = (*nodes)[message.node];
+    nodeClass->onUpdate(oldValue, control);  // custom onUpdate for the node
+    nodeClass->requestMappings();
+  }
 };
 
 #endif
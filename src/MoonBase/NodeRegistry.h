@@ -0,0 +1,112 @@
+/**
+    @title     MoonLight
+    @file      NodeRegistry.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/develop/nodes/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#ifndef NodeRegistry_h
+#define NodeRegistry_h
+
+#if FT_MOONLIGHT
+
+  #include <assert.h>
+
+  #include <algorithm>
+  #include <type_traits>
+
+  #include "Nodes.h"
+
+// One entry per node class: metadata and factory, generated from the class by NodeEntry::of<T>()
+struct NodeEntry {
+  uint32_t hash;  // hashAZaz09 of name()
+  const char* (*name)();
+  const char* (*tags)();
+  uint8_t (*dim)();
+  Node* (*alloc)();
+
+  String nameAndTags() const { return getNameAndTags(name(), dim(), tags()); }
+
+  template <typename T>
+  static NodeEntry of() {
+    return {hashAZaz09(T::name()), &T::name, &T::tags, &T::dim, []() -> Node* {
+              T* node = allocMBObject<T>();
+              if (node) {
+                node->capabilities = T::caps();
+                node->capabilities.layout = strstr(T::tags(), "🚥") != nullptr;
+                node->capabilities.modifyXYZ = overridesModifyXYZ<T>();
+                if (node->capabilities.modifyXYZ && !node->hasModifyXYZ()) {  // still works (called on each XYZ), but hasModifyXYZ was forgotten
+                  EXT_LOGW(ML_TAG, "%s: modifyXYZ without hasModifyXYZ", T::name());
+                  assert(!"modifyXYZ without hasModifyXYZ");
+                }
+              }
+              return (Node*)node;
+            }};
+  }
+
+  // &T::modifyXYZ has type void (Node::*)(Coord3D&) if neither T nor a class between T and Node declares modifyXYZ
+  template <typename T>
+  static constexpr bool overridesModifyXYZ() {
+    return !std::is_same<decltype(&T::modifyXYZ), void (Node::*)(Coord3D&)>::value;
+  }
+};
+
+// The node classes a module can create, as one type list: NodeRegistry<SolidEffect, LinesEffect, ...>
+// entries() is in the order of the type list (the order shown in the UI), find() looks up a UI name (name, dim and tags)
+// by binary search on the hash of its alphanumeric characters, so no strings are built or compared per class.
+template <typename... Ts>
+class NodeRegistry {
+ public:
+  static constexpr size_t size = sizeof...(Ts);
+  static_assert(size > 0 && size <= UINT8_MAX, "NodeRegistry: 1..255 node classes");
+
+  static const NodeEntry* begin() { return entries(); }
+  static const NodeEntry* end() { return entries() + size; }
+
+  // nullptr if name is not one of the node classes
+  static const NodeEntry* find(const char* name) {
+    if (name == nullptr) return nullptr;
+    const uint8_t* index = sortedIndex();
+    const NodeEntry* entry = entries();
+    uint32_t hash = hashAZaz09(name);
+    const uint8_t* it = std::lower_bound(index, index + size, hash, [entry](uint8_t i, uint32_t hash) { return entry[i].hash < hash; });
+    for (; it != index + size && entry[*it].hash == hash; it++)  // confirm, equal hashes are possible
+      if (equalAZaz09(name, entry[*it].name())) return &entry[*it];
+    return nullptr;
+  }
+
+  // allocate the node class with this UI name, nullptr if not found
+  static Node* alloc(const char* name) {
+    const NodeEntry* entry = find(name);
+    if (!entry) return nullptr;
+    EXT_LOGD(ML_TAG, "Allocate %s", name);
+    return entry->alloc();
+  }
+
+ private:
+  static const NodeEntry* entries() {
+    static const NodeEntry table[size] = {NodeEntry::of<Ts>()...};
+    return table;
+  }
+
+  // indexes of entries() sorted by hash, built once
+  static const uint8_t* sortedIndex() {
+    static const uint8_t* index = []() {
+      static uint8_t sorted[size];
+      const NodeEntry* entry = entries();
+      for (uint8_t i = 0; i < size; i++) sorted[i] = i;
+      std::sort(sorted, sorted + size, [entry](uint8_t a, uint8_t b) { return entry[a].hash < entry[b].hash; });
+      for (uint8_t i = 1; i < size; i++)
+        if (equalAZaz09(entry[sorted[i - 1]].name(), entry[sorted[i]].name())) EXT_LOGW(ML_TAG, "NodeRegistry: %s registered twice", entry[sorted[i]].name());
+      return sorted;
+    }();
+    return index;
+  }
+};
+
+#endif
+#endif
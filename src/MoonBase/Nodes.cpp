@@ -70,39 +70,127 @@ void Node::updateControl(const JsonObject& control) {
     #define USE_FASTLED  // as ESPLiveScript.h calls hsv ! one of the reserved functions!!
     #include "ESPLiveScript.h"
 
-Node* gNode = nullptr;
+Node* gNode = nullptr;  // the last compiled script, for functions called outside main (onLayout)
+
+// the node and layer of the script running in this task, set by bindNode at the start of main, so functions called for each light
+// do not have to look them up and multiple scripts can run at the same time
+static thread_local LiveScriptNode* scriptNode = nullptr;
+static thread_local VirtualLayer* scriptLayer = nullptr;
+
+static void _bindNode(uint32_t node) {
+  scriptNode = (LiveScriptNode*)node;
+  scriptLayer = scriptNode->layer;
+  uint8_t starting = LiveScriptNode::scriptStarting;
+  scriptNode->scriptState.compare_exchange_strong(starting, LiveScriptNode::scriptInSetup);  // the task of the script runs (not main of a script without loop)
+}
+static inline Node* currentNode() { return scriptNode ? scriptNode : gNode; }
+static inline VirtualLayer* currentLayer() { return scriptLayer ? scriptLayer : gNode->layer; }
+
+static thread_local uint32_t startedNr = 0;  // the frame the script draws
+
+// wait until loop() opens a frame, false if the script should stop
+static bool waitFrame(LiveScriptNode* node) {
+  while (xSemaphoreTake(node->frameStart, pdMS_TO_TICKS(100)) == pdFALSE)  // node off or no frames: wait, blocked
+    if (node->stopRequested) return false;
+  startedNr = node->frameNr;
+  return !node->stopRequested;
+}
+
+// at the start of the light functions: false if they should not write as the script should stop.
+// If loop() closed the frame of the script (over budget), the script waits here for the next frame: it is paused by itself, not suspended
+static bool checkFrame() {
+  LiveScriptNode* node = scriptNode;
+  if (!node) return true;  // onLayout or main of a script without loop: not in a task of its own
+  if (node->stopRequested) return false;
+  if (node->scriptState != LiveScriptNode::scriptInLoop || (node->frameOpen && startedNr == node->frameNr)) return true;
+  return waitFrame(node);
+}
 
 static void _addControl(uint8_t* var, char* name, char* type, uint8_t min = 0, uint8_t max = UINT8_MAX) {
   EXT_LOGV(ML_TAG, "%s %s %d (%d-%d)", name, type, var, min, max);
-  gNode->addControl(*var, name, type, min, max);
+  currentNode()->addControl(*var, name, type, min, max);
 }
 static void _nextPin() { layerP.nextPin(); }
 static void _addLight(uint8_t x, uint8_t y, uint8_t z) { layerP.addLight({x, y, z}); }
 
-static void _modifySize() { gNode->modifySize(); }
-static void _modifyPosition(Coord3D& position) { gNode->modifyPosition(position); }  // need &position parameter
+static void _modifySize() { currentNode()->modifySize(); }
+static void _modifyPosition(Coord3D& position) { currentNode()->modifyPosition(position); }  // need &position parameter
 // static void _modifyXYZ() {gNode->modifyXYZ();}//need &position parameter
 
-void _fadeToBlackBy(uint8_t fadeValue) { gNode->layer->fadeToBlackBy(fadeValue); }
-static void _setRGB(uint16_t indexV, CRGB color) { gNode->layer->setRGB(indexV, color); }
-static void _setRGBPal(uint16_t indexV, uint8_t index, uint8_t brightness) { gNode->layer->setRGB(indexV, ColorFromPalette(PartyColors_p, index, brightness)); }
-static void _setPan(uint16_t indexV, uint8_t value) { gNode->layer->setPan(indexV, value); }
-static void _setTilt(uint16_t indexV, uint8_t value) { gNode->layer->setTilt(indexV, value); }
-
-volatile xSemaphoreHandle WaitAnimationSync = xSemaphoreCreateBinary();
-
-void sync() {
-  static uint32_t frameCounter = 0;
-  frameCounter++;
-  delay(1);  // feed the watchdog, otherwise watchdog will reset the ESP
-  // Serial.print("s");
-  // 🌙 adding semaphore wait too long logging
-  if (xSemaphoreTake(WaitAnimationSync, pdMS_TO_TICKS(100)) == pdFALSE) {
-    EXT_LOGW(ML_TAG, "WaitAnimationSync wait too long");
-    xSemaphoreTake(WaitAnimationSync, portMAX_DELAY);
+void _fadeToBlackBy(uint8_t fadeValue) {
+  if (checkFrame()) currentLayer()->fadeToBlackBy(fadeValue);
+}
+static void _setRGB(uint16_t indexV, CRGB color) {
+  if (checkFrame()) currentLayer()->setRGB(indexV, color);
+}
+static void _setRGBPal(uint16_t indexV, uint8_t index, uint8_t brightness) {
+  if (checkFrame()) currentLayer()->setRGB(indexV, ColorFromPalette(layerP.palette, index, brightness));
+}
+static void _setPan(uint16_t indexV, uint8_t value) {
+  if (checkFrame()) currentLayer()->setPan(indexV, value);
+}
+static void _setTilt(uint16_t indexV, uint8_t value) {
+  if (checkFrame()) currentLayer()->setTilt(indexV, value);
+}
+
+// bulk functions: one call from the script for many lights
+static void _fill(CRGB color) {
+  if (checkFrame()) currentLayer()->fill_solid(color);
+}
+static void _fillSpan(uint16_t indexV, uint16_t count, CRGB color) {
+  if (!checkFrame()) return;
+  VirtualLayer* layer = currentLayer();
+  uint16_t end = MIN(indexV + count, layer->nrOfLights);
+  for (uint16_t i = indexV; i < end; i++) layer->setRGB(i, color);
+}
+// palette gradient: index, index + delta, index + 2 * delta ...
+static void _fillPalSpan(uint16_t indexV, uint16_t count, uint8_t index, uint8_t delta, uint8_t brightness) {
+  if (!checkFrame()) return;
+  VirtualLayer* layer = currentLayer();
+  uint16_t end = MIN(indexV + count, layer->nrOfLights);
+  for (uint16_t i = indexV; i < end; i++, index += delta) layer->setRGB(i, ColorFromPalette(layerP.palette, index, brightness));
+}
+// palette index per light from an array of the script, e.g. a row of noise values
+static void _setRGBPalSpan(uint16_t indexV, uint16_t count, uint8_t* indexes, uint8_t brightness) {
+  if (!checkFrame()) return;
+  VirtualLayer* layer = currentLayer();
+  uint16_t end = MIN(indexV + count, layer->nrOfLights);
+  for (uint16_t i = indexV; i < end; i++) layer->setRGB(i, ColorFromPalette(layerP.palette, *indexes++, brightness));
+}
+static uint32_t _frameMillis() { return layerP.frameScheduler.frameMillis; }  // animation time, see FrameScheduler.h
+static void _blur1d(uint8_t amount) {
+  if (checkFrame()) currentLayer()->blur1d(amount);
+}
+static void _blur2d(uint8_t amount) {
+  if (checkFrame()) currentLayer()->blur2d(amount);
+}
+
+// the condition of the loop in main (see compileAndRun): end the frame of the script and wait for the next (LiveScriptNode::loop).
+// 0: stop, main returns and the task of the script ends
+static uint8_t _nextFrame() {
+  LiveScriptNode* node = scriptNode;
+  if (!node) return 0;
+  if (node->scriptState == LiveScriptNode::scriptInLoop) {
+    node->doneNr = startedNr;
+    xSemaphoreGive(node->frameDone);
+  } else
+    node->scriptState = LiveScriptNode::scriptInLoop;
+  if (!node->stopRequested && waitFrame(node)) return 1;
+
+  if (node->runaway) {
+    EXT_LOGW(ML_TAG, "%s runaway: %d ms over budget, stopped", node->animation, LiveScriptNode::runawayMicros / 1000);
+    for (Executable& exec : scriptRuntime._scExecutables)
+      if (exec.name == node->animation) exec.error.error_message = "runaway: stopped";
   }
+  scriptNode = nullptr;
+  scriptLayer = nullptr;
+  node->scriptState = LiveScriptNode::scriptIdle;  // last: the node can be deleted from here
+  return 0;
 }
 
+// sync() of the script runtime: a script which calls it waits there if its frame is over
+void sync() { checkFrame(); }
+
 void addExternal(string definition, void* ptr) {
   bool success = false;
   size_t firstSpace = definition.find(' ');
@@ -147,7 +235,7 @@ void LiveScriptNode::setup() {
   // make sure types in below functions are correct !!! otherwise livescript will crash
 
   // generic functions
-  addExternal("uint32_t millis()", (void*)millis);
+  addExternal("uint32_t millis()", (void*)_frameMillis);  // animation time: with fixed pacing the same step each frame
   addExternal("uint32_t now()", (void*)millis);  // todo: synchronized time (sys->now)
   addExternal("uint16_t random16(uint16_t)", (void*)(uint16_t (*)(uint16_t))random16);
   addExternal("void delay(uint32_t)", (void*)delay);
@@ -182,15 +270,25 @@ void LiveScriptNode::setup() {
   //   addExternal( "uint8_t clockFreq", &layerP.ledsDriver.clockFreq);
   //   addExternal( "uint8_t dmaBuffer", &layerP.ledsDriver.dmaBuffer);
 
+  addExternal("void bindNode(uint32_t)", (void*)_bindNode);
+  addExternal("uint8_t nextFrame()", (void*)_nextFrame);
   addExternal("void fadeToBlackBy(uint8_t)", (void*)_fadeToBlackBy);
   addExternal("CRGB* leds", (void*)(CRGB*)layerP.lights.channelsE);
   addExternal("void setRGB(uint16_t,CRGB)", (void*)_setRGB);
   addExternal("void setRGBPal(uint16_t,uint8_t,uint8_t)", (void*)_setRGBPal);
   addExternal("void setPan(uint16_t,uint8_t)", (void*)_setPan);
   addExternal("void setTilt(uint16_t,uint8_t)", (void*)_setTilt);
+  addExternal("void fill(CRGB)", (void*)_fill);
+  addExternal("void fillSpan(uint16_t,uint16_t,CRGB)", (void*)_fillSpan);
+  addExternal("void fillPalSpan(uint16_t,uint16_t,uint8_t,uint8_t,uint8_t)", (void*)_fillPalSpan);
+  addExternal("void setRGBPalSpan(uint16_t,uint16_t,uint8_t*,uint8_t)", (void*)_setRGBPalSpan);
+  addExternal("void blur1d(uint8_t)", (void*)_blur1d);
+  addExternal("void blur2d(uint8_t)", (void*)_blur2d);
+  // variables: read directly by the script, no call
   addExternal("uint8_t width", &layer->size.x);
   addExternal("uint8_t height", &layer->size.y);
   addExternal("uint8_t depth", &layer->size.z);
+  addExternal("uint16_t nrOfLights", &layer->nrOfLights);
   addExternal("bool on", &on);
 
   //   for (asm_external el: external_links) {
@@ -203,21 +301,70 @@ void LiveScriptNode::setup() {
   compileAndRun();
 }
 
+// in the effect task
 void LiveScriptNode::loop() {
-  // Serial.print("l");
-  xSemaphoreGive(WaitAnimationSync);
+  std::unique_lock<std::mutex> lock(scriptMutex, std::try_to_lock);
+  if (!lock.owns_lock() || scriptState != scriptInLoop || stopRequested) return;  // being stopped or started, in setup or stopped
+
+  if (on) layerP.dirty.markAll();  // the script runs its loop() this frame and can write leds[] directly
+
+  xSemaphoreTake(frameDone, 0);  // the end of a closed frame which came after it was closed
+  uint32_t nr = ++frameNr;
+  frameOpen = true;
+  xSemaphoreGive(frameStart);
+
+  uint32_t start = micros();
+  uint32_t elapsed = 0;
+  while (elapsed < frameBudgetMicros && xSemaphoreTake(frameDone, pdMS_TO_TICKS((frameBudgetMicros - elapsed) / 1000)) == pdTRUE) {
+    if (doneNr == nr) {
+      frameOpen = false;
+      overrunMicros = 0;
+      return;
+    }
+    elapsed = micros() - start;  // the end of the closed frame: wait for this one in the rest of the budget
+  }
+
+  frameOpen = false;  // the script waits for the next frame at its next light function, the next nodes and the driver run without it
+  overrunMicros += frameBudgetMicros;
+  if (overrunMicros >= runawayMicros) {
+    runaway = true;
+    stopRequested = true;  // logged by the script when it stops
+  }
 }
 
 void LiveScriptNode::onLayout() {
   if (hasOnLayout()) {
     EXT_LOGV(ML_TAG, "%s", animation);
+    gNode = this;  // not in main: not bound to the task
     scriptRuntime.execute(animation, "onLayout");
   }
 }
 
 LiveScriptNode::~LiveScriptNode() {
   EXT_LOGV(ML_TAG, "%s", animation);
-  scriptRuntime.kill(animation);
+  kill();  // returns when the task of the script does not use the node anymore
+  if (frameStart) vSemaphoreDelete(frameStart);
+  if (frameDone) vSemaphoreDelete(frameDone);
+}
+
+// scriptMutex locked. The script stops at its next light function or loop, a task which was started but does not run is waited for runawayMicros
+void LiveScriptNode::stopScript() {
+  if (scriptState != scriptIdle) {
+    stopRequested = true;
+    xSemaphoreGive(frameStart);  // if it waits for a frame
+    uint32_t start = millis();
+    while (scriptState != scriptIdle && (scriptState != scriptStarting || millis() - start < runawayMicros / 1000)) delay(10);
+    if (scriptState != scriptIdle) {
+      EXT_LOGW(ML_TAG, "%s: task did not start", animation);
+      scriptState = scriptIdle;
+    }
+  }
+  stopRequested = false;
+  runaway = false;
+  frameOpen = false;
+  overrunMicros = 0;
+  if (frameStart) xSemaphoreTake(frameStart, 0);
+  if (frameDone) xSemaphoreTake(frameDone, 0);
 }
 
 // LiveScriptNode functions
@@ -241,18 +388,23 @@ void LiveScriptNode::compileAndRun() {
     if (scScript.find("loop()") != std::string::npos) hasLoopFunction = true;
     if (scScript.find("onLayout()") != std::string::npos) hasOnLayoutFunction = true;
     if (scScript.find("modifyPosition(") != std::string::npos) hasModifyFunction = true;
+    capabilities.layout = hasOnLayoutFunction && !hasLoopFunction;  // layout script: replayed from the layout cache, see PhysicalLayer::mapLayout
     //   if (scScript.find("modifyXYZ(") != std::string::npos) hasModifier = true;
 
     // add main function
-    scScript += "void main(){";
+    scScript += "void main(){bindNode(" + std::to_string((uint32_t)this) + ");";  // node and layer of this script for the functions it calls
     if (hasSetupFunction) scScript += "setup();";
-    if (hasLoopFunction) scScript += "while(true){if(on){loop();sync();}else delay(1);}";  // loop must pauze when layout changes pass == 1! delay to avoid idle
+    if (hasLoopFunction) scScript += "while(nextFrame()){if(on)loop();}";  // nextFrame: wait for the frame, 0: stop, see LiveScriptNode::loop
     scScript += "}";
 
     EXT_LOGV(ML_TAG, "script \n%s", scScript.c_str());
 
     // EXT_LOGV(ML_TAG, "parsing %s", scScript.c_str());
 
+    // the variables of the controls are in the executable which is replaced: unusable until the script registers them again (setup)
+    for (JsonObject control : controls) control.remove("p");
+    if (moduleNodes) moduleNodes->controlsChanged();
+
     Executable executable = parser.parseScript(&scScript);  // note that this class will be deleted after the function call !!!
     executable.name = animation;
     EXT_LOGV(ML_TAG, "parsing %s done", animation);
@@ -282,6 +434,13 @@ void LiveScriptNode::execute() {
   }
   EXT_LOGV(ML_TAG, "%s", animation);
 
+  if (!frameStart) frameStart = xSemaphoreCreateBinary();
+  if (!frameDone) frameDone = xSemaphoreCreateBinary();
+  {
+    std::lock_guard<std::mutex> lock(scriptMutex);
+    stopScript();  // if running: a new task
+  }
+
   requestMappings();  // requestMapPhysical and requestMapVirtual will call the script onLayout function (check if this can be done in case the script also has loop running !!!)
 
   if (hasLoopFunction) {
@@ -290,18 +449,22 @@ void LiveScriptNode::execute() {
     // send controls to UI
     // executable.executeAsTask("main"); //background task (async - vs sync)
     EXT_LOGV(ML_TAG, "%s executeAsTask main", animation);
+    scriptState = scriptStarting;
     scriptRuntime.executeAsTask(animation, "main");  // background task (async - vs sync)
     // assert failed: xEventGroupSync event_groups.c:228 (uxBitsToWaitFor != 0)
   } else {
     EXT_LOGV(ML_TAG, "%s execute main", animation);
     scriptRuntime.execute(animation, "main");
+    scriptNode = nullptr;  // main ran in this task, which is not the task of the script
+    scriptLayer = nullptr;
   }
   EXT_LOGV(ML_TAG, "%s execute started", animation);
 }
 
 void LiveScriptNode::kill() {
   EXT_LOGV(ML_TAG, "%s", animation);
-  scriptRuntime.kill(animation);
+  std::lock_guard<std::mutex> lock(scriptMutex);
+  stopScript();
 }
 
 void LiveScriptNode::free() {
@@ -311,7 +474,7 @@ void LiveScriptNode::free() {
 
 void LiveScriptNode::killAndDelete() {
   EXT_LOGV(ML_TAG, "%s", animation);
-  scriptRuntime.kill(animation);
+  kill();
   // scriptRuntime.free(animation);
   scriptRuntime.deleteExe(animation);
 };
@@ -360,22 +523,18 @@ void DriverNode::setup() {
   addControlValue("MH BeeEyes 150W-15 🐺");     // 15 channels moving head, see https://moonmodules.org/MoonLight/moonlight/drivers/#art-net
   addControlValue("MH BeTopper 19x15W-32 🐺");  // 32 channels moving head
   addControlValue("MH 19x15W-24");              // 24 channels moving heads
+  addControl(layerP.dither, "dither", "checkbox");  // shared by all drivers, like lightPreset
 }
 
 void DriverNode::loop() {
   LightsHeader* header = &layerP.lights.header;
 
-  // use ledsDriver LUT for super efficient leds dimming 🔥 (used by reOrderAndDimRGBW)
-
-  uint8_t brightness = (header->offsetBrightness == UINT8_MAX) ? header->brightness : 255;  // set brightness to 255 if offsetBrightness is set (fixture will do its own brightness)
+  // use ledsDriver LUT for super efficient leds dimming 🔥 (used by outputMaps)
 
-  if (brightness != brightnessSaved || layerP.maxPower != maxPowerSaved) {
-    // Use FastLED for setMaxPowerInMilliWatts stuff
-    uint8_t correctedBrightness = calculate_max_brightness_for_power_mW((CRGB*)&layerP.lights.channelsD, layerP.lights.header.nrOfLights, brightness, layerP.maxPower * 1000);
-    // EXT_LOGD(ML_TAG, "setBrightness b:%d + p:%d -> cb:%d", brightness, layerP.maxPower, correctedBrightness);
-    ledsDriver.setBrightness(correctedBrightness);
-    brightnessSaved = brightness;
-    maxPowerSaved = layerP.maxPower;
+  // brightness within the power budget, estimated per frame by layerP.estimatePower (255 if the fixture does its own brightness)
+  if (layerP.powerBrightness != brightnessSaved) {
+    ledsDriver.setBrightness(layerP.powerBrightness);
+    brightnessSaved = layerP.powerBrightness;
   }
 
   #if HP_ALL_DRIVERS
@@ -396,6 +555,12 @@ void DriverNode::loop() {
     ledsDriver.setColorCorrection(header->red, header->green, header->blue);
   }
   #endif
+
+  // dither LUT from the same maps, so dither on or off shows the same colors (only rebuilt if the maps changed)
+  if (layerP.ditherLut) {
+    const uint8_t* const maps[4] = {ledsDriver.__red_map, ledsDriver.__green_map, ledsDriver.__blue_map, ledsDriver.__white_map};
+    layerP.ditherLut->build(maps);
+  }
 }
 
 void DriverNode::onUpdate(const Char<20>& oldValue, const JsonObject& control) {
@@ -540,6 +705,9 @@ void DriverNode::onUpdate(const Char<20>& oldValue, const JsonObject& control) {
 
     EXT_LOGI(ML_TAG, "setLightPreset %d (cPL:%d, o:%d,%d,%d,%d)", header->lightPreset, header->channelsPerLight, header->offsetRed, header->offsetGreen, header->offsetBlue, header->offsetWhite);
 
+    const uint8_t groups[] = {header->offsetRGB, header->offsetRGB1, header->offsetRGB2, header->offsetRGB3};
+    layerP.outputStage.compile(header->channelsPerLight, groups, 4, header->offsetRed, header->offsetGreen, header->offsetBlue, header->offsetWhite);
+
     // FASTLED_ASSERT(true, "oki");
 
   #if HP_ALL_DRIVERS
@@ -564,14 +732,16 @@ void DriverNode::onUpdate(const Char<20>& oldValue, const JsonObject& control) {
   }
 }
 
-void DriverNode::reOrderAndDimRGBW(uint8_t* packetRGBChannel, uint8_t* lightsRGBChannel) {
+OutputStage::Maps DriverNode::outputMaps() {
   // use ledsDriver.__rbg_map[0]; for super fast brightness and gamma correction! see secondPixel in ESP32-LedDriver!
-  // apply the LUT to the RGB channels !
-
-  packetRGBChannel[layerP.lights.header.offsetRed] = ledsDriver.__red_map[lightsRGBChannel[0]];
-  packetRGBChannel[layerP.lights.header.offsetGreen] = ledsDriver.__green_map[lightsRGBChannel[1]];
-  packetRGBChannel[layerP.lights.header.offsetBlue] = ledsDriver.__blue_map[lightsRGBChannel[2]];
-  if (layerP.lights.header.offsetWhite != UINT8_MAX) packetRGBChannel[layerP.lights.header.offsetWhite] = ledsDriver.__white_map[lightsRGBChannel[3]];
+  OutputStage::Maps maps;
+  maps.map8[0] = ledsDriver.__red_map;
+  maps.map8[1] = ledsDriver.__green_map;
+  maps.map8[2] = ledsDriver.__blue_map;
+  maps.map8[3] = ledsDriver.__white_map;
+  maps.dither = layerP.ditherLut;  // 16 bit LUT, the fraction is dithered over the frames
+  maps.threshold = layerP.ditherThreshold;
+  return maps;
 }
 
 #endif  // FT_MOONLIGHT
\ No newline at end of file
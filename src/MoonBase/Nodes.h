@@ -15,6 +15,8 @@
 
   #include <ESPFS.h>
 
+  #include <atomic>
+
   #include "MoonBase/Modules/ModuleIO.h"      // Includes also Module.h but also enum IO_Pins
   #include "MoonLight/Layers/VirtualLayer.h"  //VirtualLayer.h will include PhysicalLayer.h
 
@@ -37,16 +39,28 @@ enum LightPresetsEnum {
   lightPreset_count
 };
 
+// what a node does with the lights, per class: static constexpr NodeCaps caps() next to name(), dim() and tags(),
+// copied to Node::capabilities when the node is allocated (no virtual call per frame). Used by VirtualLayer::loop to schedule the nodes.
+// The defaults are safe for any node, only set what the loop of the node guarantees.
+struct NodeCaps {
+  bool readsPrevious = true;   // loop reads the lights of the previous frame (getRGB, blur, fadeToBlackBy, addRGB, a modifier moving lights ...)
+  bool fullOverwrite = false;  // loop sets every light of its layer (e.g. fill_solid): effects before it are hidden and not run
+  bool usesAudio = false;      // reads sharedData audio (bands, volume)
+  bool bandParallel = false;   // rows can be rendered independently of each other (no reads or writes across rows)
+  uint8_t cost = 1;            // relative time per light: 1 light, 2 medium, 3 heavy (noise, trigonometry per light)
+  bool layout = false;         // layout node (🚥 tag, set by the NodeRegistry): onLayout only adds lights and pins, so it can be replayed from the layout cache
+  bool modifyXYZ = false;      // the class overrides modifyXYZ (set by the NodeRegistry): without hasModifyXYZ it is called on each XYZ instead of compiled
+};
+
   #define NODE_METADATA_VIRTUALS()                          \
     const char* getName() const override { return name(); } \
     uint8_t getDim() const override { return dim(); }       \
     const char* getTags() const override { return tags(); }
 
-template <typename T>
-String getNameAndTags() {
-  String result = T::name();
+// name, dim emoji and tags as shown in the UI
+inline String getNameAndTags(const char* name, uint8_t dim, const char* tags) {
+  String result = name;
 
-  uint8_t dim = T::dim();
   if (dim == _0D)
     result += " 💡";
   else if (dim == _1D)
@@ -56,19 +70,27 @@ String getNameAndTags() {
   else if (dim == _3D)
     result += " 🧊";
 
-  if (strlen(T::tags())) {
+  if (strlen(tags)) {
     result += " ";
-    result += T::tags();
+    result += tags;
   }
 
   return result;
 }
 
+template <typename T>
+String getNameAndTags() {
+  return getNameAndTags(T::name(), T::dim(), T::tags());
+}
+
 class Node {
  public:
   static const char* name() { return "noname"; }
   static const char* tags() { return ""; }
   static uint8_t dim() { return _NoD; };
+  static constexpr NodeCaps caps() { return NodeCaps(); }
+
+  NodeCaps capabilities;  // caps() of the class, set when allocated by the NodeRegistry
 
   VirtualLayer* layer = nullptr;  // the virtual layer this effect is using
   JsonArray controls;
@@ -81,6 +103,7 @@ class Node {
   virtual bool hasModifier() const { return false; }  // modifier new Node, on/off, control changed: run layout.requestMapLayout. onLayoutPre: modifySize, addLight: modifyPosition XYZ: modifyXYZ
 
   bool on = false;  // onUpdate will set it on
+  uint32_t loopMicros = 0;  // µs per loop (average), measured in VirtualLayer::loop
 
   // C++ constructors are not inherited, so declare it as normal functions
   virtual void constructor(VirtualLayer* layer, const JsonArray& controls) {
@@ -117,6 +140,7 @@ class Node {
     // update the control definition (see also setupDefinition...)
     control["type"] = type;
     control["default"] = variable;
+    if (control["p"] != (uint32_t)&variable && moduleNodes) moduleNodes->controlsChanged();  // new control or the variable moved
     control["p"] = (uint32_t)&variable;  // pointer to variable
     control["valid"] = true;             // invalid controls will be deleted
     // optional properties
@@ -221,8 +245,20 @@ class Node {
   virtual void loop20ms() {}
   virtual void onSizeChanged(const Coord3D& oldSize) {}  // virtual/effect nodes: virtual size, physical/driver nodes: physical size
 
+  // buffers which depend on the virtual layer size, carved from the arena of the layer (see NodeArena.h):
+  // (re)allocate them in onSizeChanged, zeroed, content is not kept. A size change of the layer frees them all (nullptr) before onSizeChanged
+  template <typename T>
+  T* allocArena(T*& buffer, size_t n) {
+    return (T*)layer->arena.alloc((void**)&buffer, n * sizeof(T));
+  }
+  template <typename T>
+  void freeArena(T*& buffer) {
+    layer->arena.release((void**)&buffer);
+  }
+
   // layout
   virtual void onLayout() {}  // the definition of the layout, called by mapLayout()
+  virtual uint32_t layoutVersion() const { return 0; }  // changes of onLayout which are not in the controls (e.g. a file it reads), part of the layout cache key
 
   // convenience functions to add a light
   void addLight(Coord3D position) { layerP.addLight(position); }
@@ -234,6 +270,10 @@ class Node {
   virtual void modifySize() {}
   virtual void modifyPosition(Coord3D& position) {}  // not const as position is changed
   virtual void modifyXYZ(Coord3D& position) {}
+  virtual bool hasModifyXYZ() const { return false; }  // true if modifyXYZ is implemented, else it is not compiled in the XYZ table (see NodeCaps::modifyXYZ)
+  // frame static: modifyXYZ only depends on the position and on state which changes at most once per frame (call layer->invalidateXYZ() when it changes)
+  // then VirtualLayer compiles all modifyXYZ in a table once per frame instead of calling them on each XYZ. Return false if not (e.g. random per call)
+  virtual bool isModifyXYZStatic() const { return true; }
 
   virtual ~Node() {}  // delete any allocated memory
 };
@@ -256,12 +296,33 @@ class LiveScriptNode : public Node {
 
   const char* animation = nullptr;  // which animation (file) to run
 
+  // The loop of the script runs in the task of the script, but only while loop() of this node waits for it: loop() opens the frame of the script,
+  // the script ends it in nextFrame() (the condition of its loop), so it writes the lights between the nodes before and after it, not during remapping or the buffer swap.
+  // The task is never suspended or killed from outside, it checks the frame itself (checkFrame, in the light functions):
+  // if the script needs more than frameBudgetMicros, loop() closes the frame and the script waits for the next frame at its next light function.
+  // After runawayMicros over budget, or when killed, it is asked to stop: the light functions return at once and nextFrame() ends main, so the task exits.
+  // kill() waits for that, so the node and its semaphores are only deleted after the task stopped using them.
+  static const uint32_t frameBudgetMicros = 20000;
+  static const uint32_t runawayMicros = 2000000;
+  enum ScriptState : uint8_t { scriptIdle, scriptStarting, scriptInSetup, scriptInLoop };
+  SemaphoreHandle_t frameStart = nullptr;         // given by loop()
+  SemaphoreHandle_t frameDone = nullptr;          // given by nextFrame()
+  std::atomic<uint32_t> frameNr = 0;              // the frame opened by loop()
+  std::atomic<uint32_t> doneNr = 0;               // the frame ended by the script, a frame closed by loop() can end after it
+  std::atomic<bool> frameOpen = false;            // loop() waits for the script
+  std::atomic<bool> stopRequested = false;        // kill or runaway
+  std::atomic<bool> runaway = false;              // logged by the task of the script when it stops
+  std::atomic<uint8_t> scriptState = scriptIdle;  // set by execute() and the task of the script, scriptIdle: the task does not use this node
+  uint32_t overrunMicros = 0;                     // over budget in consecutive frames
+  std::mutex scriptMutex;                         // loop() in the effect task, kill() and execute() in other tasks
+
   void setup() override;  // addExternal, compileAndRun
 
-  void loop() override;  // call Node.loop to process requestMapLayout. todo: sync with script...
+  void loop() override;  // run one frame of the script (see above)
 
   // layout
   void onLayout() override;  // call map in LiveScript
+  uint32_t layoutVersion() const override { return animation ? fileVersion(animation) : 0; }  // script changed
 
   ~LiveScriptNode();
 
@@ -269,6 +330,7 @@ class LiveScriptNode : public Node {
   void compileAndRun();
   void execute();
   void kill();
+  void stopScript();  // ask the task to stop and wait for it, scriptMutex locked
   void free();
   void killAndDelete();
   static void getScriptsJson(JsonArray scripts);
@@ -294,7 +356,6 @@ static LedsDriver ledsDriver;  //   only the core driver, for setBrightness and
 
 class DriverNode : public Node {
   uint8_t brightnessSaved = UINT8_MAX;
-  uint16_t maxPowerSaved = UINT16_MAX;
 
  protected:
   bool lightPresetSaved = false;  // initLeds can only start if this has been saved
@@ -309,7 +370,8 @@ class DriverNode : public Node {
 
   void loop() override;
 
-  void reOrderAndDimRGBW(uint8_t* packetRGBChannel, uint8_t* lightsRGBChannel);
+  // the LUTs of this frame for layerP.outputStage: brightness and color correction, dithered if dither is on
+  OutputStage::Maps outputMaps();
 
   // called in addControl (oldValue = "") and in NodeManager onUpdate nodes[i].control[j]
   void onUpdate(const Char<20>& oldValue, const JsonObject& control) override;
@@ -350,10 +412,14 @@ static struct SharedData {
   #include "MoonLight/Nodes/Drivers/D_ArtnetIn.h"
   #include "MoonLight/Nodes/Drivers/D_ArtnetOut.h"
   #include "MoonLight/Nodes/Drivers/D_AudioSync.h"
+  #include "MoonLight/Nodes/Drivers/D_DMXOut.h"
   #include "MoonLight/Nodes/Drivers/D_FastLED.h"
+  #include "MoonLight/Nodes/Drivers/D_FrameRecorder.h"
   #include "MoonLight/Nodes/Drivers/D_Hub75.h"
   #include "MoonLight/Nodes/Drivers/D_Infrared.h"
   #include "MoonLight/Nodes/Drivers/D_ParallelLEDDriver.h"
+  #include "MoonLight/Nodes/Drivers/D_SACNIn.h"
+  #include "MoonLight/Nodes/Drivers/D_SACNOut.h"
   #include "MoonLight/Nodes/Drivers/D__Sandbox.h"
   #include "MoonLight/Nodes/Effects/E_FastLED.h"
   #include "MoonLight/Nodes/Effects/E_MoonLight.h"
@@ -20,12 +20,14 @@
 class SharedEventEndpoint {
  private:
   EventSocket* _socket;
+  std::vector<std::pair<uint32_t, Module*>> _modules;  // hash of the module name, for binary control messages
 
  public:
   SharedEventEndpoint(EventSocket* socket) : _socket(socket) {}
 
   void registerModule(Module* module) {
     const char* eventName = module->_moduleName.c_str();
+    _modules.push_back({ControlMessage::hash(eventName), module});
 
     // Register the event with the socket
     _socket->registerEvent(eventName);
@@ -42,6 +44,22 @@ class SharedEventEndpoint {
 
   void begin() {
     // All events are registered during registerModule
+
+    // Binary control updates (client -> server), no JsonDocument: the module queues the new value and applies it in its loop
+    _socket->onBinary(ControlMessage::marker, [this](const uint8_t* data, size_t len, int originId) {
+      ControlMessage::Message message;
+      if (!ControlMessage::decode(data, len, message)) {
+        EXT_LOGW(MB_TAG, "invalid control message from %d (%d bytes)", originId, len);
+        return;
+      }
+      for (auto& entry : _modules) {
+        if (entry.first == message.moduleHash) {
+          if (!entry.second->postControl(message)) EXT_LOGW(MB_TAG, "%s: control message not accepted", entry.second->_moduleName.c_str());
+          return;
+        }
+      }
+      EXT_LOGW(MB_TAG, "control message for unknown module %08x", message.moduleHash);
+    });
   }
 
  private:
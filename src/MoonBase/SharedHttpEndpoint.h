@@ -54,10 +54,10 @@ class SharedHttpEndpoint {
     Module* module = findModule(request->path());
     if (!module) return request->reply(404);
 
-    PsychicJsonResponse response = PsychicJsonResponse(request, false);
-    JsonObject jsonObject = response.getRoot();
+    JsonDocument doc;
+    JsonObject jsonObject = doc.to<JsonObject>();
     module->read(jsonObject, ModuleState::read);
-    return response.send();
+    return Module::send(request, doc);  // MsgPack if accepted
   }
 
   // CHANGED: POST handler returns updated state
@@ -80,10 +80,10 @@ class SharedHttpEndpoint {
     }
 
     // ADDED: Return updated state in response
-    PsychicJsonResponse response = PsychicJsonResponse(request, false);
-    JsonObject responseObj = response.getRoot();
+    JsonDocument doc;
+    JsonObject responseObj = doc.to<JsonObject>();
     module->read(responseObj, ModuleState::read);
-    return response.send();
+    return Module::send(request, doc);
   }
 
   Module* findModule(const String& path) {
@@ -58,13 +58,13 @@ class SharedWebSocketServer {
         transmitData(request->url(), request->client(), WEB_SOCKET_ORIGIN);
       }
 
-      // Handle incoming frame data
-      if (frame->type == HTTPD_WS_TYPE_TEXT) {
+      // Handle incoming frame data: JSON text or MsgPack binary
+      if (frame->type == HTTPD_WS_TYPE_TEXT || frame->type == HTTPD_WS_TYPE_BINARY) {
         EXT_LOGD(ML_TAG, "search module %s", request->url());
         Module* module = findModule(request->url());
         if (module) {
           JsonDocument doc;
-          DeserializationError error = deserializeJson(doc, (char*)frame->payload, frame->len);
+          DeserializationError error = frame->type == HTTPD_WS_TYPE_TEXT ? deserializeJson(doc, (char*)frame->payload, frame->len) : deserializeMsgPack(doc, (char*)frame->payload, frame->len);
           if (!error && doc.is<JsonObject>()) {
             JsonObject obj = doc.as<JsonObject>();
             module->update(obj, ModuleState::update, WEB_SOCKET_ORIGIN);
@@ -93,9 +93,7 @@ class SharedWebSocketServer {
     root["type"] = "id";
     root["id"] = clientId(client);
 
-    String buffer;
-    serializeJson(doc, buffer);
-    client->sendMessage(buffer.c_str());
+    transmit(doc, client);
   }
 
   void transmitData(const String& path, PsychicWebSocketClient* client, const String& originId) {
@@ -105,14 +103,30 @@ class SharedWebSocketServer {
     JsonDocument doc;
     JsonObject root = doc.to<JsonObject>();
     module->read(root, ModuleState::read);
+
+    transmit(doc, client);
+  }
+
+  // MsgPack (binary) as the EventSocket, JSON (text) if EVENT_USE_JSON. client nullptr: all clients
+  void transmit(const JsonDocument& doc, PsychicWebSocketClient* client) {
+#if FT_ENABLED(EVENT_USE_JSON)
     String buffer;
     serializeJson(doc, buffer);
-
-    if (client) {
+    if (client)
       client->sendMessage(buffer.c_str());
-    } else {
+    else
       _handler.sendAll(buffer.c_str());
-    }
+#else
+    size_t size = measureMsgPack(doc);
+    uint8_t* buffer = allocMB<uint8_t>(size, "msgpack");
+    if (!buffer) return;
+    serializeMsgPack(doc, buffer, size);
+    if (client)
+      client->sendMessage(HTTPD_WS_TYPE_BINARY, buffer, size);
+    else
+      _handler.sendAll(HTTPD_WS_TYPE_BINARY, buffer, size);
+    freeMB(buffer, "msgpack");
+#endif
   }
 
   Module* findModule(const String& path) {
@@ -0,0 +1,177 @@
+/**
+    @title     MoonBase
+    @file      UpdateBus.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/develop/modules/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#pragma once
+
+// Subscriptions to changes of files and module controls. Host tests: test/test_update_bus.
+//
+// A topic is a file path ("/.config/presets/preset01.json") or a module control ("inputoutput/pins": module name / top level control).
+// A subscription is to one topic, or to all topics starting with it if it ends with '/' ("/.config/presets/", "inputoutput/", "/").
+// The subscribers are stored per topic at subscribe, so publish does not compare topics with all subscribers:
+// a published topic is looked up once for itself and once for each prefix ending with '/'.
+// Publish can be called from any task and only queues the topic (the same topic queued twice by the same origin is delivered once,
+// by different origins it is delivered once per origin, as subscribers act on the origin, e.g. ignore their own writes),
+// deliver() calls the subscribers in the task which calls it (the sveltekit task, see main.cpp), so not in the httpd task.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class UpdateBus {
+ public:
+  typedef std::function<void(const char* topic, const char* originId)> Callback;
+  typedef uint16_t Id;
+  static const Id none = UINT16_MAX;
+
+  struct Stats {
+    uint32_t calls = 0;
+    uint32_t latencyAvg = 0;  // µs from (first) publish to the call
+    uint32_t latencyMax = 0;
+    uint32_t durationAvg = 0;  // µs in the callback
+    uint32_t durationMax = 0;
+  };
+
+  struct Subscriber {
+    std::string name;  // for the stats
+    std::string topic;
+    Callback callback;
+    Stats stats;
+    bool used = false;
+  };
+
+  uint32_t (*clock)() = nullptr;  // µs, for the stats
+
+  Id subscribe(const char* topic, Callback callback, const char* name = nullptr) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Id id = 0;
+    while (id < subscribers.size() && subscribers[id].used) id++;  // reuse unsubscribed
+    if (id == subscribers.size()) subscribers.emplace_back();
+    Subscriber& subscriber = subscribers[id];
+    subscriber.name = name ? name : topic;
+    subscriber.topic = topic;
+    subscriber.callback = callback;
+    subscriber.stats = Stats();
+    subscriber.used = true;
+    table[topic].push_back(id);
+    return id;
+  }
+
+  // e.g. in the destructor of a node which subscribed
+  void unsubscribe(Id id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (id >= subscribers.size() || !subscribers[id].used) return;
+    Subscriber& subscriber = subscribers[id];
+    auto it = table.find(subscriber.topic);
+    if (it != table.end()) {
+      it->second.erase(std::remove(it->second.begin(), it->second.end(), id), it->second.end());
+      if (it->second.empty()) table.erase(it);
+    }
+    subscriber = Subscriber();
+  }
+
+  // any task. Topics without subscribers are dropped
+  void publish(const char* topic, const char* originId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!hasMatch(topic)) return;
+    for (const Pending& pending : queue)
+      if (pending.topic == topic && pending.originId == originId) return;  // coalesce, keep the time of the first publish
+    queue.push_back({topic, originId, now()});
+  }
+
+  // call the subscribers of the queued topics, returns the number of calls
+  size_t deliver() {
+    std::vector<Pending> topics;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (queue.empty()) return 0;
+      topics.swap(queue);
+    }
+    size_t calls = 0;
+    std::vector<std::pair<Id, Callback>> matches;
+    for (const Pending& pending : topics) {
+      matches.clear();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        match(pending.topic, matches);
+      }
+      for (auto& match : matches) {
+        uint32_t start = now();
+        match.second(pending.topic.c_str(), pending.originId.c_str());
+        uint32_t end = now();
+        calls++;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (match.first < subscribers.size() && subscribers[match.first].used) addStats(subscribers[match.first].stats, start - pending.published, end - start);
+      }
+    }
+    return calls;
+  }
+
+  size_t pending() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+  }
+
+  // f(const Subscriber&) for each subscriber, e.g. to show the stats
+  template <typename F>
+  void forEach(F f) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const Subscriber& subscriber : subscribers)
+      if (subscriber.used) f(subscriber);
+  }
+
+ private:
+  struct Pending {
+    std::string topic;
+    std::string originId;
+    uint32_t published;
+  };
+
+  std::vector<Subscriber> subscribers;           // index is the Id
+  std::map<std::string, std::vector<Id>> table;  // topic -> subscribers
+  std::vector<Pending> queue;
+  std::mutex mutex;
+
+  uint32_t now() const { return clock ? clock() : 0; }
+
+  bool hasMatch(const std::string& topic) const {
+    if (table.empty()) return false;
+    for (size_t slash = topic.find('/'); slash != std::string::npos; slash = topic.find('/', slash + 1))
+      if (slash + 1 < topic.size() && table.count(topic.substr(0, slash + 1))) return true;
+    return table.count(topic);
+  }
+
+  // the subscribers of topic itself and of each prefix ending with '/'
+  void match(const std::string& topic, std::vector<std::pair<Id, Callback>>& matches) const {
+    auto add = [&](const std::string& key) {
+      auto it = table.find(key);
+      if (it == table.end()) return;
+      for (Id id : it->second) matches.push_back({id, subscribers[id].callback});
+    };
+    for (size_t slash = topic.find('/'); slash != std::string::npos; slash = topic.find('/', slash + 1))
+      if (slash + 1 < topic.size()) add(topic.substr(0, slash + 1));
+    add(topic);
+  }
+
+  static void addStats(Stats& stats, uint32_t latency, uint32_t duration) {
+    stats.latencyAvg = stats.calls ? (stats.latencyAvg * 7 + latency) / 8 : latency;
+    stats.durationAvg = stats.calls ? (stats.durationAvg * 7 + duration) / 8 : duration;
+    stats.latencyMax = std::max(stats.latencyMax, latency);
+    stats.durationMax = std::max(stats.durationMax, duration);
+    stats.calls++;
+  }
+};
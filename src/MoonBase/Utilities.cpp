@@ -61,6 +61,14 @@ void walkThroughFiles(File folder, std::function<void(File, File)> fun) {
   }
 }
 
+uint32_t fileVersion(const char* path) {
+  File file = ESPFS.open(path);
+  if (!file) return 0;
+  uint32_t version = file.size() ^ (uint32_t)file.getLastWrite() ^ 0x80000000;  // not 0 for an empty file
+  file.close();
+  return version;
+}
+
 bool copyFile(const char* srcPath, const char* dstPath) {
   File src = ESPFS.open(srcPath, "r");
   if (!src) {
@@ -176,6 +176,9 @@ void walkThroughFiles(File folder, std::function<void(File, File)> fun);
 
 bool copyFile(const char* srcPath, const char* dstPath);
 
+// changes when the file changes (size and last write time), 0 if the file does not exist
+uint32_t fileVersion(const char* path);
+
 // for game of live
 uint16_t crc16(const unsigned char* data_p, size_t length);
 uint16_t gcd(uint16_t a, uint16_t b);
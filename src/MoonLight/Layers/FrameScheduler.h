@@ -0,0 +1,140 @@
+/**
+    @title     MoonLight
+    @file      FrameScheduler.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/moonlight/overview/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#pragma once
+
+// Frame pacing of the effect task. The clock is passed in, so the pacing is tested on the host (test/test_frame_scheduler).
+//
+// Free: a frame is rendered as soon as the drivers took the previous one (as fast as possible), the animation time is the measured time.
+// Fixed: frames start on a grid of 1 / targetFPS, the animation time advances in whole frame intervals (fixed timestep),
+//   so an effect moves the same distance every frame. Missed slots are counted as skipped frames and added to frameDelta.
+// Deadline: as fixed, and a frame which overran its interval (or started late) makes the next frame skip optional work (skipOptional),
+//   e.g. the monitor and blur passes flagged as optional, to get back on the grid.
+//
+// Times are in microseconds (uint32_t, wrapping), the animation time in milliseconds.
+
+#include <stdint.h>
+
+enum PacingEnum {
+  pacing_free,
+  pacing_fixed,
+  pacing_deadline,
+};
+
+class FrameScheduler {
+ public:
+  static const uint8_t maxCatchUp = 10;  // more missed slots (e.g. mapping a layout) restart the grid instead of jumping ahead
+
+  uint8_t pacing = pacing_free;
+  uint16_t targetFPS = 0;  // 0: free
+
+  // per frame, for the nodes
+  uint32_t frameMillis = 0;    // animation time in ms, use instead of millis() for smooth movement
+  uint16_t frameDelta = 0;     // ms since the previous frame (fixed / deadline: a multiple of the frame interval)
+  bool skipOptional = false;   // deadline: behind schedule, leave out work which is not needed for a correct frame
+
+  // statistics of the last whole second
+  struct Stats {
+    uint16_t frames = 0;
+    uint16_t skipped = 0;    // frame slots missed
+    uint16_t overruns = 0;   // frames which ended after their deadline
+    uint32_t jitterAvg = 0;  // µs between the scheduled and the actual start of a frame
+    uint32_t jitterMax = 0;
+    uint32_t renderAvg = 0;  // µs per frame
+    uint32_t renderMax = 0;
+  };
+  Stats stats;
+
+  // µs between frames, 0 if not paced
+  uint32_t interval() const { return pacing != pacing_free && targetFPS ? 1000000 / targetFPS : 0; }
+
+  bool isDue(uint32_t nowUs) const {
+    uint32_t iv = interval();
+    return !started || !iv || iv != gridInterval || (int32_t)(nowUs - nextUs) >= 0;
+  }
+
+  void beginFrame(uint32_t nowUs) {
+    uint32_t iv = interval();
+    if (!started) {
+      started = true;
+      nextUs = nowUs;
+      prevUs = nowUs;
+      secondUs = nowUs;
+    }
+
+    if (nowUs - secondUs >= 1000000) {
+      secondUs = nowUs;
+      stats = current;
+      if (current.frames) {
+        stats.jitterAvg = current.jitterAvg / current.frames;
+        stats.renderAvg = current.renderAvg / current.frames;
+      }
+      current = Stats();
+    }
+
+    if (iv != gridInterval) {  // pacing or targetFPS changed: new grid from now
+      gridInterval = iv;
+      nextUs = nowUs;
+    }
+
+    uint32_t deltaUs;
+    if (iv) {
+      uint32_t late = (int32_t)(nowUs - nextUs) > 0 ? nowUs - nextUs : 0;
+      uint32_t slots = 1 + late / iv;
+      if (slots > maxCatchUp) {  // stalled: don't make up for it
+        nextUs = nowUs;
+        late = 0;
+        slots = 1;
+      }
+      late -= (slots - 1) * iv;  // start relative to the slot this frame is in
+      current.skipped += slots - 1;
+      current.jitterAvg += late;
+      if (late > current.jitterMax) current.jitterMax = late;
+
+      scheduledUs = nextUs + (slots - 1) * iv;
+      nextUs += slots * iv;
+      deltaUs = slots * iv;
+      skipOptional = pacing == pacing_deadline && (overran || late > iv / 2);
+    } else {
+      deltaUs = nowUs - prevUs;
+      skipOptional = false;
+    }
+    prevUs = nowUs;
+    startUs = nowUs;
+
+    timeUs += deltaUs;
+    frameMillis = timeUs / 1000;
+    frameDelta = deltaUs / 1000;
+  }
+
+  void endFrame(uint32_t nowUs) {
+    uint32_t renderUs = nowUs - startUs;
+    current.frames++;
+    current.renderAvg += renderUs;
+    if (renderUs > current.renderMax) current.renderMax = renderUs;
+
+    uint32_t iv = interval();
+    overran = iv && nowUs - scheduledUs > iv;
+    if (overran) current.overruns++;
+  }
+
+ private:
+  bool started = false;
+  bool overran = false;
+  uint32_t gridInterval = 0;
+  uint32_t nextUs = 0;       // start of the next frame slot
+  uint32_t scheduledUs = 0;  // start of the slot of the current frame
+  uint32_t startUs = 0;
+  uint32_t prevUs = 0;
+  uint32_t secondUs = 0;
+  uint64_t timeUs = 0;  // animation time
+  Stats current;        // accumulating, jitterAvg and renderAvg are sums
+};
@@ -0,0 +1,160 @@
+/**
+    @title     MoonLight
+    @file      NodeArena.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/develop/architecture/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#pragma once
+
+// Arena of a virtual layer for the buffers of its nodes which depend on the layer size (e.g. the cells of Game of Life).
+// The region and the heap functions are passed in by the layer (allocMB / freeMB), so the carving and reuse of blocks is tested in test/test_node_arena.
+//
+// The region is allocated once (before the heap is fragmented by preset changes) and blocks are carved from it by bumping an offset.
+// A block belongs to an owner: the pointer variable of the node, so the arena can null it. Freeing the last block gives its bytes back,
+// other freed blocks stay a hole until the next sweep.
+// Sweep: when the layer size changes, all blocks are released and their owners set to nullptr, then the nodes carve their buffers again
+// in onSizeChanged, from an empty region. So nodes must (re)allocate their arena buffers in onSizeChanged and check them for nullptr.
+// If the region is full a block is allocated on the heap (fallback) and the region is grown to the demand at the next sweep.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mutex>
+
+class NodeArena {
+ public:
+  static const uint8_t maxBlocks = 32;  // more blocks are allocated on the heap and not released by a sweep
+  static const uint8_t alignment = 8;
+
+  void* (*heapAlloc)(size_t size) = nullptr;  // zeroed memory, for fallback blocks
+  void (*heapFree)(void* p) = nullptr;
+
+  struct Stats {
+    uint32_t capacity = 0;   // bytes of the region
+    uint32_t used = 0;       // bytes carved from the region, including holes
+    uint32_t holes = 0;      // bytes of freed blocks not given back yet: fragmentation of the region
+    uint32_t peak = 0;       // max used since the last sweep
+    uint32_t demand = 0;     // bytes of the live blocks, region and heap
+    uint16_t fallbacks = 0;  // live blocks on the heap
+    uint16_t sweeps = 0;
+  };
+  Stats stats;
+
+  // the region is owned by the caller and can only be replaced if the arena is empty (after sweep)
+  void setRegion(uint8_t* region, size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->region = region;
+    stats.capacity = region ? capacity : 0;
+    stats.used = 0;
+    stats.holes = 0;
+  }
+  uint8_t* getRegion() const { return region; }
+
+  bool contains(const void* p) const { return region && p >= region && p < region + stats.capacity; }
+
+  // (re)allocate *owner: releases what it pointed to and carves size bytes, zeroed (content is not kept). Sets and returns *owner
+  void* alloc(void** owner, size_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    releaseLocked(owner);
+    if (!size) return nullptr;
+
+    size_t aligned = (size + alignment - 1) & ~(size_t)(alignment - 1);
+    void* p = nullptr;
+    bool inHeap = false;
+    if (nrOfBlocks == maxBlocks) {  // not tracked: on the heap
+      p = heapAlloc ? heapAlloc(size) : nullptr;
+      *owner = p;
+      return p;
+    }
+    if (region && stats.used + aligned <= stats.capacity) {
+      p = region + stats.used;
+      memset(p, 0, size);
+      stats.used += aligned;
+      if (stats.used > stats.peak) stats.peak = stats.used;
+    } else if (heapAlloc) {
+      p = heapAlloc(size);
+      inHeap = true;
+    }
+    if (!p) return nullptr;
+
+    blocks[nrOfBlocks++] = {owner, inHeap ? 0 : (uint32_t)((uint8_t*)p - region), (uint32_t)aligned, inHeap};
+    stats.demand += aligned;
+    if (inHeap) stats.fallbacks++;
+    *owner = p;
+    return p;
+  }
+
+  // free *owner and set it to nullptr
+  void release(void** owner) {
+    std::lock_guard<std::mutex> lock(mutex);
+    releaseLocked(owner);
+  }
+
+  // release all blocks and null their owners. Returns the demand of the released blocks, to size the region before the nodes carve again
+  uint32_t sweep() {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint32_t demand = stats.demand;
+    for (uint8_t i = 0; i < nrOfBlocks; i++) {
+      if (blocks[i].inHeap && heapFree) heapFree(*blocks[i].owner);
+      *blocks[i].owner = nullptr;
+    }
+    nrOfBlocks = 0;
+    stats.used = 0;
+    stats.holes = 0;
+    stats.peak = 0;
+    stats.demand = 0;
+    stats.fallbacks = 0;
+    stats.sweeps++;
+    return demand;
+  }
+
+ private:
+  struct Block {
+    void** owner;
+    uint32_t offset;
+    uint32_t size;
+    bool inHeap;
+  };
+  Block blocks[maxBlocks];
+  uint8_t nrOfBlocks = 0;
+  uint8_t* region = nullptr;
+  std::mutex mutex;  // nodes are added and removed in the module task, the sweep is done in the effect task
+
+  void releaseLocked(void** owner) {
+    void* p = *owner;
+    if (!p) return;
+    *owner = nullptr;
+    for (uint8_t i = 0; i < nrOfBlocks; i++) {
+      if (blocks[i].owner != owner) continue;
+      Block block = blocks[i];
+      blocks[i] = blocks[--nrOfBlocks];
+      stats.demand -= block.size;
+      if (block.inHeap) {
+        if (heapFree) heapFree(p);
+        stats.fallbacks--;
+      } else
+        trim();
+      return;
+    }
+    if (!contains(p) && heapFree) heapFree(p);  // untracked heap block
+  }
+
+  // give back the space above the highest live block, the freed blocks below it are holes
+  void trim() {
+    uint32_t top = 0;
+    uint32_t live = 0;
+    for (uint8_t i = 0; i < nrOfBlocks; i++) {
+      if (blocks[i].inHeap) continue;
+      if (blocks[i].offset + blocks[i].size > top) top = blocks[i].offset + blocks[i].size;
+      live += blocks[i].size;
+    }
+    stats.used = top;
+    stats.holes = top - live;
+  }
+};
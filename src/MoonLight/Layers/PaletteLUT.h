@@ -0,0 +1,61 @@
+/**
+    @title     MoonLight
+    @file      PaletteLUT.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/moonlight/lightscontrol/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#pragma once
+
+#if FT_MOONLIGHT
+
+  #include "FastLED.h"
+
+// The palette of the lights (layerP.palette) expanded to 256 colors, so an effect gets a color with one indexed load instead of blending 2 of 16 entries per light.
+// The palette is expanded when it changes (Lights Control palette), from a 16 entry palette (FastLED built in palettes) or from gradient stops (palette files).
+// ColorFromPalette(layerP.palette, index, brightness, blendType) below keeps the FastLED signature so effects do not need to change.
+class PaletteLUT {
+ public:
+  CRGB entries[256];
+
+  PaletteLUT(const CRGBPalette16& palette) { *this = palette; }
+
+  // each entry as FastLED would blend it from the 16 entries
+  PaletteLUT& operator=(const CRGBPalette16& palette) {
+    for (uint16_t i = 0; i < 256; i++) entries[i] = ::ColorFromPalette(palette, i, 255, LINEARBLEND);
+    return *this;
+  }
+
+  // count stops (positions ascending, 0..255), blended linearly between the stops, before the first and after the last stop the color of that stop
+  void setGradient(const uint8_t* positions, const CRGB* colors, uint8_t count) {
+    if (!count) return;
+    uint8_t stop = 0;
+    for (uint16_t i = 0; i < 256; i++) {
+      while (stop < count && positions[stop] < i) stop++;
+      if (stop == 0)
+        entries[i] = colors[0];
+      else if (stop == count)
+        entries[i] = colors[count - 1];
+      else {
+        uint8_t from = positions[stop - 1];
+        uint8_t to = positions[stop];
+        entries[i] = blend(colors[stop - 1], colors[stop], (i - from) * 255 / (to - from));  // to > from as positions[stop - 1] < i <= to
+      }
+    }
+  }
+
+  const CRGB& operator[](uint8_t index) const { return entries[index]; }
+};
+
+// NOBLEND: the 16 entry steps (as FastLED: the entry of the high 4 bits, for palette files the color at that position)
+inline CRGB ColorFromPalette(const PaletteLUT& palette, uint8_t index, uint8_t brightness = 255, TBlendType blendType = LINEARBLEND) {
+  CRGB color = palette[blendType == NOBLEND ? index & 0xF0 : index];
+  if (brightness != 255) color.nscale8(brightness);
+  return color;
+}
+
+#endif
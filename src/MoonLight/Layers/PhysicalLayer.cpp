@@ -14,6 +14,7 @@
   #include "PhysicalLayer.h"
 
   #include <ESP32SvelteKit.h>  //for safeModeMB
+  #include <ESPFS.h>
 
   #include "MoonBase/Nodes.h"
   #include "MoonBase/Utilities.h"
@@ -67,16 +68,59 @@ void PhysicalLayer::setup() {
     lights.maxChannels = 0;
   }
 
+  dirty.allocate(lights.maxChannels);
+  dirtyD.allocate(lights.maxChannels);
+
   for (VirtualLayer* layer : layers) {
     layer->setup();
   }
 }
 
+void DirtyTiles::allocate(size_t nrOfChannels) {
+  nrOfTiles = (nrOfChannels + (1 << tileShift) - 1) >> tileShift;
+  bits = allocMB<uint32_t>(words(), "dirty");
+  if (!bits) EXT_LOGW(ML_TAG, "no dirty tiles, all channels are processed each frame");
+  markAll();
+}
+
+// channelsE holds the frame before the one in channelsD (double buffer), so only the channels changed in channelsD need to be copied
+void PhysicalLayer::seedChannels() {
+  if (requestFullFrame) {
+    memcpy(lights.channelsE, lights.channelsD, lights.header.nrOfChannels);
+    return;
+  }
+  if (!seedNeeded) {  // all lights are overwritten without being read: no copy, but channelsE differs from channelsD where channelsD changed
+    dirty.merge(dirtyD);
+    return;
+  }
+  dirtyD.forEachSpan(lights.header.nrOfChannels, [this](uint32_t channel, uint32_t length) { memcpy(&lights.channelsE[channel], &lights.channelsD[channel], length); });
+}
+
+// called with swapMutex taken, after the effects finished a frame
+void PhysicalLayer::swapDirty() {
+  if (requestFullFrame) {
+    requestFullFrame = false;
+    dirty.markAll();
+  }
+  uint32_t tiles = (lights.header.nrOfChannels + (1 << DirtyTiles::tileShift) - 1) >> DirtyTiles::tileShift;
+  uint32_t changed = MIN(dirty.count(), tiles);
+  changedPercent = tiles ? changed * 100 / tiles : 0;
+  if (changed) changedFrames++;
+
+  std::swap(dirty, dirtyD);
+  dirty.clear();
+}
+
 void PhysicalLayer::loop() {
   // runs the loop of all effects / nodes in the layer
+  bool readsPrevious = false;
   for (VirtualLayer* layer : layers) {
-    if (layer) layer->loop();  // if (layer) needed when deleting rows ...
+    if (layer) {  // if (layer) needed when deleting rows ...
+      layer->loop();
+      readsPrevious |= layer->readsPrevious;
+    }
   }
+  seedNeeded = readsPrevious;
 }
 
 void PhysicalLayer::loop20ms() {
@@ -105,8 +149,12 @@ void PhysicalLayer::loopDrivers() {
     mapLayout();
 
     requestMapVirtual = false;
+    requestFullFrame = true;  // other lights can be mapped: drivers send all channels
   }
 
+  estimatePower();  // once per frame for all drivers
+  prepareDither();  // after estimatePower as it uses powerBrightness
+
   if (prevSize != lights.header.size) EXT_LOGD(ML_TAG, "onSizeChanged P %d,%d,%d -> %d,%d,%d", prevSize.x, prevSize.y, prevSize.z, lights.header.size.x, lights.header.size.y, lights.header.size.z);
 
   for (Node* node : nodes) {
@@ -118,13 +166,44 @@ void PhysicalLayer::loopDrivers() {
 }
 
 void PhysicalLayer::mapLayout() {
+  // layout nodes add the same lights as long as the nodes, their controls and files are the same (layoutKey):
+  // pass 1 records their lights and pins, next mappings (also pass 2 and after a reboot) replay the records instead of running onLayout.
+  // Only layout nodes (capabilities.layout) are recorded and replayed, other nodes (drivers, live scripts) run onLayout as usual
+  currentKey = layoutKey && !safeModeMB ? layoutKey() : 0;
+  if (currentKey && pass == 1 && layoutRecords.key != currentKey) layoutRecords.load(currentKey);  // e.g. at boot
+  replaying = currentKey && layoutRecords.key == currentKey;
+  recording = currentKey && !replaying && pass == 1;
+
   onLayoutPre();
-  for (Node* node : nodes) {
-    if (node->on) {  // && node->hasOnLayout
-      node->onLayout();
+  uint32_t index = 0;  // next record to replay
+  for (uint8_t i = 0; i < nodes.size(); i++) {
+    if (!nodes[i]->on) continue;  // && node->hasOnLayout
+    bool isLayout = nodes[i]->capabilities.layout;
+    if (replaying && isLayout && index < layoutRecords.nrOfRecords && layoutRecords.isMarker(index, LayoutFile::marker_node) && LayoutFile::recordValue(layoutRecords.record(index), 2) == i)
+      index = replayNode(index);
+    else {
+      layoutNode = isLayout ? i : UINT8_MAX;
+      nodes[i]->onLayout();
     }
   }
+  layoutNode = UINT8_MAX;
   onLayoutPost();
+
+  if (recording) layoutRecords.complete(currentKey);
+  recording = false;
+  replaying = false;
+}
+
+// adds the lights and pins of one node, index is its marker_node record. Returns the marker_node record of the next node
+uint32_t PhysicalLayer::replayNode(uint32_t index) {
+  for (index++; index < layoutRecords.nrOfRecords && !layoutRecords.isMarker(index, LayoutFile::marker_node); index++) {
+    const uint8_t* record = layoutRecords.record(index);
+    if (LayoutFile::recordValue(record, 0) != LayoutFile::marker)
+      addLight(Coord3D(LayoutFile::recordValue(record, 0), LayoutFile::recordValue(record, 1), LayoutFile::recordValue(record, 2)));
+    else if (LayoutFile::recordValue(record, 1) == LayoutFile::marker_pin)
+      nextPin(LayoutFile::recordValue(record, 2));
+  }
+  return index;
 }
 
 void PhysicalLayer::onLayoutPre() {
@@ -136,12 +215,18 @@ void PhysicalLayer::onLayoutPre() {
     if (layerP.lights.useDoubleBuffer) xSemaphoreTake(swapMutex, portMAX_DELAY);
     EXT_LOGD(ML_TAG, "positions in progress (%d -> 1)", lights.header.isPositions);
     lights.header.isPositions = 1;  // in progress...
+    lights.header.positionBytes = 3;  // widened by addLight if needed
     if (layerP.lights.useDoubleBuffer) xSemaphoreGive(swapMutex);
 
     delay(100);  // wait to stop effects
 
-    // set all channels to 0 (e.g for multichannel to not activate unused channels, e.g. fancy modes on MHs)
-    memset(lights.channelsE, 0, lights.maxChannels);  // set all the channels to 0, positions in channelsE
+    // layoutRecords are not used by the monitor until isPositions is 2 again. While recording the positions are also stored in channelsE,
+    // in case the records are not complete (see onLayoutPost)
+    if (recording) layoutRecords.clear();
+    positionsInRecords = replaying;
+
+    // set all channels to 0 (e.g for multichannel to not activate unused channels, e.g. fancy modes on MHs), not needed if the same layout is replayed
+    if (!positionsInRecords || currentKey != mappedKey) memset(lights.channelsE, 0, lights.maxChannels);  // set all the channels to 0, positions in channelsE
     // dealloc pins
     if (!monitorPass) {
       memset(ledsPerPin, 0xFF, sizeof(ledsPerPin));  // UINT16_MAX is 2 * 0xFF
@@ -157,11 +242,33 @@ void PhysicalLayer::onLayoutPre() {
   }
 }
 
-void packCoord3DInto3Bytes(uint8_t* buf, Coord3D position) {  // max size supported is 255x255x255
+void packCoord3DInto3Bytes(uint8_t* buf, const Coord3D& position) {  // max size supported is 255x255x255
   buf[0] = MIN(position.x, 255);
   buf[1] = MIN(position.y, 255);
   buf[2] = MIN(position.z, 255);
 }
+void packCoord3DInto6Bytes(uint8_t* buf, const Coord3D& position) {  // little endian, max size supported is 65535x65535x65535
+  buf[0] = position.x;
+  buf[1] = position.x >> 8;
+  buf[2] = position.y;
+  buf[3] = position.y >> 8;
+  buf[4] = position.z;
+  buf[5] = position.z >> 8;
+}
+
+// positions are stored with 8 bits per axis (most layouts), switch to 16 bits per axis at the first position > 255
+void PhysicalLayer::widenPositions() {
+  uint16_t nrOfPositions = MIN(lights.header.nrOfLights, lights.maxChannels / 3);
+  if ((nrOfPositions + 1) * 6 > lights.maxChannels) return;  // no room: stay at 8 bits, logged in onLayoutPost
+
+  // in place, from the last to the first position as the 6 byte positions take the space of the 3 byte positions
+  for (int i = nrOfPositions - 1; i >= 0; i--) {
+    Coord3D position = {lights.channelsE[i * 3], lights.channelsE[i * 3 + 1], lights.channelsE[i * 3 + 2]};
+    packCoord3DInto6Bytes(&lights.channelsE[i * 6], position);
+  }
+  lights.header.positionBytes = 6;
+}
+
 void PhysicalLayer::addLight(Coord3D position) {
   if (safeModeMB && lights.header.nrOfLights > 1023) {
     // EXT_LOGW(ML_TAG, "Safe mode enabled, not adding lights > 1023");
@@ -170,8 +277,22 @@ void PhysicalLayer::addLight(Coord3D position) {
 
   if (pass == 1) {
     // EXT_LOGD(ML_TAG, "%d,%d,%d", position.x, position.y, position.z);
-    if (lights.header.nrOfLights < lights.maxChannels / 3) {
-      packCoord3DInto3Bytes(&lights.channelsE[lights.header.nrOfLights * 3], position);  // positions in channelsE
+    if (recording) {
+      if (layoutNode != UINT8_MAX)
+        layoutRecords.addLight(layoutNode, position);
+      else
+        layoutRecords.fits = false;  // not replayed, so the records would miss positions for the monitor
+    }
+
+    if (!positionsInRecords) {  // positions in channelsE, else the monitor positions are made from layoutRecords
+      if (lights.header.positionBytes == 3 && (position.x > 255 || position.y > 255 || position.z > 255)) widenPositions();
+
+      if ((lights.header.nrOfLights + 1) * lights.header.positionBytes <= lights.maxChannels) {
+        if (lights.header.positionBytes == 6)
+          packCoord3DInto6Bytes(&lights.channelsE[lights.header.nrOfLights * 6], position);
+        else
+          packCoord3DInto3Bytes(&lights.channelsE[lights.header.nrOfLights * 3], position);
+      }
     }
 
     lights.header.size = lights.header.size.maximum(position);
@@ -186,6 +307,7 @@ void PhysicalLayer::addLight(Coord3D position) {
 }
 
 void PhysicalLayer::nextPin(uint8_t ledPinDIO) {
+  if (pass == 1 && recording && layoutNode != UINT8_MAX) layoutRecords.addPin(layoutNode, ledPinDIO);  // other nodes set their pins again on replay
   if (pass == 1 && !monitorPass) {
     uint16_t prevNrOfLights = 0;
     uint8_t i = 0;
@@ -211,6 +333,16 @@ void PhysicalLayer::onLayoutPost() {
     lights.header.size += Coord3D{1, 1, 1};
     lights.header.nrOfChannels = lights.header.nrOfLights * lights.header.channelsPerLight * ((lights.header.lightPreset == lightPreset_RGB2040) ? 2 : 1);  // RGB2040 has empty channels
     EXT_LOGD(ML_TAG, "pass %d mp:%d #:%d / %d s:%d,%d,%d", pass, monitorPass, lights.header.nrOfLights, lights.header.nrOfChannels, lights.header.size.x, lights.header.size.y, lights.header.size.z);
+    bool largeLayout = lights.header.size.x > 256 || lights.header.size.y > 256 || lights.header.size.z > 256;
+    if (recording && layoutRecords.fits) {  // complete: positions from the records, channelsE back to 0 (cleared in onLayoutPre as the key is new)
+      positionsInRecords = true;
+      memset(lights.channelsE, 0, lights.maxChannels);
+    }  // else the positions stay in channelsE and the layout is not cached (mappedKey 0)
+    if (positionsInRecords)
+      lights.header.positionBytes = largeLayout ? 6 : 3;
+    else if (lights.header.positionBytes == 3 && largeLayout)
+      EXT_LOGW(ML_TAG, "no room for 16 bit positions, monitor positions clamped to 255");
+    if (!monitorPass) mappedKey = positionsInRecords ? currentKey : 0;
     // send the positions to the UI _socket_emit
     if (layerP.lights.useDoubleBuffer) xSemaphoreTake(swapMutex, portMAX_DELAY);
     EXT_LOGD(ML_TAG, "positions stored (%d -> %d)", lights.header.isPositions, lights.header.nrOfLights ? 2 : 3);
@@ -228,6 +360,205 @@ void PhysicalLayer::onLayoutPost() {
     }
   }
 }
+
+void LayoutRecords::clear() {
+  nrOfRecords = 0;
+  key = 0;
+  fits = true;
+  lastNode = UINT8_MAX;
+}
+
+void LayoutRecords::add(uint16_t x, uint16_t y, uint16_t z) {
+  if (nrOfRecords == capacity) {
+    uint32_t newCapacity = MAX(capacity * 2, 1024);  // 6KB, doubling to limit reallocations for large layouts
+    uint8_t* newRecords = reallocMB<uint8_t>(records, newCapacity * LayoutFile::recordSize, "layout");
+    if (!newRecords) {
+      fits = false;
+      return;
+    }
+    records = newRecords;
+    capacity = newCapacity;
+  }
+  LayoutFile::putRecord(&records[nrOfRecords * LayoutFile::recordSize], x, y, z);
+  nrOfRecords++;
+}
+
+void LayoutRecords::addLight(uint8_t node, const Coord3D& position) {
+  if (node != lastNode) add(LayoutFile::marker, LayoutFile::marker_node, node);
+  lastNode = node;
+  if (position.x < 0 || position.y < 0 || position.z < 0 || position.x > LayoutFile::maxCoordinate || position.y > LayoutFile::maxCoordinate || position.z > LayoutFile::maxCoordinate) fits = false;
+  add(constrain(position.x, 0, LayoutFile::maxCoordinate), constrain(position.y, 0, LayoutFile::maxCoordinate), constrain(position.z, 0, LayoutFile::maxCoordinate));
+}
+
+void LayoutRecords::addPin(uint8_t node, uint8_t ledPinDIO) {
+  if (node != lastNode) add(LayoutFile::marker, LayoutFile::marker_node, node);
+  lastNode = node;
+  add(LayoutFile::marker, LayoutFile::marker_pin, ledPinDIO);
+}
+
+  #define LAYOUT_RECORDS_FILE "/.config/layout.mlc"
+
+void LayoutRecords::complete(uint32_t key) {
+  if (!fits) {
+    EXT_LOGW(ML_TAG, "layout not cached: %s", records ? "positions out of range or lights added by a driver" : "out of memory");
+    return;
+  }
+  this->key = key;
+
+  LayoutFile::CacheHeader header;
+  header.scale = 0;
+  header.sourceHash = key;
+  header.nrOfRecords = nrOfRecords;
+  File file = ESPFS.open(LAYOUT_RECORDS_FILE, FILE_WRITE);
+  size_t size = nrOfRecords * LayoutFile::recordSize;
+  bool written = file && file.write((uint8_t*)&header, sizeof(header)) == sizeof(header) && file.write(records, size) == size;
+  if (file) file.close();
+  if (!written) ESPFS.remove(LAYOUT_RECORDS_FILE);  // memory copy still used
+  EXT_LOGD(ML_TAG, "layout %08x: %d records %s", key, nrOfRecords, written ? "saved" : "not saved");
+}
+
+bool LayoutRecords::load(uint32_t key) {
+  File file = ESPFS.open(LAYOUT_RECORDS_FILE);
+  if (!file) return false;
+  LayoutFile::CacheHeader header;
+  bool loaded = false;
+  if (file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) && header.isValid(key, 0) && file.size() == sizeof(header) + header.nrOfRecords * LayoutFile::recordSize) {
+    clear();
+    if (header.nrOfRecords > capacity) {
+      uint8_t* newRecords = reallocMB<uint8_t>(records, header.nrOfRecords * LayoutFile::recordSize, "layout");
+      if (newRecords) {
+        records = newRecords;
+        capacity = header.nrOfRecords;
+      }
+    }
+    size_t size = header.nrOfRecords * LayoutFile::recordSize;
+    if (header.nrOfRecords <= capacity && file.read(records, size) == size) {
+      nrOfRecords = header.nrOfRecords;
+      this->key = key;
+      loaded = true;
+    }
+  }
+  file.close();
+  EXT_LOGD(ML_TAG, "layout %08x: %s", key, loaded ? "loaded" : "not cached");
+  return loaded;
+}
+
+void LayoutRecords::packPositions(uint8_t* buffer, uint16_t nrOfLights, uint8_t positionBytes) const {
+  uint16_t light = 0;
+  for (uint32_t index = 0; index < nrOfRecords && light < nrOfLights; index++) {
+    const uint8_t* record = this->record(index);
+    if (LayoutFile::recordValue(record, 0) == LayoutFile::marker) continue;
+    Coord3D position = {LayoutFile::recordValue(record, 0), LayoutFile::recordValue(record, 1), LayoutFile::recordValue(record, 2)};
+    if (positionBytes == 6)
+      packCoord3DInto6Bytes(&buffer[light * 6], position);
+    else
+      packCoord3DInto3Bytes(&buffer[light * 3], position);
+    light++;
+  }
+}
+
+// LED current model (mA at 5V for a fully lit channel), same ratios as the FastLED power model
+  #define POWER_RED_MA 16
+  #define POWER_GREEN_MA 11
+  #define POWER_BLUE_MA 15
+  #define POWER_WHITE_MA 20
+  #define POWER_DARK_MA 1  // per LED, also when off
+  #define POWER_VOLTAGE 5
+  #define POWER_SLEW 8  // brightness goes up in 1/8 steps of the difference per frame, down at once
+
+void PhysicalLayer::estimatePower() {
+  LightsHeader& header = lights.header;
+
+  if (header.offsetBrightness != UINT8_MAX) {  // fixtures which do their own brightness are not LEDs on our power supply
+    powerBrightness = 255;
+    estimatedCurrent = 0;
+    return;
+  }
+
+  uint8_t brightness = header.brightness;
+  uint32_t budget = maxPower ? maxPower * 1000 / POWER_VOLTAGE : UINT32_MAX;  // mA
+  uint8_t target = brightness;
+  uint64_t totalFull = 0;  // mA * 255 at full brightness, without dark current
+  uint32_t totalDark = 0;
+
+  // the lights are ordered by pin, lights without pin (e.g. Art-Net) count as one pin
+  uint8_t nrOfPins = MAX(nrOfAssignedPins, 1);
+  uint8_t* channel = &lights.channelsD[header.offsetRGB];
+  uint32_t lightsLeft = header.nrOfLights;
+  for (uint8_t pin = 0; pin < nrOfPins && lightsLeft; pin++) {
+    uint32_t nrOfLights = nrOfAssignedPins ? MIN(ledsPerPin[pin], lightsLeft) : lightsLeft;
+    lightsLeft -= nrOfLights;
+
+    uint32_t sumRed = 0, sumGreen = 0, sumBlue = 0, sumWhite = 0;  // max 65K lights * 255 per pin
+    if (header.offsetWhite != UINT8_MAX) {
+      for (uint32_t i = 0; i < nrOfLights; i++, channel += header.channelsPerLight) {
+        sumRed += channel[0];
+        sumGreen += channel[1];
+        sumBlue += channel[2];
+        sumWhite += channel[3];
+      }
+    } else {
+      for (uint32_t i = 0; i < nrOfLights; i++, channel += header.channelsPerLight) {
+        sumRed += channel[0];
+        sumGreen += channel[1];
+        sumBlue += channel[2];
+      }
+    }
+
+    // color correction scales the channels like brightness does
+    uint64_t pinFull = ((uint64_t)sumRed * POWER_RED_MA * header.red + (uint64_t)sumGreen * POWER_GREEN_MA * header.green + (uint64_t)sumBlue * POWER_BLUE_MA * header.blue + (uint64_t)sumWhite * POWER_WHITE_MA * 255) / 255;
+    uint32_t pinDark = nrOfLights * POWER_DARK_MA;
+
+    if (maxCurrentPerPin && pinFull && pinFull * target / (255 * 255) + pinDark > maxCurrentPerPin) {
+      target = maxCurrentPerPin > pinDark ? MIN((uint64_t)(maxCurrentPerPin - pinDark) * 255 * 255 / pinFull, target) : 0;
+    }
+
+    totalFull += pinFull;
+    totalDark += pinDark;
+  }
+
+  if (totalFull && totalFull * target / (255 * 255) + totalDark > budget) {
+    target = budget > totalDark ? MIN((uint64_t)(budget - totalDark) * 255 * 255 / totalFull, target) : 0;
+  }
+
+  // slew limiting: never above budget, so down at once, up smoothly
+  if (target < powerBrightness)
+    powerBrightness = target;
+  else if (target > powerBrightness)
+    powerBrightness += MAX((target - powerBrightness) / POWER_SLEW, 1);
+
+  estimatedCurrent = totalFull * powerBrightness / (255 * 255) + totalDark;
+}
+
+void PhysicalLayer::prepareDither() {
+  if (!dither) {
+    if (ditherLut) freeMB(ditherLut, "dither");  // drivers run in this task, so no driver is using it
+    return;
+  }
+
+  if (!ditherLut) {
+    ditherLut = allocMB<Dither::Lut>(1, "dither");  // zeroed: valid for all 0 maps, built from the driver maps in DriverNode::loop
+    if (!ditherLut) {
+      dither = false;
+      return;
+    }
+  }
+  ditherThreshold = Dither::frameThreshold(ditherFrame++);
+}
+
+void PhysicalLayer::setLights(uint8_t layer, int startLight, const uint8_t* channels, uint16_t nrOfChannels) {
+  uint8_t channelsPerLight = lights.header.channelsPerLight;
+  if (startLight < 0 || startLight >= lights.header.nrOfLights) return;
+  int nrOfLights = MIN(nrOfChannels / channelsPerLight, lights.header.nrOfLights - startLight);
+
+  if (layer == 0) {  // physical layer: lights are consecutive, copy in one go
+    memcpy(&lights.channelsE[startLight * channelsPerLight], channels, nrOfLights * channelsPerLight);
+    dirty.mark(startLight * channelsPerLight, nrOfLights * channelsPerLight);
+  } else if (layer <= layers.size()) {  // virtual layer: takes the mapping into account
+    for (int i = 0; i < nrOfLights; i++) layers[layer - 1]->setLight(startLight + i, &channels[i * channelsPerLight], 0, channelsPerLight);
+  }
+}
+
 // an effect is using a virtual layer: tell the effect in which layer to run...
 
 // // to be called in setup, if more then one effect
@@ -18,7 +18,12 @@
   #include <vector>
 
   #include "FastLED.h"
+  #include "FrameScheduler.h"
   #include "MoonBase/Utilities.h"
+  #include "MoonLight/Nodes/Drivers/Dither.h"
+  #include "MoonLight/Nodes/Drivers/OutputStage.h"
+  #include "MoonLight/Nodes/Layouts/LayoutFile.h"
+  #include "PaletteLUT.h"
 
 // #include "VirtualLayer.h"
 
@@ -57,9 +62,10 @@ struct LightsHeader {
   uint8_t offsetBrightness2 = UINT8_MAX;  // 31
   uint16_t nrOfChannels;                  // 32,  so we can deal with exceptional cases e.g. RGB2040 make sure it starts at even position!!! for alignment!!!
   uint8_t lightPreset = 2;                // 34, so we can deal with exceptional cases e.g. RGB2040. default 2 / GRB
+  uint8_t positionBytes = 3;              // 35, bytes per position sent to the monitor: 3: 8 bits per axis, 6: 16 bits per axis (little endian), for layouts > 255
   // =============
-  // 35 bytes total
-  uint8_t fill[5];  // padding to align struct to 40 bytes total. lightsControl will send 37 bytes (prime number)!!! so Monitor.svelte can recognize this
+  // 36 bytes total
+  uint8_t fill[4];  // padding to align struct to 40 bytes total. lightsControl will send 37 bytes (prime number)!!! so Monitor.svelte can recognize this
   // support for more channels, like white, pan, tilt etc.
 
   void resetOffsets() {
@@ -96,6 +102,99 @@ struct Lights {
   // std::vector<size_t> universes; //tells at which byte the universe starts
 };
 
+// channels changed in a frame, one bit per tile of 64 channels. Set by the writes of the effects (VirtualLayer::setLight etc.),
+// used to seed the next frame (PhysicalLayer::seedChannels), by drivers to skip unchanged output and by the monitor.
+// If the tiles could not be allocated, everything is dirty.
+struct DirtyTiles {
+  static const uint8_t tileShift = 6;  // 64 channels per tile, 21 RGB lights
+  uint32_t* bits = nullptr;
+  uint32_t nrOfTiles = 0;
+
+  void allocate(size_t nrOfChannels);
+  size_t words() const { return (nrOfTiles + 31) / 32; }
+  void clear() {
+    if (bits) memset(bits, 0, words() * sizeof(uint32_t));
+  }
+  void markAll() {
+    if (bits) memset(bits, 0xFF, words() * sizeof(uint32_t));
+  }
+
+  void mark(uint32_t channel, uint32_t length = 1) {
+    if (!bits || !length) return;
+    uint32_t last = MIN((channel + length - 1) >> tileShift, nrOfTiles - 1);
+    for (uint32_t tile = channel >> tileShift; tile <= last; tile++) bits[tile >> 5] |= 1u << (tile & 31);
+  }
+
+  bool isDirty(uint32_t channel, uint32_t length) const {
+    if (!bits) return true;
+    if (!length) return false;
+    uint32_t last = MIN((channel + length - 1) >> tileShift, nrOfTiles - 1);
+    for (uint32_t tile = channel >> tileShift; tile <= last; tile++)
+      if (bits[tile >> 5] & (1u << (tile & 31))) return true;
+    return false;
+  }
+
+  void merge(const DirtyTiles& other) {
+    if (bits && other.bits)
+      for (size_t i = 0; i < MIN(words(), other.words()); i++) bits[i] |= other.bits[i];
+    else
+      markAll();
+  }
+
+  uint32_t count() const {  // dirty tiles
+    if (!bits) return nrOfTiles;
+    uint32_t result = 0;
+    for (size_t i = 0; i < words(); i++) result += __builtin_popcount(bits[i]);
+    return result;
+  }
+
+  // calls f(channel, length) for each run of dirty tiles within the first nrOfChannels
+  template <typename F>
+  void forEachSpan(uint32_t nrOfChannels, F f) const {
+    if (!bits) {
+      if (nrOfChannels) f(0, nrOfChannels);
+      return;
+    }
+    uint32_t tiles = MIN((nrOfChannels + (1 << tileShift) - 1) >> tileShift, nrOfTiles);
+    uint32_t tile = 0;
+    while (tile < tiles) {
+      if (!bits[tile >> 5]) {  // 32 clean tiles
+        tile = (tile | 31) + 1;
+        continue;
+      }
+      if (!(bits[tile >> 5] & (1u << (tile & 31)))) {
+        tile++;
+        continue;
+      }
+      uint32_t start = tile;
+      while (tile < tiles && (bits[tile >> 5] & (1u << (tile & 31)))) tile++;
+      uint32_t channel = start << tileShift;
+      f(channel, MIN(tile << tileShift, nrOfChannels) - channel);
+    }
+  }
+};
+
+// the lights and pins of the layout nodes in pass 1 as LayoutFile records, each node starting with a marker_node record. See PhysicalLayer::mapLayout
+struct LayoutRecords {
+  uint8_t* records = nullptr;  // PSRAM if available
+  uint32_t nrOfRecords = 0;
+  uint32_t capacity = 0;        // records allocated
+  uint32_t key = 0;             // layout key of complete records, 0: not complete
+  bool fits = true;             // all positions fit in a record (0..65534) and all records allocated
+  uint8_t lastNode = UINT8_MAX;
+
+  const uint8_t* record(uint32_t index) const { return &records[index * LayoutFile::recordSize]; }
+  bool isMarker(uint32_t index, uint8_t type) const { return LayoutFile::recordValue(record(index), 0) == LayoutFile::marker && LayoutFile::recordValue(record(index), 1) == type; }
+
+  void clear();
+  void add(uint16_t x, uint16_t y, uint16_t z);
+  void addLight(uint8_t node, const Coord3D& position);
+  void addPin(uint8_t node, uint8_t ledPinDIO);
+  void complete(uint32_t key);  // sets key if all records fit and saves them
+  bool load(uint32_t key);      // from the file system, if it has records for key
+  void packPositions(uint8_t* buffer, uint16_t nrOfLights, uint8_t positionBytes) const;  // positions for the monitor
+};
+
 // contains the Lights structure/definition and implements layout functions (add*, modify*)
 class PhysicalLayer {
  public:
@@ -106,7 +205,8 @@ class PhysicalLayer {
 
   std::vector<VirtualLayer*, VectorRAMAllocator<VirtualLayer*>> layers;  // the virtual layers using this physical layer
 
-  CRGBPalette16 palette = PartyColors_p;
+  PaletteLUT palette = CRGBPalette16(PartyColors_p);  // set by Lights Control
+  uint8_t nrOfPalettes = 11;                          // built in palettes and palette files, set by Lights Control
 
   uint8_t requestMapPhysical = false;  // collect requests to map as it is requested by setup and onUpdate and only need to be done once
   uint8_t requestMapVirtual = false;   // collect requests to map as it is requested by setup and onUpdate and only need to be done once
@@ -127,20 +227,62 @@ class PhysicalLayer {
   // mapLayout calls onLayoutPre, onLayout for each node and onLayoutPost and expects pass to be set (1 or 2)
   void mapLayout();
 
+  // layout cache: layout nodes are replayed from layoutRecords as long as their key is the same, instead of running onLayout again
+  std::function<uint32_t()> layoutKey = nullptr;  // hash of the layout nodes and their controls, set by ModuleDrivers. 0: no cache
+  LayoutRecords layoutRecords;
+  uint32_t currentKey = 0;     // key of the mapping in progress
+  uint32_t mappedKey = 0;      // key of the last pass 1, channels are not cleared if the layout is the same
+  bool recording = false;      // pass 1 adds the lights of the layout nodes to layoutRecords
+  bool replaying = false;      // lights are added from layoutRecords
+  bool positionsInRecords = false;  // positions for the monitor are taken from layoutRecords instead of channelsE
+  uint8_t layoutNode = UINT8_MAX;   // index of the layout node running onLayout, UINT8_MAX if not a layout node
+  uint32_t replayNode(uint32_t index);
+
   uint8_t pass = 0;  //'class global' so addLight/Pin functions know which pass it is in
   bool monitorPass = false;
   void onLayoutPre();
   void addLight(Coord3D position);
+  void widenPositions();
   void nextPin(uint8_t ledPin = UINT8_MAX);  // if more pins are defined, the next lights will be assigned to the next pin
   void onLayoutPost();
 
+  // used by network input drivers (Art-Net, DDP, sACN): copy whole lights from a packet into the physical layer (0) or a virtual layer (1..)
+  void setLights(uint8_t layer, int startLight, const uint8_t* channels, uint16_t nrOfChannels);
+
   // from board presets
   uint8_t ledPins[MAXLEDPINS];
   uint8_t ledPinsAssigned[MAXLEDPINS];
   uint16_t ledsPerPin[MAXLEDPINS];
   uint8_t nrOfLedPins = 0;
   uint8_t nrOfAssignedPins = 0;
-  uint16_t maxPower = 0;
+  uint16_t maxPower = 0;           // Watt, 0: no limit
+  uint16_t maxCurrentPerPin = 0;   // mA, 0: no limit
+
+  // power budget: estimated each frame from the driver channels, see estimatePower
+  uint8_t powerBrightness = 255;   // brightness after the power budget, used by the drivers
+  uint32_t estimatedCurrent = 0;   // mA at powerBrightness
+  void estimatePower();
+
+  // temporal dithering of the driver output, see Dither.h
+  bool dither = false;
+  Dither::Lut* ditherLut = nullptr;  // set each frame if dither is on, used by the drivers which convert the channels themselves
+  uint8_t ditherFrame = 0;
+  uint8_t ditherThreshold = 0;       // threshold of this frame
+  OutputStage outputStage;           // compiled by the drivers when the light preset changes
+  void prepareDither();
+
+  // dirty tracking, see DirtyTiles
+  DirtyTiles dirty;                    // written by the effects in the frame being made (channelsE)
+  DirtyTiles dirtyD;                   // changed in the frame in channelsD, for the drivers and the monitor
+  volatile bool requestFullFrame = true;  // all channels dirty in the next frame (after mapping: positions were in channelsE)
+  uint32_t changedFrames = 0;          // frames with at least one change, the monitor only sends if this changed
+  uint8_t changedPercent = 0;          // tiles changed in the last frame
+  bool seedNeeded = true;              // a node reads the previous frame (VirtualLayer::readsPrevious), set by loop for the next frame
+  void seedChannels();                 // copy the previous frame (channelsD) to channelsE, only the changed spans
+  void swapDirty();                    // end of frame: the dirty tiles go with channelsE to channelsD
+
+  // frame pacing of the effect task (set by lights control), nodes use frameMillis, frameDelta and skipOptional, see FrameScheduler.h
+  FrameScheduler frameScheduler;
 
   // an effect is using a virtual layer: tell the effect in which layer to run...
 
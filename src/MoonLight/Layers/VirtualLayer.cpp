@@ -41,13 +41,54 @@ VirtualLayer::~VirtualLayer() {
   // clear mapping table
   // mappingTable.clear();
   freeMB(mappingTable);
+  if (xyzTable) freeMB(xyzTable);
+  arena.setRegion(nullptr, 0);
+  if (arenaRegion) freeMB(arenaRegion, "arena");
 }
 
 void VirtualLayer::setup() {
   // no node setup here as done in addNode !
+
+  // allocated before presets fragment the heap. Nodes added before setup carve from the heap until the first sweep
+  arena.heapAlloc = [](size_t size) -> void* { return allocMB<uint8_t>(size, "arena"); };
+  arena.heapFree = [](void* p) { freeMB(p, "arena"); };
+  arenaRegion = allocMB<uint8_t>(NODE_ARENA_MIN, "arena");
+  arena.setRegion(arenaRegion, arenaRegion ? NODE_ARENA_MIN : 0);
+}
+
+// free all size dependent node buffers and grow the region to what they needed, the nodes allocate them again in onSizeChanged
+// returns true if the region has grown
+bool VirtualLayer::sweepArena() {
+  uint32_t demand = arena.sweep();
+  uint32_t needed = (demand + demand / 4 + 1023) & ~1023;  // 25% for a bigger size, in KB
+  if (needed > arena.stats.capacity) {
+    uint32_t oldCapacity = arena.stats.capacity;
+    uint32_t capacity = needed;
+    arena.setRegion(nullptr, 0);
+    if (arenaRegion) freeMB(arenaRegion, "arena");  // free first: on boards without PSRAM there may be no room for both
+    arenaRegion = allocMB<uint8_t>(capacity, "arena");
+    if (!arenaRegion && oldCapacity) {  // keep the old size, the rest is allocated on the heap
+      capacity = oldCapacity;
+      arenaRegion = allocMB<uint8_t>(capacity, "arena");
+    }
+    arena.setRegion(arenaRegion, arenaRegion ? capacity : 0);
+    EXT_LOGD(ML_TAG, "arena %d -> %d bytes (demand %d)", oldCapacity, arena.stats.capacity, demand);
+    return arena.stats.capacity > oldCapacity;
+  }
+  return false;
 }
 
 void VirtualLayer::loop() {
+  // schedule the nodes: effects hidden by an effect which overwrites all lights are skipped, modifiers always run
+  opaqueNode = UINT8_MAX;
+  if (layerP->lights.header.channelsPerLight == 3)  // fullOverwrite covers RGB, not the other channels of multichannel lights
+    for (uint8_t i = 0; i < nodes.size(); i++)
+      if (nodes[i]->on && nodes[i]->capabilities.fullOverwrite) opaqueNode = i;
+  readsPrevious = opaqueNode == UINT8_MAX;
+  for (uint8_t i = opaqueNode; !readsPrevious && i < nodes.size(); i++)
+    if (nodes[i]->on && nodes[i]->capabilities.readsPrevious) readsPrevious = true;
+
+  if (opaqueNode != UINT8_MAX) fadeMin = 0;  // faded lights are overwritten
   fadeToBlackMin();
 
   // set brightness default to global brightness
@@ -58,10 +99,21 @@ void VirtualLayer::loop() {
     }
   }
 
-  if (prevSize != size) EXT_LOGD(ML_TAG, "onSizeChanged V %d,%d,%d -> %d,%d,%d", prevSize.x, prevSize.y, prevSize.z, size.x, size.y, size.z);
-  for (Node* node : nodes) {
-    if (prevSize != size) node->onSizeChanged(prevSize);
-    if (node->on) node->loop();
+  if (prevSize != size) {
+    EXT_LOGD(ML_TAG, "onSizeChanged V %d,%d,%d -> %d,%d,%d", prevSize.x, prevSize.y, prevSize.z, size.x, size.y, size.z);
+    sweepArena();  // in one go before the nodes allocate their buffers again
+    for (Node* node : nodes) node->onSizeChanged(prevSize);
+    // buffers of the new size did not fit: sweep again with their demand, so they all come from the grown region
+    if (arena.stats.fallbacks && sweepArena())
+      for (Node* node : nodes) node->onSizeChanged(prevSize);
+  }
+  for (uint8_t i = 0; i < nodes.size(); i++) {
+    Node* node = nodes[i];
+    if (node->on && (opaqueNode == UINT8_MAX || i >= opaqueNode || node->hasModifier())) {
+      uint32_t start = micros();
+      node->loop();
+      node->loopMicros = (node->loopMicros * 7 + micros() - start) / 8;  // live scripts: loop waits for the frame of the script
+    }
   }
   prevSize = size;
 };
@@ -102,14 +154,40 @@ void VirtualLayer::addIndexP(PhysMap& physMap, uint16_t indexP) {
   }
   // EXT_LOGV(ML_TAG, "\n");
 }
-uint16_t VirtualLayer::XYZ(Coord3D& position) {
-  // XYZ modifiers (this is not slowing things down as you might have expected ...)
+uint16_t VirtualLayer::XYZ(const Coord3D& position) {
+  if (xyzMode == xyz_none) return XYZUnModified(position);
+
+  // effects like blur call XYZ multiple times per light per frame, so walk the modifiers once per light per frame
+  if (xyzMode == xyz_table && isInside(position)) {
+    if (!xyzTableValid) compileXYZ();
+    if (xyzTableValid) return xyzTable[XYZUnModified(position)];
+  }
+
+  // XYZ modifiers (positions outside the layer, modifiers which are not frame static or no table)
+  Coord3D modified = position;
   for (Node* node : nodes) {      // e.g. random or scrolling or rotate modifier
     if (node->on)                 //  && node->hasModifier()
-      node->modifyXYZ(position);  // modifies the position
+      node->modifyXYZ(modified);  // modifies the position
   }
 
-  return XYZUnModified(position);
+  return XYZUnModified(modified);
+}
+
+void VirtualLayer::compileXYZ() {
+  if (!xyzTable || xyzTableSize != size.x * size.y * size.z) return;  // allocated in onLayoutPost, until then XYZ calls the modifiers
+
+  uint16_t indexV = 0;
+  Coord3D cell;
+  for (cell.z = 0; cell.z < size.z; cell.z++)
+    for (cell.y = 0; cell.y < size.y; cell.y++)
+      for (cell.x = 0; cell.x < size.x; cell.x++) {
+        Coord3D position = cell;
+        for (Node* node : nodes) {
+          if (node->on) node->modifyXYZ(position);
+        }
+        xyzTable[indexV++] = XYZUnModified(position);  // same result as without table, also for positions moved outside the layer
+      }
+  xyzTableValid = true;
 }
 
 // void VirtualLayer::setLightsToBlend() {
@@ -139,7 +217,7 @@ void VirtualLayer::setLight(const uint16_t indexV, const uint8_t* channels, uint
       if (layerP->lights.header.lightPreset == lightPreset_RGB2040) {  // RGB2040 has empty channels: Skip the 20..39 range, so adjust group mapping
         indexP += (indexP / 20) * 20;
       }
-      memcpy(&layerP->lights.channelsE[indexP * layerP->lights.header.channelsPerLight + offset], channels, length);
+      writeChannels(indexP * layerP->lights.header.channelsPerLight + offset, channels, length);
 
       break;
     }
@@ -149,7 +227,7 @@ void VirtualLayer::setLight(const uint16_t indexV, const uint8_t* channels, uint
           if (layerP->lights.header.lightPreset == lightPreset_RGB2040) {  // RGB2040 has empty channels: Skip the 20..39 range, so adjust group mapping
             indexP += (indexP / 20) * 20;
           }
-          memcpy(&layerP->lights.channelsE[indexP * layerP->lights.header.channelsPerLight + offset], channels, length);
+          writeChannels(indexP * layerP->lights.header.channelsPerLight + offset, channels, length);
         }
       else
         EXT_LOGW(ML_TAG, "dev setLightColor i:%d m:%d s:%d", indexV, mappingTable[indexV].indexes, mappingTableIndexes.size());
@@ -157,7 +235,7 @@ void VirtualLayer::setLight(const uint16_t indexV, const uint8_t* channels, uint
     default:;
     }
   } else if (indexV * layerP->lights.header.channelsPerLight + offset + length < layerP->lights.maxChannels) {  // no mapping
-    memcpy(&layerP->lights.channelsE[indexV * layerP->lights.header.channelsPerLight + offset], channels, length);
+    writeChannels(indexV * layerP->lights.header.channelsPerLight + offset, channels, length);
   }
 }
 
@@ -221,6 +299,17 @@ void VirtualLayer::fadeToBlackMin() {
     //   }
     // } else
     if (layerP->lights.header.channelsPerLight == 3 && layerP->layers.size() == 1) {  // CRGB lights
+      // only lights which are not black change
+      uint8_t* channels = layerP->lights.channelsE;
+      const uint32_t tileSize = 1 << DirtyTiles::tileShift;
+      for (uint32_t tile = 0; tile < layerP->lights.header.nrOfChannels; tile += tileSize) {
+        uint32_t end = MIN(tile + tileSize, layerP->lights.header.nrOfChannels);
+        for (uint32_t i = tile; i < end; i++)
+          if (channels[i]) {
+            layerP->dirty.mark(tile);
+            break;
+          }
+      }
       fastled_fadeToBlackBy((CRGB*)layerP->lights.channelsE, layerP->lights.header.nrOfChannels / sizeof(CRGB), fadeBy);
     } else {  // multichannel lights
       for (uint16_t index = 0; index < nrOfLights; index++) {
@@ -263,7 +352,12 @@ void VirtualLayer::fill_solid(const CRGB& color) {
   //   }
   // } else
   if (layerP->lights.header.channelsPerLight == 3 && layerP->layers.size() == 1) {  // faster, else manual
-    fastled_fill_solid((CRGB*)layerP->lights.channelsE, layerP->lights.header.nrOfChannels / sizeof(CRGB), color);
+    CRGB* leds = (CRGB*)layerP->lights.channelsE;
+    for (uint16_t index = 0; index < layerP->lights.header.nrOfChannels / sizeof(CRGB); index++)
+      if (leds[index] != color) {  // a static color only changes once
+        leds[index] = color;
+        layerP->dirty.mark(index * sizeof(CRGB), sizeof(CRGB));
+      }
   } else {
     for (uint16_t index = 0; index < nrOfLights; index++) setRGB(index, color);
   }
@@ -284,6 +378,7 @@ void VirtualLayer::fill_rainbow(const uint8_t initialhue, const uint8_t deltahue
   // } else
   if (layerP->lights.header.channelsPerLight == 3 && layerP->layers.size() == 1) {  // faster, else manual
     fastled_fill_rainbow((CRGB*)layerP->lights.channelsE, layerP->lights.header.nrOfChannels / sizeof(CRGB), initialhue, deltahue);
+    layerP->dirty.markAll();
   } else {
     CHSV hsv;
     hsv.hue = initialhue;
@@ -337,6 +432,8 @@ void VirtualLayer::onLayoutPre() {
   }
 
   if (mappingTable && mappingTableSize) memset(mappingTable, 0, mappingTableSize * sizeof(PhysMap));  // on layout, set mappingTable to default PhysMap
+
+  xyzTableValid = false;  // size and modifiers can change, recompiled after onLayoutPost
 }
 
 void VirtualLayer::addLight(Coord3D position) {
@@ -387,9 +484,36 @@ void VirtualLayer::onLayoutPost() {
   }
 
   EXT_LOGD(MB_TAG, "V:%d x %d x %d = v:%d = 1:0:%d + 1:1:%d + mti:%d (1:m:%d)", size.x, size.y, size.z, nrOfLights, nrOfZeroLights, nrOfOneLight, mappingTableIndexesSizeUsed, nrOfMoreLights);
+
+  // decide how XYZ applies modifyXYZ: no modifiers, compiled table or per call
+  uint8_t mode = xyz_none;
+  for (Node* node : nodes) {
+    if (!node->on || (!node->hasModifyXYZ() && !node->capabilities.modifyXYZ)) continue;
+    if (!node->hasModifyXYZ() || !node->isModifyXYZStatic()) {  // not declared frame static (or hasModifyXYZ forgotten): called on each XYZ
+      mode = xyz_chain;
+      break;
+    }
+    mode = xyz_table;
+  }
+
+  xyzTableValid = false;
+  if (mode == xyz_table) {
+    if (xyzTableSize != mappingTableSize) {
+      uint16_t* newTable = reallocMB<uint16_t>(xyzTable, mappingTableSize, "xyzTable");
+      if (newTable) {
+        xyzTable = newTable;
+        xyzTableSize = mappingTableSize;
+      } else
+        mode = xyz_chain;  // works without table, only slower
+    }
+  } else if (xyzTable) {
+    freeMB(xyzTable, "xyzTable");
+    xyzTableSize = 0;
+  }
+  xyzMode = mode;
 }
 
-void VirtualLayer::drawLine(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, CRGB color, bool soft, uint8_t depth) {
+void VirtualLayer::drawLine(int x0, int y0, int x1, int y1, CRGB color, bool soft, uint8_t depth) {
   // WLEDMM shorten line according to depth
   if (depth < UINT8_MAX) {
     if (depth == 0) return;  // nothing to paint
@@ -399,9 +523,9 @@ void VirtualLayer::drawLine(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, CRGB
     }  // single pixel
     else {  // shorten line
       x0 *= 2;
-      y0 *= 2;                                                 // we do everything "*2" for better rounding
-      int dx1 = ((int(2 * x1) - int(x0)) * int(depth)) / 255;  // X distance, scaled down by depth
-      int dy1 = ((int(2 * y1) - int(y0)) * int(depth)) / 255;  // Y distance, scaled down by depth
+      y0 *= 2;                                       // we do everything "*2" for better rounding
+      int dx1 = ((2 * x1 - x0) * int(depth)) / 255;  // X distance, scaled down by depth
+      int dy1 = ((2 * y1 - y0) * int(depth)) / 255;  // Y distance, scaled down by depth
       x1 = (x0 + dx1 + 1) / 2;
       y1 = (y0 + dy1 + 1) / 2;
       x0 /= 2;
@@ -409,12 +533,13 @@ void VirtualLayer::drawLine(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, CRGB
     }
   }
 
-  const int16_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
-  const int16_t dy = abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+  const int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+  const int dy = abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
 
   // single pixel (line length == 0)
   if (dx + dy == 0) {
-    setRGB({x0, y0, 0}, color);
+    Coord3D pos = {x0, y0, 0};
+    if (isInside(pos)) setRGB(pos, color);
     return;
   }
 
@@ -433,27 +558,24 @@ void VirtualLayer::drawLine(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, CRGB
     }
     float gradient = x1 - x0 == 0 ? 1.0f : float(y1 - y0) / float(x1 - x0);
     float intersectY = y0;
-    for (uint8_t x = x0; x <= x1; x++) {
+    for (int x = x0; x <= x1; x++) {
       unsigned keep = float(0xFFFF) * (intersectY - int(intersectY));  // how much color to keep
       unsigned seep = 0xFFFF - keep;                                   // how much background to keep
-      uint8_t y = uint8_t(intersectY);
-      if (steep) std::swap(x, y);  // temporarily swap if steep
+      int y = int(intersectY);
       // pixel coverage is determined by fractional part of y co-ordinate
-      // WLEDMM added out-of-bounds check: "unsigned(x) < cols" catches negative numbers _and_ too large values
-      setRGB({x, y, 0}, blend(color, getRGB({x, y, 0}), keep));
-      uint8_t xx = x + uint8_t(steep);
-      uint8_t yy = y + uint8_t(!steep);
-      setRGB({xx, yy, 0}, blend(color, getRGB({xx, yy, 0}), seep));
+      Coord3D pos = steep ? Coord3D(y, x, 0) : Coord3D(x, y, 0);
+      if (isInside(pos)) setRGB(pos, blend(color, getRGB(pos), keep));
+      pos = steep ? Coord3D(y + 1, x, 0) : Coord3D(x, y + 1, 0);
+      if (isInside(pos)) setRGB(pos, blend(color, getRGB(pos), seep));
 
       intersectY += gradient;
-      if (steep) std::swap(x, y);  // restore if steep
     }
   } else {
     // Bresenham's algorithm
     int err = (dx > dy ? dx : -dy) / 2;  // error direction
     for (;;) {
-      // if (x0 >= cols || y0 >= rows) break; // WLEDMM we hit the edge - should never happen
-      setRGB({x0, y0, 0}, color);
+      Coord3D pos = {x0, y0, 0};
+      if (isInside(pos)) setRGB(pos, color);
       if (x0 == x1 && y0 == y1) break;
       int e2 = err;
       if (e2 > -dx) {
@@ -469,7 +591,7 @@ void VirtualLayer::drawLine(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, CRGB
 }
 
 // to do: merge with drawLine to support 2D and 3D
-void VirtualLayer::drawLine3D(uint8_t x1, uint8_t y1, uint8_t z1, uint8_t x2, uint8_t y2, uint8_t z2, CRGB color, bool soft, uint8_t depth) {
+void VirtualLayer::drawLine3D(int x1, int y1, int z1, int x2, int y2, int z2, CRGB color, bool soft, uint8_t depth) {
   // WLEDMM shorten line according to depth
   if (depth < UINT8_MAX) {
     if (depth == 0) return;  // nothing to paint
@@ -481,13 +603,13 @@ void VirtualLayer::drawLine3D(uint8_t x1, uint8_t y1, uint8_t z1, uint8_t x2, ui
     else {  // shorten line
       x1 *= 2;
       y1 *= 2;
-      z1 *= 2;                                                 // we do everything "*2" for better rounding
-      int dx1 = ((int(2 * x2) - int(x1)) * int(depth)) / 255;  // X distance, scaled down by depth
-      int dy1 = ((int(2 * y2) - int(y1)) * int(depth)) / 255;  // Y distance, scaled down by depth
-      int dz1 = ((int(2 * z2) - int(z1)) * int(depth)) / 255;  // Y distance, scaled down by depth
-      x1 = (x1 + dx1 + 1) / 2;
-      y1 = (y1 + dy1 + 1) / 2;
-      z1 = (z1 + dz1 + 1) / 2;
+      z1 *= 2;                                       // we do everything "*2" for better rounding
+      int dx1 = ((2 * x2 - x1) * int(depth)) / 255;  // X distance, scaled down by depth
+      int dy1 = ((2 * y2 - y1) * int(depth)) / 255;  // Y distance, scaled down by depth
+      int dz1 = ((2 * z2 - z1) * int(depth)) / 255;  // Z distance, scaled down by depth
+      x2 = (x1 + dx1 + 1) / 2;
+      y2 = (y1 + dy1 + 1) / 2;
+      z2 = (z1 + dz1 + 1) / 2;
       x1 /= 2;
       y1 /= 2;
       z1 /= 2;
@@ -496,8 +618,13 @@ void VirtualLayer::drawLine3D(uint8_t x1, uint8_t y1, uint8_t z1, uint8_t x2, ui
 
   // to do implement soft
 
+  auto plot = [&]() {
+    Coord3D pos = {x1, y1, z1};
+    if (isInside(pos)) setRGB(pos, color);
+  };
+
   // Bresenham
-  setRGB({x1, y1, z1}, color);
+  plot();
   int dx = abs(x2 - x1);
   int dy = abs(y2 - y1);
   int dz = abs(z2 - z1);
@@ -533,7 +660,7 @@ void VirtualLayer::drawLine3D(uint8_t x1, uint8_t y1, uint8_t z1, uint8_t x2, ui
       }
       p1 += 2 * dy;
       p2 += 2 * dz;
-      setRGB({x1, y1, z1}, color);
+      plot();
     }
 
     // Driving axis is Y-axis"
@@ -552,7 +679,7 @@ void VirtualLayer::drawLine3D(uint8_t x1, uint8_t y1, uint8_t z1, uint8_t x2, ui
       }
       p1 += 2 * dx;
       p2 += 2 * dz;
-      setRGB({x1, y1, z1}, color);
+      plot();
     }
 
     // Driving axis is Z-axis"
@@ -571,13 +698,21 @@ void VirtualLayer::drawLine3D(uint8_t x1, uint8_t y1, uint8_t z1, uint8_t x2, ui
       }
       p1 += 2 * dy;
       p2 += 2 * dx;
-      setRGB({x1, y1, z1}, color);
+      plot();
     }
   }
 }
 
-void VirtualLayer::drawCircle(int cx, int cy, uint8_t radius, CRGB col, bool soft) {
+void VirtualLayer::drawCircle(int cx, int cy, uint16_t radius, CRGB col, bool soft) {
   if (radius == 0) return;
+
+  // the 8 symmetric points of (x, y), skipping the ones outside the layer
+  auto plot8 = [&](int x, int y, auto&& paint) {
+    const Coord3D points[8] = {{cx + x, cy + y, 0}, {cx - x, cy + y, 0}, {cx + x, cy - y, 0}, {cx - x, cy - y, 0}, {cx + y, cy + x, 0}, {cx - y, cy + x, 0}, {cx + y, cy - x, 0}, {cx - y, cy - x, 0}};
+    for (const Coord3D& pos : points)
+      if (isInside(pos)) paint(pos);
+  };
+
   if (soft) {
     // Xiaolin Wu’s algorithm
     int rsq = radius * radius;
@@ -589,22 +724,11 @@ void VirtualLayer::drawCircle(int cx, int cy, uint8_t radius, CRGB col, bool sof
       unsigned fade = float(0xFFFF) * (ceilf(yf) - yf);  // how much color to keep
       if (oldFade > fade) y--;
       oldFade = fade;
-      setRGB(Coord3D(cx + x, cy + y, 0), blend(col, getRGB(Coord3D(cx + x, cy + y, 0)), fade));
-      setRGB(Coord3D(cx - x, cy + y), blend(col, getRGB(Coord3D(cx - x, cy + y)), fade));
-      setRGB(Coord3D(cx + x, cy - y), blend(col, getRGB(Coord3D(cx + x, cy - y)), fade));
-      setRGB(Coord3D(cx - x, cy - y), blend(col, getRGB(Coord3D(cx - x, cy - y)), fade));
-      setRGB(Coord3D(cx + y, cy + x), blend(col, getRGB(Coord3D(cx + y, cy + x)), fade));
-      setRGB(Coord3D(cx - y, cy + x), blend(col, getRGB(Coord3D(cx - y, cy + x)), fade));
-      setRGB(Coord3D(cx + y, cy - x), blend(col, getRGB(Coord3D(cx + y, cy - x)), fade));
-      setRGB(Coord3D(cx - y, cy - x), blend(col, getRGB(Coord3D(cx - y, cy - x)), fade));
-      setRGB(Coord3D(cx + x, cy + y - 1), blend(getRGB(Coord3D(cx + x, cy + y - 1)), col, fade));
-      setRGB(Coord3D(cx - x, cy + y - 1), blend(getRGB(Coord3D(cx - x, cy + y - 1)), col, fade));
-      setRGB(Coord3D(cx + x, cy - y + 1), blend(getRGB(Coord3D(cx + x, cy - y + 1)), col, fade));
-      setRGB(Coord3D(cx - x, cy - y + 1), blend(getRGB(Coord3D(cx - x, cy - y + 1)), col, fade));
-      setRGB(Coord3D(cx + y - 1, cy + x), blend(getRGB(Coord3D(cx + y - 1, cy + x)), col, fade));
-      setRGB(Coord3D(cx - y + 1, cy + x), blend(getRGB(Coord3D(cx - y + 1, cy + x)), col, fade));
-      setRGB(Coord3D(cx + y - 1, cy - x), blend(getRGB(Coord3D(cx + y - 1, cy - x)), col, fade));
-      setRGB(Coord3D(cx - y + 1, cy - x), blend(getRGB(Coord3D(cx - y + 1, cy - x)), col, fade));
+      plot8(x, y, [&](const Coord3D& pos) { setRGB(pos, blend(col, getRGB(pos), fade)); });
+      // inner pixels: y - 1 towards the center, for the swapped points x - 1
+      const Coord3D inner[8] = {{cx + x, cy + y - 1, 0}, {cx - x, cy + y - 1, 0}, {cx + x, cy - y + 1, 0}, {cx - x, cy - y + 1, 0}, {cx + y - 1, cy + x, 0}, {cx - y + 1, cy + x, 0}, {cx + y - 1, cy - x, 0}, {cx - y + 1, cy - x, 0}};
+      for (const Coord3D& pos : inner)
+        if (isInside(pos)) setRGB(pos, blend(getRGB(pos), col, fade));
       x++;
     }
   } else {
@@ -612,14 +736,7 @@ void VirtualLayer::drawCircle(int cx, int cy, uint8_t radius, CRGB col, bool sof
     int d = 3 - (2 * radius);
     int y = radius, x = 0;
     while (y >= x) {
-      setRGB(Coord3D(cx + x, cy + y), col);
-      setRGB(Coord3D(cx - x, cy + y), col);
-      setRGB(Coord3D(cx + x, cy - y), col);
-      setRGB(Coord3D(cx - x, cy - y), col);
-      setRGB(Coord3D(cx + y, cy + x), col);
-      setRGB(Coord3D(cx - y, cy + x), col);
-      setRGB(Coord3D(cx + y, cy - x), col);
-      setRGB(Coord3D(cx - y, cy - x), col);
+      plot8(x, y, [&](const Coord3D& pos) { setRGB(pos, col); });
       x++;
       if (d > 0) {
         y--;
@@ -18,6 +18,7 @@
 
   #include <vector>
 
+  #include "NodeArena.h"
   #include "PhysicalLayer.h"
 
 enum MapTypeEnum {
@@ -27,6 +28,13 @@ enum MapTypeEnum {
   m_count  // keep as last entry
 };
 
+// how XYZ applies the modifyXYZ of the modifiers
+enum XYZModeEnum {
+  xyz_none,   // no modifier with modifyXYZ: XYZ is XYZUnModified
+  xyz_table,  // all modifyXYZ are frame static: compiled in xyzTable
+  xyz_chain   // call modifyXYZ of all modifiers on each XYZ
+};
+
 // heap-optimization: request heap optimization review
 // on boards without PSRAM, heap is only 60 KB (30KB max alloc) available, need to find out how to increase the heap
 // Physmap is used by mappingTable, see below
@@ -54,6 +62,8 @@ struct PhysMap {
   #define _3D 3
   #define _NoD 4
 
+  #define NODE_ARENA_MIN 4096  // bytes, initial region of the node arena, grown to the demand of the nodes at a sweep
+
 class VirtualLayer {
  public:
   uint16_t nrOfLights = 256;
@@ -72,11 +82,25 @@ class VirtualLayer {
   std::vector<std::vector<uint16_t>, VectorRAMAllocator<std::vector<uint16_t>>> mappingTableIndexes;
   uint16_t mappingTableIndexesSizeUsed = 0;
 
+  // modifyXYZ of all modifiers resolved once for each virtual light: indexV -> modified indexV, see XYZ
+  uint16_t* xyzTable = nullptr;
+  uint16_t xyzTableSize = 0;
+  uint8_t xyzMode = xyz_none;  // set in onLayoutPost
+  bool xyzTableValid = false;
+
+  // size dependent buffers of the nodes, swept and carved again when the size changes
+  NodeArena arena;
+  uint8_t* arenaRegion = nullptr;
+
   PhysicalLayer* layerP;  // physical LEDs the virtual LEDs are mapped to
   std::vector<Node*, VectorRAMAllocator<Node*>> nodes;
 
   uint8_t fadeMin;
 
+  // schedule of the last loop, from the NodeCaps of the nodes
+  uint8_t opaqueNode = UINT8_MAX;  // last effect which overwrites all lights, the effects before it are not run
+  bool readsPrevious = true;       // a node which runs reads the previous frame
+
   uint8_t effectDimension = _3D;  // assuming 3D for the moment
   uint8_t layerDimension = UINT8_MAX;
 
@@ -88,15 +112,23 @@ class VirtualLayer {
 
   void setup();
   void loop();
+  bool sweepArena();
   void loop20ms();
 
   void addIndexP(PhysMap& physMap, uint16_t indexP);
 
-  // position is by reference as within XYZ, the position can be modified, for efficiency reasons, don't declare an extra variable for that in XYZ
-  uint16_t XYZ(Coord3D& position);
+  // position by const reference: called for each light access, the modifiers work on a copy only if not compiled in xyzTable
+  uint16_t XYZ(const Coord3D& position);
+
+  // called by modifiers if the result of modifyXYZ changes (e.g. a new rotation angle), xyzTable is recompiled at the next XYZ
+  void invalidateXYZ() { xyzTableValid = false; }
+  void compileXYZ();
 
   uint16_t XYZUnModified(const Coord3D& position) const { return position.x + position.y * size.x + position.z * size.x * size.y; }
 
+  // used by the draw functions which can go outside the layer (e.g. a circle near the edge), XYZ would wrap to another row
+  bool isInside(const Coord3D& position) const { return (unsigned)position.x < (unsigned)size.x && (unsigned)position.y < (unsigned)size.y && (unsigned)position.z < (unsigned)size.z; }
+
   void setRGB(const uint16_t indexV, CRGB color) {
     if (layerP->lights.header.offsetWhite != UINT8_MAX && layerP->lights.header.channelsPerLight == 4) {  // W set
       // using the simple algorithm of taking the minimum of RGB as white channel, this is good enough and fastest algorithm - we need speed 🔥
@@ -109,7 +141,7 @@ class VirtualLayer {
     } else
       setLight(indexV, color.raw, layerP->lights.header.offsetRGB, sizeof(color));
   }
-  void setRGB(Coord3D pos, CRGB color) { setRGB(XYZ(pos), color); }
+  void setRGB(const Coord3D& pos, CRGB color) { setRGB(XYZ(pos), color); }
 
   void setWhite(const uint16_t indexV, const uint8_t value) {
     if (layerP->lights.header.offsetWhite != UINT8_MAX) {
@@ -117,81 +149,89 @@ class VirtualLayer {
       else setLight(indexV, &value, layerP->lights.header.offsetWhite, sizeof(value)); // for moving heads
     }
   }
-  void setWhite(Coord3D pos, const uint8_t value) { setWhite(XYZ(pos), value); }
+  void setWhite(const Coord3D& pos, const uint8_t value) { setWhite(XYZ(pos), value); }
 
   void setBrightness(const uint16_t indexV, uint8_t value) {
     value = (value * layerP->lights.header.brightness) / 255;
     if (layerP->lights.header.offsetBrightness != UINT8_MAX) setLight(indexV, &value, layerP->lights.header.offsetBrightness, sizeof(value));
   }
-  void setBrightness(Coord3D pos, const uint8_t value) { setBrightness(XYZ(pos), value); }
+  void setBrightness(const Coord3D& pos, const uint8_t value) { setBrightness(XYZ(pos), value); }
 
   void setPan(const uint16_t indexV, const uint8_t value) {
     if (layerP->lights.header.offsetPan != UINT8_MAX) setLight(indexV, &value, layerP->lights.header.offsetPan, sizeof(value));
   }
-  void setPan(Coord3D pos, const uint8_t value) { setPan(XYZ(pos), value); }
+  void setPan(const Coord3D& pos, const uint8_t value) { setPan(XYZ(pos), value); }
 
   void setTilt(const uint16_t indexV, const uint8_t value) {
     if (layerP->lights.header.offsetTilt != UINT8_MAX) setLight(indexV, &value, layerP->lights.header.offsetTilt, sizeof(value));
   }
-  void setTilt(Coord3D pos, const uint8_t value) { setTilt(XYZ(pos), value); }
+  void setTilt(const Coord3D& pos, const uint8_t value) { setTilt(XYZ(pos), value); }
 
   void setZoom(const uint16_t indexV, const uint8_t value) {
     if (layerP->lights.header.offsetZoom != UINT8_MAX) setLight(indexV, &value, layerP->lights.header.offsetZoom, sizeof(value));
   }
-  void setZoom(Coord3D pos, const uint8_t value) { setZoom(XYZ(pos), value); }
+  void setZoom(const Coord3D& pos, const uint8_t value) { setZoom(XYZ(pos), value); }
 
   void setRotate(const uint16_t indexV, const uint8_t value) {
     if (layerP->lights.header.offsetRotate != UINT8_MAX) setLight(indexV, &value, layerP->lights.header.offsetRotate, sizeof(value));
   }
-  void setRotate(Coord3D pos, const uint8_t value) { setRotate(XYZ(pos), value); }
+  void setRotate(const Coord3D& pos, const uint8_t value) { setRotate(XYZ(pos), value); }
 
   void setGobo(const uint16_t indexV, const uint8_t value) {
     if (layerP->lights.header.offsetGobo != UINT8_MAX) setLight(indexV, &value, layerP->lights.header.offsetGobo, sizeof(value));
   }
-  void setGobo(Coord3D pos, const uint8_t value) { setGobo(XYZ(pos), value); }
+  void setGobo(const Coord3D& pos, const uint8_t value) { setGobo(XYZ(pos), value); }
 
   void setRGB1(const uint16_t indexV, CRGB color) {
     if (layerP->lights.header.offsetRGB1 != UINT8_MAX) setLight(indexV, color.raw, layerP->lights.header.offsetRGB1, sizeof(color));
   }
-  void setRGB1(Coord3D pos, CRGB color) { setRGB1(XYZ(pos), color); }
+  void setRGB1(const Coord3D& pos, CRGB color) { setRGB1(XYZ(pos), color); }
 
   void setRGB2(const uint16_t indexV, CRGB color) {
     if (layerP->lights.header.offsetRGB2 != UINT8_MAX) setLight(indexV, color.raw, layerP->lights.header.offsetRGB2, sizeof(color));
   }
-  void setRGB2(Coord3D pos, CRGB color) { setRGB2(XYZ(pos), color); }
+  void setRGB2(const Coord3D& pos, CRGB color) { setRGB2(XYZ(pos), color); }
 
   void setRGB3(const uint16_t indexV, CRGB color) {
     if (layerP->lights.header.offsetRGB3 != UINT8_MAX) setLight(indexV, color.raw, layerP->lights.header.offsetRGB3, sizeof(color));
   }
-  void setRGB3(Coord3D pos, CRGB color) { setRGB3(XYZ(pos), color); }
+  void setRGB3(const Coord3D& pos, CRGB color) { setRGB3(XYZ(pos), color); }
 
   void setBrightness2(const uint16_t indexV, uint8_t value) {
     value = (value * layerP->lights.header.brightness) / 255;
     if (layerP->lights.header.offsetBrightness2 != UINT8_MAX) setLight(indexV, &value, layerP->lights.header.offsetBrightness2, sizeof(value));
   }
-  void setBrightness2(Coord3D pos, const uint8_t value) { setBrightness2(XYZ(pos), value); }
+  void setBrightness2(const Coord3D& pos, const uint8_t value) { setBrightness2(XYZ(pos), value); }
 
   void setLight(const uint16_t indexV, const uint8_t* channels, uint8_t offset, uint8_t length);
 
+  // write to the physical channels, marks them dirty only if the value changes
+  void writeChannels(uint32_t channel, const uint8_t* channels, uint8_t length) {
+    uint8_t* target = &layerP->lights.channelsE[channel];
+    if (memcmp(target, channels, length) == 0) return;
+    memcpy(target, channels, length);
+    layerP->dirty.mark(channel, length);
+  }
+
   CRGB getRGB(const uint16_t indexV) { return getLight<CRGB>(indexV, layerP->lights.header.offsetRGB); }
-  CRGB getRGB(Coord3D pos) { return getRGB(XYZ(pos)); }
+  CRGB getRGB(const Coord3D& pos) { return getRGB(XYZ(pos)); }
 
   void addRGB(const Coord3D& position, const CRGB& color) { setRGB(position, getRGB(position) + color); }
 
   void blendColor(const uint16_t indexV, const CRGB& color, uint8_t blendAmount) { setRGB(indexV, blend(color, getRGB(indexV), blendAmount)); }
-  void blendColor(Coord3D position, const CRGB& color, const uint8_t blendAmount) { blendColor(XYZ(position), color, blendAmount); }
+  void blendColor(const Coord3D& position, const CRGB& color, const uint8_t blendAmount) { blendColor(XYZ(position), color, blendAmount); }
 
   uint8_t getWhite(const uint16_t indexV) { return getLight<uint8_t>(indexV, layerP->lights.header.offsetWhite); }
-  uint8_t getWhite(Coord3D pos) { return getWhite(XYZ(pos)); }
+  uint8_t getWhite(const Coord3D& pos) { return getWhite(XYZ(pos)); }
 
   CRGB getRGB1(const uint16_t indexV) { return getLight<CRGB>(indexV, layerP->lights.header.offsetRGB1); }
-  CRGB getRGB1(Coord3D pos) { return getRGB1(XYZ(pos)); }
+  CRGB getRGB1(const Coord3D& pos) { return getRGB1(XYZ(pos)); }
 
   CRGB getRGB2(const uint16_t indexV) { return getLight<CRGB>(indexV, layerP->lights.header.offsetRGB2); }
-  CRGB getRGB2(Coord3D pos) { return getRGB2(XYZ(pos)); }
+  CRGB getRGB2(const Coord3D& pos) { return getRGB2(XYZ(pos)); }
 
   CRGB getRGB3(const uint16_t indexV) { return getLight<CRGB>(indexV, layerP->lights.header.offsetRGB3); }
-  CRGB getRGB3(Coord3D pos) { return getRGB3(XYZ(pos)); }
+  CRGB getRGB3(const Coord3D& pos) { return getRGB3(XYZ(pos)); }
 
   template <typename T>
   T getLight(const uint16_t indexV, uint8_t offset) const;
@@ -231,7 +271,9 @@ class VirtualLayer {
     }
   }
 
-  void blur2d(fract8 blur_amount) {
+  // optional: cosmetic only, left out when the frame is behind schedule (deadline pacing, see FrameScheduler.h)
+  void blur2d(fract8 blur_amount, bool optional = false) {
+    if (optional && layerP->frameScheduler.skipOptional) return;
     blurRows(size.x, size.y, blur_amount);
     blurColumns(size.x, size.y, blur_amount);
   }
@@ -280,13 +322,13 @@ class VirtualLayer {
     }
   }
 
-  void drawLine(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, CRGB color, bool soft = false, uint8_t depth = UINT8_MAX);
+  void drawLine(int x0, int y0, int x1, int y1, CRGB color, bool soft = false, uint8_t depth = UINT8_MAX);
 
-  void drawLine3D(const Coord3D& a, Coord3D b, CRGB color, bool soft = false, uint8_t depth = UINT8_MAX) { drawLine3D(a.x, a.y, a.z, b.x, b.y, b.z, color, soft, depth); }
+  void drawLine3D(const Coord3D& a, const Coord3D& b, CRGB color, bool soft = false, uint8_t depth = UINT8_MAX) { drawLine3D(a.x, a.y, a.z, b.x, b.y, b.z, color, soft, depth); }
   // to do: merge with drawLine to support 2D and 3D
-  void drawLine3D(uint8_t x1, uint8_t y1, uint8_t z1, uint8_t x2, uint8_t y2, uint8_t z2, CRGB color, bool soft = false, uint8_t depth = UINT8_MAX);
+  void drawLine3D(int x1, int y1, int z1, int x2, int y2, int z2, CRGB color, bool soft = false, uint8_t depth = UINT8_MAX);
 
-  void drawCircle(int cx, int cy, uint8_t radius, CRGB col, bool soft);
+  void drawCircle(int cx, int cy, uint16_t radius, CRGB col, bool soft);
 
   // shift is used by drawText indicating which letter it is drawing
   void drawCharacter(unsigned char chr, int x = 0, int y = 0, uint8_t font = 0, CRGB col = CRGB::Red, uint16_t shiftPixel = 0, uint16_t shiftChr = 0);
@@ -79,10 +79,12 @@ class ModuleChannels : public Module {
         uint16_t select = updatedItem.value["select"];
         uint8_t value = updatedItem.value["action"] == "mouseenter" ? 255 : 0;
         if (view == 0) {  // physical layer
-          if (group)
-            for (uint8_t i = 0; i < layerP.lights.header.channelsPerLight; i++) layerP.lights.channelsE[select * layerP.lights.header.channelsPerLight + i] = value;
-          else
-            layerP.lights.channelsE[select] = value;
+          uint32_t channel = group ? select * layerP.lights.header.channelsPerLight : select;
+          uint8_t length = group ? layerP.lights.header.channelsPerLight : 1;
+          if (channel + length <= layerP.lights.header.nrOfChannels) {  // select can be from before a layout change
+            memset(&layerP.lights.channelsE[channel], value, length);
+            layerP.dirty.mark(channel, length);  // the written range, so seeding and the drivers take it
+          }
         } else {
           if (group)
             for (uint8_t i = 0; i < layerP.lights.header.channelsPerLight; i++) layerP.layers[view - 1]->setLight(select, &value, i, 1);
@@ -38,7 +38,8 @@ class ModuleDrivers : public NodeManager {
       memset(layerP.ledPins, UINT8_MAX, sizeof(layerP.ledPins));
 
       layerP.maxPower = state.data["maxPower"];
-      EXT_LOGD(ML_TAG, "maxPower %d", layerP.maxPower);
+      layerP.maxCurrentPerPin = state.data["maxCurrentPerPin"];
+      EXT_LOGD(ML_TAG, "maxPower %d maxCurrentPerPin %d", layerP.maxPower, layerP.maxCurrentPerPin);
 
       // assign pins (valid only)
       for (JsonObject pinObject : state.data["pins"].as<JsonArray>()) {
@@ -73,31 +74,46 @@ class ModuleDrivers : public NodeManager {
     nodes = &layerP.nodes;
     NodeManager::begin();
 
-    _moduleIO->addUpdateHandler([this](const String& originId) { readPins(); }, false);
+    for (const char* topic : {"inputoutput/pins", "inputoutput/maxPower", "inputoutput/maxCurrentPerPin"}) updateBus.subscribe(topic, [this](const char* topic, const char* originId) { readPins(); }, "Drivers pins");
+    updateBus.subscribe("inputoutput/boardPreset", [this](const char* topic, const char* originId) { definitionChanged(); }, "Drivers board");  // board specific layouts in addNodes
+
+    if (psramFound()) layerP.layoutKey = [this]() { return layoutKey(); };  // layout cache in PSRAM only
   }
 
+  // key of the layout cache (see PhysicalLayer::mapLayout): the nodes, their on state, controls and layoutVersion
+  uint32_t layoutKey() {
+    uint32_t hash = LayoutFile::hashStart;
+    auto hashString = [&hash](const char* string) {
+      if (string) hash = LayoutFile::hash(hash, (const uint8_t*)string, strlen(string) + 1);
+    };
+    read([&](ModuleState& state) {
+      for (JsonObject nodeState : state.data["nodes"].as<JsonArray>()) {
+        hashString(nodeState["name"]);
+        hashString(nodeState["on"].as<bool>() ? "on" : "off");
+        for (JsonObject control : nodeState["controls"].as<JsonArray>()) {
+          if (control["ro"]) continue;  // status controls are set by the nodes
+          hashString(control["name"]);
+          hashString(control["value"].as<String>().c_str());
+        }
+      }
+    });
+    for (Node* node : layerP.nodes) {
+      uint32_t version = node->layoutVersion();
+      hash = LayoutFile::hash(hash, (const uint8_t*)&version, sizeof(version));
+    }
+    return hash ? hash : 1;  // 0 is no cache
+  }
+
+  // the layouts and drivers, in the order of the UI
+  using Registry = NodeRegistry<
+      // Layouts, most used first
+      PanelLayout, PanelsLayout, CubeLayout, HumanSizedCubeLayout, RingLayout, Rings16Layout, RingsLayout, WheelLayout, SpiralLayout, SingleLineLayout, SingleRowLayout, FileLayout,
+
+      // Drivers, most used first
+      ParallelLEDDriver, FastLEDDriver, ArtNetInDriver, ArtNetOutDriver, SACNInDriver, SACNOutDriver, DMXOutDriver, AudioSyncDriver, FrameRecorderDriver, IRDriver, HUB75Driver>;
+
   void addNodes(const JsonObject& control) override {
-    // Layouts, Most used first
-    addControlValue(control, getNameAndTags<PanelLayout>());
-    addControlValue(control, getNameAndTags<PanelsLayout>());
-    addControlValue(control, getNameAndTags<CubeLayout>());
-    addControlValue(control, getNameAndTags<HumanSizedCubeLayout>());
-    addControlValue(control, getNameAndTags<RingLayout>());
-    addControlValue(control, getNameAndTags<Rings16Layout>());
-    addControlValue(control, getNameAndTags<RingsLayout>());
-    addControlValue(control, getNameAndTags<WheelLayout>());
-    addControlValue(control, getNameAndTags<SpiralLayout>());
-    addControlValue(control, getNameAndTags<SingleLineLayout>());
-    addControlValue(control, getNameAndTags<SingleRowLayout>());
-
-    // Drivers, Most used first
-    addControlValue(control, getNameAndTags<ParallelLEDDriver>());
-    addControlValue(control, getNameAndTags<FastLEDDriver>());
-    addControlValue(control, getNameAndTags<ArtNetInDriver>());
-    addControlValue(control, getNameAndTags<ArtNetOutDriver>());
-    addControlValue(control, getNameAndTags<AudioSyncDriver>());
-    addControlValue(control, getNameAndTags<IRDriver>());
-    addControlValue(control, getNameAndTags<HUB75Driver>());
+    for (const NodeEntry& entry : Registry()) addControlValue(control, entry.nameAndTags());
 
     // board preset specific
     _moduleIO->read([&](ModuleState& state) {
@@ -108,35 +124,13 @@ class ModuleDrivers : public NodeManager {
   }
 
   Node* addNode(const uint8_t index, const char* name, const JsonArray& controls) const override {
-    Node* node = nullptr;
-
-    // Layouts, most used first
-    if (!node) node = checkAndAlloc<PanelLayout>(name);
-    if (!node) node = checkAndAlloc<PanelsLayout>(name);
-    if (!node) node = checkAndAlloc<CubeLayout>(name);
-    if (!node) node = checkAndAlloc<RingLayout>(name);
-    if (!node) node = checkAndAlloc<Rings16Layout>(name);
-    if (!node) node = checkAndAlloc<RingsLayout>(name);
-    if (!node) node = checkAndAlloc<WheelLayout>(name);
-    if (!node) node = checkAndAlloc<SpiralLayout>(name);
-    if (!node) node = checkAndAlloc<HumanSizedCubeLayout>(name);
-    if (!node) node = checkAndAlloc<SingleLineLayout>(name);
-    if (!node) node = checkAndAlloc<SingleRowLayout>(name);
-
-    // Drivers most used first
-    if (!node) node = checkAndAlloc<ParallelLEDDriver>(name);
-    if (!node) node = checkAndAlloc<FastLEDDriver>(name);
-    if (!node) node = checkAndAlloc<ArtNetInDriver>(name);
-    if (!node) node = checkAndAlloc<ArtNetOutDriver>(name);
-    if (!node) node = checkAndAlloc<AudioSyncDriver>(name);
-    if (!node) node = checkAndAlloc<IRDriver>(name);
-    if (!node) node = checkAndAlloc<HUB75Driver>(name);
+    Node* node = Registry::alloc(name);
 
     // board preset specific
     _moduleIO->read([&](ModuleState& state) {
       uint8_t boardPreset = state.data["boardPreset"];
-      if (!node && boardPreset == board_SE16V1) node = checkAndAlloc<SE16Layout>(name);
-      if (!node && boardPreset == board_LightCrafter16) node = checkAndAlloc<LightCrafter16Layout>(name);
+      if (!node && boardPreset == board_SE16V1) node = NodeRegistry<SE16Layout>::alloc(name);
+      if (!node && boardPreset == board_LightCrafter16) node = NodeRegistry<LightCrafter16Layout>::alloc(name);
     });
 
   #if FT_LIVESCRIPT
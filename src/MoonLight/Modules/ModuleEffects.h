@@ -76,86 +76,35 @@ class ModuleEffects : public NodeManager {
     NodeManager::setupDefinition(controls);
   }
 
-  void addNodes(const JsonObject& control) override {
-    // keep the order the same as in https://moonmodules.org/MoonLight/moonlight/effects
-
-    // MoonLight effects, Solid first then alphabetically
-    addControlValue(control, getNameAndTags<SolidEffect>());
-    addControlValue(control, getNameAndTags<AudioRingsEffect>());
-    addControlValue(control, getNameAndTags<LinesEffect>());
-    addControlValue(control, getNameAndTags<FireEffect>());
-    addControlValue(control, getNameAndTags<FixedRectangleEffect>());
-    addControlValue(control, getNameAndTags<ParticlesEffect>());
-    addControlValue(control, getNameAndTags<PraxisEffect>());
+  // the effects and modifiers, in the order of the UI
+  // keep the order the same as in https://moonmodules.org/MoonLight/moonlight/effects
+  using Registry = NodeRegistry<
+      // MoonLight effects, Solid first then alphabetically
+      SolidEffect, AudioRingsEffect, LinesEffect, FireEffect, FixedRectangleEffect, FramePlayerEffect, ParticlesEffect, PraxisEffect,
   #if USE_M5UNIFIED
-    addControlValue(control, getNameAndTags<MoonManEffect>());
+      MoonManEffect,
   #endif
-    addControlValue(control, getNameAndTags<FreqSawsEffect>());
-    addControlValue(control, getNameAndTags<MarioTestEffect>());
-    addControlValue(control, getNameAndTags<PixelMapEffect>());
-    addControlValue(control, getNameAndTags<RandomEffect>());
-    addControlValue(control, getNameAndTags<RingRandomFlowEffect>());
-    addControlValue(control, getNameAndTags<RipplesEffect>());
-    addControlValue(control, getNameAndTags<RubiksCubeEffect>());
-    addControlValue(control, getNameAndTags<ScrollingTextEffect>());
-    addControlValue(control, getNameAndTags<SinusEffect>());
-    addControlValue(control, getNameAndTags<SphereMoveEffect>());
-    addControlValue(control, getNameAndTags<SpiralFireEffect>());
-    addControlValue(control, getNameAndTags<StarFieldEffect>());
-    addControlValue(control, getNameAndTags<VUMeterEffect>());
-    addControlValue(control, getNameAndTags<WaveEffect>());
+      FreqSawsEffect, MarioTestEffect, PixelMapEffect, RandomEffect, RingRandomFlowEffect, RipplesEffect, RubiksCubeEffect, ScrollingTextEffect, SinusEffect, SphereMoveEffect, SpiralFireEffect,
+      StarFieldEffect, VUMeterEffect, WaveEffect,
 
-    // MoonModules effects, alphabetically
-    addControlValue(control, getNameAndTags<GameOfLifeEffect>());
-    addControlValue(control, getNameAndTags<GEQ3DEffect>());
-    addControlValue(control, getNameAndTags<PaintBrushEffect>());
+      // MoonModules effects, alphabetically
+      GameOfLifeEffect, GEQ3DEffect, PaintBrushEffect,
 
-    // WLED effects, alphabetically
-    addControlValue(control, getNameAndTags<BlackholeEffect>());
-    addControlValue(control, getNameAndTags<BouncingBallsEffect>());
-    addControlValue(control, getNameAndTags<BlurzEffect>());
-    addControlValue(control, getNameAndTags<DistortionWavesEffect>());
-    addControlValue(control, getNameAndTags<DJLightEffect>());
-    addControlValue(control, getNameAndTags<DNAEffect>());
-    addControlValue(control, getNameAndTags<DripEffect>());
-    addControlValue(control, getNameAndTags<FreqMatrixEffect>());
-    addControlValue(control, getNameAndTags<FireworksEffect>());
-    addControlValue(control, getNameAndTags<FlowEffect>());
-    addControlValue(control, getNameAndTags<FrizzlesEffect>());
-    addControlValue(control, getNameAndTags<FunkyPlankEffect>());
-    addControlValue(control, getNameAndTags<GEQEffect>());
-    addControlValue(control, getNameAndTags<HeartBeatEffect>());
-    addControlValue(control, getNameAndTags<LissajousEffect>());
-    addControlValue(control, getNameAndTags<Noise2DEffect>());
-    addControlValue(control, getNameAndTags<NoiseMeterEffect>());
-    addControlValue(control, getNameAndTags<OctopusEffect>());
-    addControlValue(control, getNameAndTags<PacManEffect>());
-    addControlValue(control, getNameAndTags<PopCornEffect>());
-    addControlValue(control, getNameAndTags<RainEffect>());
-    addControlValue(control, getNameAndTags<TetrixEffect>());
-    addControlValue(control, getNameAndTags<WaverlyEffect>());
+      // WLED effects, alphabetically
+      BlackholeEffect, BouncingBallsEffect, BlurzEffect, DistortionWavesEffect, DJLightEffect, DNAEffect, DripEffect, FreqMatrixEffect, FireworksEffect, FlowEffect, FrizzlesEffect,
+      FunkyPlankEffect, GEQEffect, HeartBeatEffect, LissajousEffect, Noise2DEffect, NoiseMeterEffect, OctopusEffect, PacManEffect, PopCornEffect, RainEffect, TetrixEffect, WaverlyEffect,
 
-    // FastLED effects
-    addControlValue(control, getNameAndTags<RainbowEffect>());
+      // FastLED effects
+      RainbowEffect,
 
-    // Moving head effects, alphabetically
-    addControlValue(control, getNameAndTags<AmbientMoveEffect>());
-    addControlValue(control, getNameAndTags<FreqColorsEffect>());
-    addControlValue(control, getNameAndTags<Troy1ColorEffect>());
-    addControlValue(control, getNameAndTags<Troy1MoveEffect>());
-    addControlValue(control, getNameAndTags<Troy2ColorEffect>());
-    addControlValue(control, getNameAndTags<Troy2MoveEffect>());
-    addControlValue(control, getNameAndTags<WowiMoveEffect>());
+      // Moving head effects, alphabetically
+      AmbientMoveEffect, FreqColorsEffect, Troy1ColorEffect, Troy1MoveEffect, Troy2ColorEffect, Troy2MoveEffect, WowiMoveEffect,
 
-    // Modifiers, most used first
-    addControlValue(control, getNameAndTags<MultiplyModifier>());
-    addControlValue(control, getNameAndTags<MirrorModifier>());
-    addControlValue(control, getNameAndTags<TransposeModifier>());
-    addControlValue(control, getNameAndTags<CircleModifier>());
-    addControlValue(control, getNameAndTags<RotateModifier>());
-    addControlValue(control, getNameAndTags<CheckerboardModifier>());
-    addControlValue(control, getNameAndTags<PinwheelModifier>());
-    addControlValue(control, getNameAndTags<RippleYZModifier>());
+      // Modifiers, most used first
+      MultiplyModifier, MirrorModifier, TransposeModifier, CircleModifier, RotateModifier, CheckerboardModifier, PinwheelModifier, RippleYZModifier>;
+
+  void addNodes(const JsonObject& control) override {
+    for (const NodeEntry& entry : Registry()) addControlValue(control, entry.nameAndTags());
 
     // find all the .sc files on FS
     File rootFolder = ESPFS.open("/");
@@ -169,88 +118,7 @@ class ModuleEffects : public NodeManager {
   }
 
   Node* addNode(const uint8_t index, const char* name, const JsonArray& controls) const override {
-    Node* node = nullptr;
-
-    // MoonLight effects, Solid first then alphabetically
-    if (!node) node = checkAndAlloc<SolidEffect>(name);
-    if (!node) node = checkAndAlloc<AudioRingsEffect>(name);
-    if (!node) node = checkAndAlloc<FireEffect>(name);
-
-    if (!node) node = checkAndAlloc<FixedRectangleEffect>(name);
-    if (!node) node = checkAndAlloc<FreqSawsEffect>(name);
-    if (!node) node = checkAndAlloc<LinesEffect>(name);
-    if (!node) node = checkAndAlloc<MarioTestEffect>(name);
-  #if USE_M5UNIFIED
-    if (!node) node = checkAndAlloc<MoonManEffect>(name);
-  #endif
-    if (!node) node = checkAndAlloc<ParticlesEffect>(name);
-    if (!node) node = checkAndAlloc<PraxisEffect>(name);
-    if (!node) node = checkAndAlloc<PixelMapEffect>(name);
-    if (!node) node = checkAndAlloc<RandomEffect>(name);
-    if (!node) node = checkAndAlloc<RingRandomFlowEffect>(name);
-    if (!node) node = checkAndAlloc<RipplesEffect>(name);
-    if (!node) node = checkAndAlloc<RubiksCubeEffect>(name);
-    if (!node) node = checkAndAlloc<ScrollingTextEffect>(name);
-    if (!node) node = checkAndAlloc<SinusEffect>(name);
-    if (!node) node = checkAndAlloc<SphereMoveEffect>(name);
-    if (!node) node = checkAndAlloc<StarFieldEffect>(name);
-    if (!node) node = checkAndAlloc<WaveEffect>(name);
-    if (!node) node = checkAndAlloc<SpiralFireEffect>(name);
-    if (!node) node = checkAndAlloc<VUMeterEffect>(name);
-
-    // MoonModules effects, alphabetically
-    if (!node) node = checkAndAlloc<GameOfLifeEffect>(name);
-    if (!node) node = checkAndAlloc<GEQ3DEffect>(name);
-    if (!node) node = checkAndAlloc<PaintBrushEffect>(name);
-
-    // WLED effects, alphabetically
-    if (!node) node = checkAndAlloc<BlackholeEffect>(name);
-    if (!node) node = checkAndAlloc<BouncingBallsEffect>(name);
-    if (!node) node = checkAndAlloc<BlurzEffect>(name);
-    if (!node) node = checkAndAlloc<DistortionWavesEffect>(name);
-    if (!node) node = checkAndAlloc<DJLightEffect>(name);
-    if (!node) node = checkAndAlloc<DNAEffect>(name);
-    if (!node) node = checkAndAlloc<DripEffect>(name);
-    if (!node) node = checkAndAlloc<FireworksEffect>(name);
-    if (!node) node = checkAndAlloc<FlowEffect>(name);
-    if (!node) node = checkAndAlloc<FreqMatrixEffect>(name);
-    if (!node) node = checkAndAlloc<FrizzlesEffect>(name);
-    if (!node) node = checkAndAlloc<FunkyPlankEffect>(name);
-    if (!node) node = checkAndAlloc<GEQEffect>(name);
-    if (!node) node = checkAndAlloc<HeartBeatEffect>(name);
-    if (!node) node = checkAndAlloc<LissajousEffect>(name);
-    if (!node) node = checkAndAlloc<Noise2DEffect>(name);
-    if (!node) node = checkAndAlloc<NoiseMeterEffect>(name);
-    if (!node) node = checkAndAlloc<OctopusEffect>(name);
-    if (!node) node = checkAndAlloc<PacManEffect>(name);
-    if (!node) node = checkAndAlloc<PopCornEffect>(name);
-    if (!node) node = checkAndAlloc<RainEffect>(name);
-    if (!node) node = checkAndAlloc<TetrixEffect>(name);
-    if (!node) node = checkAndAlloc<WaverlyEffect>(name);
-
-    // FastLED
-    if (!node) node = checkAndAlloc<RainbowEffect>(name);
-
-    // Moving head effects, alphabetically
-
-    if (!node) node = checkAndAlloc<AmbientMoveEffect>(name);
-    if (!node) node = checkAndAlloc<FreqColorsEffect>(name);
-    if (!node) node = checkAndAlloc<Troy1ColorEffect>(name);
-    if (!node) node = checkAndAlloc<Troy1MoveEffect>(name);
-    if (!node) node = checkAndAlloc<Troy2ColorEffect>(name);
-    if (!node) node = checkAndAlloc<Troy2MoveEffect>(name);
-    if (!node) node = checkAndAlloc<WowiMoveEffect>(name);
-
-    // Modifiers, most used first
-
-    if (!node) node = checkAndAlloc<MultiplyModifier>(name);
-    if (!node) node = checkAndAlloc<MirrorModifier>(name);
-    if (!node) node = checkAndAlloc<TransposeModifier>(name);
-    if (!node) node = checkAndAlloc<CircleModifier>(name);
-    if (!node) node = checkAndAlloc<RotateModifier>(name);
-    if (!node) node = checkAndAlloc<CheckerboardModifier>(name);
-    if (!node) node = checkAndAlloc<PinwheelModifier>(name);
-    if (!node) node = checkAndAlloc<RippleYZModifier>(name);
+    Node* node = Registry::alloc(name);
 
   #if FT_LIVESCRIPT
     if (!node) {
@@ -14,6 +14,9 @@
 
 #if FT_MOONLIGHT
 
+  #include <algorithm>
+  #include <mutex>
+
   #include "FastLED.h"
   #include "ModuleEffects.h"
   #include "MoonBase/Module.h"
@@ -69,7 +72,9 @@ class ModuleLightsControl : public Module {
   }
 
   void begin() override {
+    readPaletteFiles();  // before the palette is read from the state
     Module::begin();
+    resolvePaletteFile();  // palette files added or removed while off
 
     EXT_LOGI(ML_TAG, "Lights:%d(Header:%d) L-H:%d Node:%d PL:%d(PL-L:%d) VL:%d PM:%d C3D:%d", sizeof(Lights), sizeof(LightsHeader), sizeof(Lights) - sizeof(LightsHeader), sizeof(Node), sizeof(PhysicalLayer), sizeof(PhysicalLayer) - sizeof(Lights), sizeof(VirtualLayer), sizeof(PhysMap), sizeof(Coord3D));
 
@@ -78,27 +83,20 @@ class ModuleLightsControl : public Module {
     setPresetsFromFolder();  // set the right values during boot
 
     // update presets if files changed in presets folder
-    _fileManager->addUpdateHandler([this](const String& originId) {
-      EXT_LOGV(ML_TAG, "FileManager::updateHandler %s", originId.c_str());
-      // read the file state (read all files and folders on FS and collect changes)
-      _fileManager->read([&](FilesState& filesState) {
-        // loop over all changed files (normally only one)
-        bool presetChanged = false;
-        for (auto updatedItem : filesState.updatedItems) {
-          // if file is the current live script, recompile it (to do: multiple live effects)
-          EXT_LOGV(ML_TAG, "updateHandler updatedItem %s", updatedItem.c_str());
-          if (strstr(updatedItem.c_str(), "/.config/presets")) {
-            EXT_LOGV(ML_TAG, " preset.json updated -> call update %s", updatedItem.c_str());
-            presetChanged = true;
-          }
-        }
-        if (presetChanged) {
-          EXT_LOGV(ML_TAG, "setPresetsFromFolder");
-          setPresetsFromFolder();  // update the presets from the folder
-        }
-      });
-    });
-    moduleIO.addUpdateHandler([this](const String& originId) { readPins(); }, false);
+    _fileManager->onFileChanged("/.config/presets/", [this](const char* path, const char* originId) {
+      EXT_LOGV(ML_TAG, "preset %s updated -> setPresetsFromFolder", path);
+      setPresetsFromFolder();  // update the presets from the folder
+    }, "LightsControl presets");
+    // palette files added, removed or changed
+    _fileManager->onFileChanged("/palettes/", [this](const char* path, const char* originId) {
+      readPaletteFiles();
+      definitionChanged();   // the palette values
+      if (!resolvePaletteFile()) {  // the index of the palette file may have shifted
+        uint8_t palette = _state.data["palette"];
+        if (palette >= nrOfBuiltInPalettes) setPalette(palette);  // the file may have changed
+      }
+    }, "LightsControl palettes");
+    updateBus.subscribe("inputoutput/pins", [this](const char* topic, const char* originId) { readPins(); }, "LightsControl pins");
     readPins();  // initially
 
     // Register handler to react to MQTT settings changes (including enable/disable)
@@ -277,6 +275,10 @@ class ModuleLightsControl : public Module {
     addControlValue(control, "Random");
     addControlValue(control, "MoonModules");
     addControlValue(control, "Orange");
+    {
+      std::lock_guard<std::mutex> lock(paletteFilesMutex);
+      for (const String& name : paletteFiles) addControlValue(control, name.c_str());  // after the built in palettes (nrOfBuiltInPalettes)
+    }
 
     control = addControl(controls, "preset", "pad");
     control["width"] = 8;
@@ -292,6 +294,15 @@ class ModuleLightsControl : public Module {
     control = addControl(controls, "lastPreset", "slider", 1, 64);
     control["default"] = 64;
 
+    // frame pacing of the effects, see FrameScheduler.h
+    control = addControl(controls, "pacing", "select");
+    control["default"] = pacing_free;
+    addControlValue(control, "Free");      // as fast as the drivers take the frames
+    addControlValue(control, "Fixed");     // targetFPS, fixed timestep
+    addControlValue(control, "Deadline");  // targetFPS, skip optional work after an overrun
+    control = addControl(controls, "targetFPS", "number", 0, 240);
+    control["default"] = 50;
+
   #if FT_ENABLED(FT_MONITOR)
     control = addControl(controls, "monitorOn", "checkbox");
     control["default"] = true;
@@ -314,41 +325,17 @@ class ModuleLightsControl : public Module {
         digitalWrite(pinRelayLightsOn, newBri > 0 ? HIGH : LOW);
       };
       layerP.lights.header.brightness = newBri;
+    } else if (updatedItem.name == "pacing") {
+      layerP.frameScheduler.pacing = _state.data["pacing"];
+    } else if (updatedItem.name == "targetFPS") {
+      layerP.frameScheduler.targetFPS = _state.data["targetFPS"];
     } else if (updatedItem.name == "palette") {
-      const size_t nrOfPaletteEntries = sizeof(layerP.palette.entries) / sizeof(CRGB);
-
-      if (updatedItem.value == 0)
-        layerP.palette = CloudColors_p;
-      else if (updatedItem.value == 1)
-        layerP.palette = LavaColors_p;
-      else if (updatedItem.value == 2)
-        layerP.palette = OceanColors_p;
-      else if (updatedItem.value == 3)
-        layerP.palette = ForestColors_p;
-      else if (updatedItem.value == 4)
-        layerP.palette = RainbowColors_p;
-      else if (updatedItem.value == 5)
-        layerP.palette = RainbowStripeColors_p;
-      else if (updatedItem.value == 6)
-        layerP.palette = PartyColors_p;
-      else if (updatedItem.value == 7)
-        layerP.palette = HeatColors_p;
-      else if (updatedItem.value == 8) {
-        for (int i = 0; i < sizeof(layerP.palette.entries) / sizeof(CRGB); i++) {
-          layerP.palette[i] = CHSV(random8(), 255, 255);  // take the max saturation, max brightness of the colorwheel
-        }
-      } else if (updatedItem.value == 9) {  // MoonModules palette
-        for (int i = 0; i < nrOfPaletteEntries; i++) {
-          layerP.palette[i] = CRGB(map(i, 0, nrOfPaletteEntries - 1, 255, 0), map(i, 0, nrOfPaletteEntries - 1, 31, 0), map(i, 0, nrOfPaletteEntries - 1, 0, 255));  // from orange to blue
-        }
-      } else if (updatedItem.value == 10) {  // Orange palette
-        for (int i = 0; i < nrOfPaletteEntries; i++) {
-          layerP.palette[i] = CRGB(255, map(i, 0, nrOfPaletteEntries - 1, 0, 255), 0);  // from red via orange to yellow
-        }
-      } else {
-        layerP.palette = PartyColors_p;  // should never occur
+      setPalette(updatedItem.value);
+      // the name of a palette file is stored next to its index, the index shifts if files are added or removed (see resolvePaletteFile)
+      if (_state.updateOriginId.c_str()[0] != '/') {
+        _state.data["paletteFile"] = paletteFileName(updatedItem.value);
+        markDirty("paletteFile");
       }
-      // layerP.palette = LavaColors_p;
     } else if (updatedItem.name == "preset") {
       // copy /.config/effects.json to the hidden folder /.config/presets/preset[x].json
       // do not set preset at boot...
@@ -359,30 +346,131 @@ class ModuleLightsControl : public Module {
 
         if (updatedItem.value["action"] == "click") {
           updatedItem.value["selected"] = select;  // store the selected preset
+          ModulePersistence::flush("/.config/effects.json");  // pending effects changes and the journal into effects.json
           if (arrayContainsValue(updatedItem.value["list"], select)) {
             copyFile(presetFile.c_str(), "/.config/effects.json");
 
             // trigger notification of update of effects.json
-            _fileManager->update(
-                [&](FilesState& state) {
-                  state.updatedItems.clear();
-                  state.updatedItems.push_back("/.config/effects.json");
-                  return StateUpdateResult::CHANGED;  // notify StatefulService by returning CHANGED
-                },
-                _moduleName);
+            _fileManager->changed("/.config/effects.json", _moduleName);
 
           } else {
             copyFile("/.config/effects.json", presetFile.c_str());
-            setPresetsFromFolder();  // update presets in UI
+            _fileManager->changed(presetFile.c_str(), _moduleName);  // updates presets in UI
           }
         } else if (updatedItem.value["action"] == "dblclick") {
           ESPFS.remove(presetFile.c_str());
-          setPresetsFromFolder();  // update presets in UI
+          _fileManager->changed(presetFile.c_str(), _moduleName);  // updates presets in UI
         }
       }
     }
   }
 
+  static constexpr uint8_t nrOfBuiltInPalettes = 11;  // Cloud .. Orange, the palette files follow
+
+  // names of the gradient palettes in /palettes/ (without .json), sorted so the index of a palette does not depend on the order of the FS.
+  // Replaced in the sveltekit task (file changes), read in the httpd task (setupDefinition, onUpdate): only used with paletteFilesMutex locked
+  std::vector<String> paletteFiles;
+  std::mutex paletteFilesMutex;
+
+  void readPaletteFiles() {
+    std::vector<String> files;
+    File folder = ESPFS.open("/palettes");
+    if (folder && folder.isDirectory()) {
+      walkThroughFiles(folder, [&](File, File file) {
+        String name = file.name();
+        if (!file.isDirectory() && name.endsWith(".json")) files.push_back(name.substring(0, name.length() - 5));
+      });
+      folder.close();
+    }
+    std::sort(files.begin(), files.end());
+    std::lock_guard<std::mutex> lock(paletteFilesMutex);
+    paletteFiles.swap(files);
+    layerP.nrOfPalettes = MIN(nrOfBuiltInPalettes + paletteFiles.size(), UINT8_MAX);  // the values of the palette control
+  }
+
+  // name of the palette file of palette (index of the palette control), empty for built in palettes
+  String paletteFileName(uint8_t index) {
+    std::lock_guard<std::mutex> lock(paletteFilesMutex);
+    if (index < nrOfBuiltInPalettes || (size_t)(index - nrOfBuiltInPalettes) >= paletteFiles.size()) return String();
+    return paletteFiles[index - nrOfBuiltInPalettes];
+  }
+
+  // point palette to the stored palette file (paletteFile) after palette files are added or removed.
+  // If the file is gone Party is shown, paletteFile is kept so the palette comes back if the file is added again. true if palette changed
+  bool resolvePaletteFile() {
+    String name = _state.data["paletteFile"] | "";
+    if (name.isEmpty()) return false;  // built in palette
+    uint8_t index = 6;                 // Party
+    {
+      std::lock_guard<std::mutex> lock(paletteFilesMutex);
+      auto it = std::find(paletteFiles.begin(), paletteFiles.end(), name);
+      if (it != paletteFiles.end() && nrOfBuiltInPalettes + (it - paletteFiles.begin()) <= UINT8_MAX) index = nrOfBuiltInPalettes + (it - paletteFiles.begin());
+    }
+    if (_state.data["palette"] == index) return false;
+    EXT_LOGD(ML_TAG, "palette %s: %d -> %d", name.c_str(), _state.data["palette"].as<uint8_t>(), index);
+    _state.data["palette"] = index;  // not via update: paletteFile stays as is
+    markDirty("palette");
+    setPalette(index);
+    requestUIUpdate = true;
+    return true;
+  }
+
+  // expand palette (index of the palette control) into layerP.palette
+  void setPalette(uint8_t index) {
+    static const TProgmemRGBPalette16* fastLEDPalettes[] = {&CloudColors_p, &LavaColors_p, &OceanColors_p, &ForestColors_p, &RainbowColors_p, &RainbowStripeColors_p, &PartyColors_p, &HeatColors_p};
+
+    if (index < 8)
+      layerP.palette = CRGBPalette16(*fastLEDPalettes[index]);
+    else if (index == 8) {  // Random
+      CRGBPalette16 palette;
+      for (uint8_t i = 0; i < 16; i++) palette[i] = CHSV(random8(), 255, 255);  // take the max saturation, max brightness of the colorwheel
+      layerP.palette = palette;
+    } else if (index == 9) {  // MoonModules palette
+      const uint8_t positions[] = {0, 255};
+      const CRGB colors[] = {CRGB(255, 31, 0), CRGB(0, 0, 255)};  // from orange to blue
+      layerP.palette.setGradient(positions, colors, 2);
+    } else if (index == 10) {  // Orange palette
+      const uint8_t positions[] = {0, 255};
+      const CRGB colors[] = {CRGB(255, 0, 0), CRGB(255, 255, 0)};  // from red via orange to yellow
+      layerP.palette.setGradient(positions, colors, 2);
+    } else {
+      String name = paletteFileName(index);  // copied, the file is loaded without the lock
+      if (name.isEmpty() || !loadPaletteFile(("/palettes/" + name + ".json").c_str())) layerP.palette = CRGBPalette16(PartyColors_p);  // palette file removed
+    }
+  }
+
+  // a gradient palette in the WLED format: {"palette": [position, "RRGGBB", position, "RRGGBB", ...]} or {"palette": [position, r, g, b, ...]}
+  bool loadPaletteFile(const char* path) {
+    File file = ESPFS.open(path, "r");
+    if (!file) return false;
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+    JsonArray stops = doc["palette"];
+    if (error || stops.isNull() || stops.size() < 2) {
+      EXT_LOGW(ML_TAG, "%s: no palette", path);
+      return false;
+    }
+
+    uint8_t positions[32];
+    CRGB colors[32];
+    uint8_t count = 0;
+    bool hex = stops[1].is<const char*>();
+    uint8_t stride = hex ? 2 : 4;
+    for (size_t i = 0; i + stride <= stops.size() && count < 32; i += stride) {
+      positions[count] = stops[i].as<uint8_t>();
+      if (count && positions[count] < positions[count - 1]) positions[count] = positions[count - 1];  // positions should be ascending
+      if (hex)
+        colors[count] = CRGB(strtoul(stops[i + 1] | "0", nullptr, 16));
+      else
+        colors[count] = CRGB(stops[i + 1].as<uint8_t>(), stops[i + 2].as<uint8_t>(), stops[i + 3].as<uint8_t>());
+      count++;
+    }
+    layerP.palette.setGradient(positions, colors, count);
+    EXT_LOGD(ML_TAG, "%s: %d stops", path, count);
+    return true;
+  }
+
   // update _state.data["preset"]["list"] and send update to endpoints
   void setPresetsFromFolder() {
     // loop over all files in the presets folder and add them to the preset array
@@ -439,13 +527,7 @@ class ModuleLightsControl : public Module {
         // EXT_LOGD(ML_TAG, "loading next preset %d ", nextPreset);
 
         // trigger file manager notification of update of effects.json
-        _fileManager->update(
-            [&](FilesState& state) {
-              state.updatedItems.push_back("/.config/effects.json");
-              // EXT_LOGD(ML_TAG, "   preset files %d %s", lastPresetLooped, presetFile.c_str());
-              return StateUpdateResult::CHANGED;  // notify StatefulService by returning CHANGED
-            },
-            _moduleName);
+        _fileManager->changed("/.config/effects.json", _moduleName);
 
         JsonDocument doc;
         JsonObject newState = doc.to<JsonObject>();
@@ -501,9 +583,21 @@ class ModuleLightsControl : public Module {
       read([&](ModuleState& _state) {
         if (_socket->getConnectedClients() && _state.data["monitorOn"]) {
           _socket->emitEvent("monitor", (char*)&layerP.lights.header, 37);                                                                     // sizeof(LightsHeader)); //sizeof(LightsHeader), nearest prime nr above 32 to avoid monitor data to be seen as header
-          _socket->emitEvent("monitor", (char*)layerP.lights.channelsE, MIN(layerP.lights.header.nrOfLights * 3, layerP.lights.maxChannels));  //*3 is for 3 bytes position
+          if (layerP.positionsInRecords) {  // from the layout cache, channelsE keeps the lights
+            size_t size = layerP.lights.header.nrOfLights * layerP.lights.header.positionBytes;
+            uint8_t* positions = allocMB<uint8_t>(size, "positions");
+            if (positions) {
+              xSemaphoreTake(swapMutex, portMAX_DELAY);  // not while a next mapping changes the records
+              bool packed = layerP.lights.header.isPositions == 2;
+              if (packed) layerP.layoutRecords.packPositions(positions, layerP.lights.header.nrOfLights, layerP.lights.header.positionBytes);
+              xSemaphoreGive(swapMutex);
+              if (packed) _socket->emitEvent("monitor", (char*)positions, size);
+              freeMB(positions);
+            }
+          } else
+            _socket->emitEvent("monitor", (char*)layerP.lights.channelsE, MIN(layerP.lights.header.nrOfLights * layerP.lights.header.positionBytes, layerP.lights.maxChannels));  // 3 or 6 bytes per position
         }
-        memset(layerP.lights.channelsE, 0, layerP.lights.maxChannels);  // set all the channels to 0 //cleaning the positions
+        if (!layerP.positionsInRecords) memset(layerP.lights.channelsE, 0, layerP.lights.maxChannels);  // set all the channels to 0 //cleaning the positions
         xSemaphoreTake(swapMutex, portMAX_DELAY);
         EXT_LOGD(ML_TAG, "positions sent to monitor (2 -> 3)");
         layerP.lights.header.isPositions = 3;
@@ -511,8 +605,11 @@ class ModuleLightsControl : public Module {
       });
     } else if (isPositions == 0 && layerP.lights.header.nrOfLights) {  // send to UI
       static unsigned long monitorMillis = 0;
-      if (millis() - monitorMillis >= MAX(20, layerP.lights.header.nrOfLights / 300)) {  // 12K lights -> 40ms
+      static uint32_t monitorChangedFrames = 0;
+      bool changed = layerP.changedFrames != monitorChangedFrames || millis() - monitorMillis >= 1000;  // static lights: once a second, for new clients
+      if (changed && millis() - monitorMillis >= MAX(20, layerP.lights.header.nrOfLights / 300) && !layerP.frameScheduler.skipOptional) {  // 12K lights -> 40ms, not if the effects are behind schedule
         monitorMillis = millis();
+        monitorChangedFrames = layerP.changedFrames;
 
         read([&](ModuleState& _state) {
           if (_socket->getConnectedClients() && _state.data["monitorOn"]) {
@@ -37,53 +37,44 @@ class ModuleLiveScripts : public Module {
     Module::begin();
     #if FT_ENABLED(FT_LIVESCRIPT)
     // create a handler which recompiles the live script when the file of a current running live script changes in the File Manager
-    _fileManager->addUpdateHandler([this](const String& originId) {
-      EXT_LOGV(ML_TAG, "FileManager::updateHandler %s", originId.c_str());
-      // read the file state (read all files and folders on FS and collect changes)
-      _fileManager->read([&](FilesState& filesState) {
-        // loop over all changed files (normally only one)
-        for (auto updatedItem : filesState.updatedItems) {
-          // if file is the current live script, recompile it (to do: multiple live effects)
-          uint8_t index = 0;
-          _moduleEffects->read([&](ModuleState& effectsState) {
-            for (JsonObject nodeState : effectsState.data["nodes"].as<JsonArray>()) {
-              if (updatedItem == nodeState["name"]) {
-                EXT_LOGD(ML_TAG, "updateHandler equals current item -> livescript compile %s", updatedItem.c_str());
-                LiveScriptNode* liveScriptNode = (LiveScriptNode*)_moduleEffects->findLiveScriptNode(nodeState["name"]);
-                if (liveScriptNode) {
-                  liveScriptNode->compileAndRun();
-
-                  // wait until setup has been executed?
-
-                  _moduleEffects->requestUIUpdate = true;  // update the Effects UI
-                }
-
-                EXT_LOGD(ML_TAG, "update due to new node %s done", nodeState["name"].as<const char*>());
-              }
-              index++;
+    _fileManager->onFileChanged("/", [this](const char* path, const char* originId) {
+      // if file is the current live script, recompile it (to do: multiple live effects)
+      EXT_LOGV(ML_TAG, "FileManager changed %s %s", path, originId);
+      _moduleEffects->read([&](ModuleState& effectsState) {
+        for (JsonObject nodeState : effectsState.data["nodes"].as<JsonArray>()) {
+          if (equal(path, nodeState["name"].as<const char*>())) {
+            EXT_LOGD(ML_TAG, "updateHandler equals current item -> livescript compile %s", path);
+            LiveScriptNode* liveScriptNode = (LiveScriptNode*)_moduleEffects->findLiveScriptNode(nodeState["name"]);
+            if (liveScriptNode) {
+              liveScriptNode->compileAndRun();
+
+              // wait until setup has been executed?
+
+              _moduleEffects->requestUIUpdate = true;  // update the Effects UI
             }
-          });
-          _moduleDrivers->read([&](ModuleState& driversState) {
-            for (JsonObject nodeState : driversState.data["nodes"].as<JsonArray>()) {
-              if (updatedItem == nodeState["name"]) {
-                EXT_LOGD(ML_TAG, "updateHandler equals current item -> livescript compile %s", updatedItem.c_str());
-                LiveScriptNode* liveScriptNode = (LiveScriptNode*)_moduleDrivers->findLiveScriptNode(nodeState["name"]);
-                if (liveScriptNode) {
-                  liveScriptNode->compileAndRun();
-
-                  // wait until setup has been executed?
-
-                  _moduleDrivers->requestUIUpdate = true;  // update the Effects UI
-                }
-
-                EXT_LOGD(ML_TAG, "update due to new node %s done", nodeState["name"].as<const char*>());
-              }
-              index++;
+
+            EXT_LOGD(ML_TAG, "update due to new node %s done", nodeState["name"].as<const char*>());
+          }
+        }
+      });
+      _moduleDrivers->read([&](ModuleState& driversState) {
+        for (JsonObject nodeState : driversState.data["nodes"].as<JsonArray>()) {
+          if (equal(path, nodeState["name"].as<const char*>())) {
+            EXT_LOGD(ML_TAG, "updateHandler equals current item -> livescript compile %s", path);
+            LiveScriptNode* liveScriptNode = (LiveScriptNode*)_moduleDrivers->findLiveScriptNode(nodeState["name"]);
+            if (liveScriptNode) {
+              liveScriptNode->compileAndRun();
+
+              // wait until setup has been executed?
+
+              _moduleDrivers->requestUIUpdate = true;  // update the Effects UI
             }
-          });
+
+            EXT_LOGD(ML_TAG, "update due to new node %s done", nodeState["name"].as<const char*>());
+          }
         }
       });
-    });
+    }, "LiveScripts");
     #endif
   }
 
@@ -110,6 +101,16 @@ class ModuleLiveScripts : public Module {
       // addControl(rows, "free", "button");
       addControl(rows, "delete", "button");
     }
+
+    control = addControl(controls, "benchmark", "rows", 0, UINT8_MAX, true);
+    rows = control["n"].to<JsonArray>();
+    {
+      addControl(rows, "script", "text", 0, 32, true);
+      addControl(rows, "native", "text", 0, 32, true);
+      addControl(rows, "scriptMicros", "number", 0, UINT16_MAX, true);
+      addControl(rows, "nativeMicros", "number", 0, UINT16_MAX, true);
+      addControl(rows, "ratio", "text", 0, 32, true);
+    }
   }
 
   // implement business logic
@@ -148,12 +149,14 @@ class ModuleLiveScripts : public Module {
     JsonDocument newData;                                    // to only send updatedData
     JsonArray scripts = newData["scripts"].to<JsonArray>();  // to: remove old array
     LiveScriptNode::getScriptsJson(scripts);
+    addBenchmark(newData["benchmark"].to<JsonArray>());
 
     // only if changed
-    if (_state.data["scripts"] != newData["scripts"]) {
+    if (_state.data["scripts"] != newData["scripts"] || _state.data["benchmark"] != newData["benchmark"]) {
       // UpdatedItem updatedItem;
       // _state.compareRecursive("scripts", _state.data["scripts"], newData["scripts"], updatedItem); //compare and update
       _state.data["scripts"] = newData["scripts"];  // update without compareRecursive -> without handles
+      _state.data["benchmark"] = newData["benchmark"];
       // JsonObject newDataObject = newData.as<JsonObject>();
       // _socket->emitEvent("editor", newDataObject);
 
@@ -183,6 +186,28 @@ class ModuleLiveScripts : public Module {
     // EXT_LOGV(ML_TAG, "livescripts %s", buffer);
   }
 
+ private:
+  // the shipped scripts (misc/livescripts) and the effects they are a script version of
+  static constexpr const char* benchmarkPairs[][2] = {{"E_noise.sc", "Noise2D"}, {"E_octo.sc", "Octopus"}, {"E_lines.sc", "Lines"}, {"E_random.sc", "Random"}};
+
+  // µs per frame of a script and of its native counterpart, if they are in Effects (loopMicros): add both, or one after the other
+  void addBenchmark(JsonArray rows) {
+    for (auto& pair : benchmarkPairs) {
+      Node* script = _moduleEffects->findNode(pair[0]);
+      Node* native = _moduleEffects->findNode(pair[1]);
+      if (!script && !native) continue;
+      JsonObject row = rows.add<JsonObject>();
+      row["script"] = pair[0];
+      row["native"] = pair[1];
+      if (script) row["scriptMicros"] = script->loopMicros;
+      if (native) row["nativeMicros"] = native->loopMicros;
+      if (script && native && native->loopMicros) {
+        Char<16> ratio;
+        ratio.format("%.1fx", (float)script->loopMicros / native->loopMicros);
+        row["ratio"] = (char*)ratio.c_str();  // copy
+      }
+    }
+  }
 };  // class ModuleLiveScripts
 
   #endif
@@ -44,6 +44,10 @@ class ModuleMoonLightInfo : public Module {
       addControl(rows, "mappingTableIndexes#", "number", 0, 65535, true);
       addControl(rows, "nrOfMoreLights", "number", 0, 65535, true);
       addControl(rows, "nodes#", "number", 0, 65535, true);
+      addControl(rows, "arena#", "number", 0, INT32_MAX, true);
+      addControl(rows, "arenaUsed", "number", 0, INT32_MAX, true);
+      addControl(rows, "arenaHoles", "number", 0, INT32_MAX, true);
+      addControl(rows, "arenaFallbacks", "number", 0, 65535, true);
     }
   }
 
@@ -94,6 +98,10 @@ class ModuleMoonLightInfo : public Module {
         data["layers"][index]["mappingTableIndexes#"] = layer->mappingTableIndexesSizeUsed;
         data["layers"][index]["nrOfMoreLights"] = nrOfMoreLights;
         data["layers"][index]["nodes#"] = layer->nodes.size();
+        data["layers"][index]["arena#"] = layer->arena.stats.capacity;
+        data["layers"][index]["arenaUsed"] = layer->arena.stats.used;
+        data["layers"][index]["arenaHoles"] = layer->arena.stats.holes;
+        data["layers"][index]["arenaFallbacks"] = layer->arena.stats.fallbacks;
         index++;
       }
     };
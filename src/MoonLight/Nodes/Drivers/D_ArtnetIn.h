@@ -124,18 +124,7 @@ class ArtNetInDriver : public Node {
           uint8_t* dmxData = packetBuffer + sizeof(ArtNetHeader);
 
           int startPixel = (universe - universeMin) * (512 / layerP.lights.header.channelsPerLight);
-          int numPixels = min((uint16_t)(dataLength / layerP.lights.header.channelsPerLight), (uint16_t)(layerP.lights.header.nrOfLights - startPixel));
-
-          for (int i = 0; i < numPixels; i++) {
-            int ledIndex = startPixel + i;
-            if (ledIndex < layerP.lights.header.nrOfLights) {
-              if (layer == 0) {  // Physical layer
-                memcpy(&layerP.lights.channelsE[ledIndex * layerP.lights.header.channelsPerLight], &dmxData[i * layerP.lights.header.channelsPerLight], layerP.lights.header.channelsPerLight);
-              } else {  // Virtual layer
-                layerP.layers[layer - 1]->setLight(ledIndex, &dmxData[i * layerP.lights.header.channelsPerLight], 0, layerP.lights.header.channelsPerLight);
-              }
-            }
-          }
+          layerP.setLights(layer, startPixel, dmxData, dataLength);
         }
       }
     }
@@ -154,18 +143,7 @@ class ArtNetInDriver : public Node {
       uint8_t* pixelData = packetBuffer + sizeof(DDPHeader);
 
       int startPixel = offset / layerP.lights.header.channelsPerLight;
-      int numPixels = min((uint16_t)(dataLen / layerP.lights.header.channelsPerLight), (uint16_t)(layerP.lights.header.nrOfLights - startPixel));
-
-      for (int i = 0; i < numPixels; i++) {
-        int ledIndex = startPixel + i;
-        if (ledIndex < layerP.lights.header.nrOfLights) {
-          if (layer == 0) {  // Physical layer
-            memcpy(&layerP.lights.channelsE[ledIndex * layerP.lights.header.channelsPerLight], &pixelData[i * layerP.lights.header.channelsPerLight], layerP.lights.header.channelsPerLight);
-          } else {  // Virtual layer
-            layerP.layers[layer - 1]->setLight(ledIndex, &pixelData[i * layerP.lights.header.channelsPerLight], 0, layerP.lights.header.channelsPerLight);
-          }
-        }
-      }
+      layerP.setLights(layer, startPixel, pixelData, dataLen);
     }
   }
 };
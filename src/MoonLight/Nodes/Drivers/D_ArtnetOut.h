@@ -14,6 +14,7 @@
   #include <WiFi.h>
 
   #define ARTNET_CHANNELS_PER_PACKET 512
+  #define ARTNET_REFRESH_INTERVAL 1000  // ms, unchanged universes are sent at least this often
 static const uint8_t ART_NET_HEADER[] = {0x41, 0x72, 0x74, 0x2d, 0x4e, 0x65, 0x74, 0x00, 0x00, 0x50, 0x00, 0x0e};
   // 0..7: Array of 8 characters, the final character is a null termination. Value = 'A' 'r' 't' '-' 'N' 'e' 't' 0x00
   // 8-9: OpOutput Transmitted low byte first (so 0x50, 0x00)
@@ -80,6 +81,13 @@ class ArtNetOutDriver : public DriverNode {
   uint_fast16_t universe = 0;
   uint_fast16_t channels_remaining;
 
+  // unchanged packets (see layerP.dirtyD) are skipped, except in a full frame
+  bool fullFrame = true;
+  unsigned long lastFullMillis = 0;
+  uint32_t outputKey = 0;   // brightness and color correction of the last full frame
+  uint32_t packetStart = 0;  // channels of the lights in the packet
+  uint32_t packetEnd = 0;
+
   bool writePackage() {
     // for (int i=0; i< 18+packetSize;i++) Serial.printf(" %d", packet_buffer[i]);Serial.println();
     // set the parts of the Art-Net packet header that change:
@@ -88,7 +96,7 @@ class ArtNetOutDriver : public DriverNode {
     packet_buffer[16] = packetSize >> 8;  // The length of the DMX512 data array. High Byte
     packet_buffer[17] = packetSize;       // Low Byte of above
 
-    if (!artnetudp.writeTo(packet_buffer, MIN(packetSize, 512) + 18, controllerIP, port)) {
+    if ((fullFrame || layerP.dirtyD.isDirty(packetStart, packetEnd - packetStart)) && !artnetudp.writeTo(packet_buffer, MIN(packetSize, 512) + 18, controllerIP, port)) {
       // Serial.print("🐛");
       return false;  // borked //no connection...
     }
@@ -126,6 +134,14 @@ class ArtNetOutDriver : public DriverNode {
     //   return;
     lastMillis = millis();
 
+    // all packets if the output changes without the channels changing, and regularly as receivers can time out
+    uint32_t key = layerP.powerBrightness | header->red << 8 | header->green << 16 | header->blue << 24;
+    fullFrame = layerP.dither || key != outputKey || millis() - lastFullMillis >= ARTNET_REFRESH_INTERVAL;
+    if (fullFrame) {
+      outputKey = key;
+      lastFullMillis = millis();
+    }
+
     // only need to set once per frame
     packet_buffer[12] = (sequenceNumber++ % 254) + 1;  // The sequence number is used to ensure that ArtDmx packets are used in the correct order, ranging from 1..255
     packet_buffer[13] = 0;                             // The physical input port from which DMX512 data was input
@@ -133,25 +149,24 @@ class ArtNetOutDriver : public DriverNode {
     universe = 0;
     packetSize = 0;
     channels_remaining = channelsPerOutput;
+    OutputStage::Maps maps = outputMaps();
 
     // send all the leds to artnet
-    for (int indexP = 0; indexP < header->nrOfLights; indexP++) {
-      // fill a package
-      memcpy(&packet_buffer[packetSize + 18], &layerP.lights.channelsD[indexP * header->channelsPerLight], header->channelsPerLight);  // set all the channels
-
-      // correct the RGB channels for color order and brightness
-      reOrderAndDimRGBW(&packet_buffer[packetSize + 18 + header->offsetRGB], &layerP.lights.channelsD[indexP * header->channelsPerLight + header->offsetRGB]);
+    for (uint32_t indexP = 0; indexP < header->nrOfLights;) {
+      if (packetSize == 0) packetStart = indexP * header->channelsPerLight;
 
-      if (header->offsetRGB1 != UINT8_MAX) reOrderAndDimRGBW(&packet_buffer[packetSize + 18 + header->offsetRGB1], &layerP.lights.channelsD[indexP * header->channelsPerLight + header->offsetRGB1]);
-      if (header->offsetRGB2 != UINT8_MAX) reOrderAndDimRGBW(&packet_buffer[packetSize + 18 + header->offsetRGB2], &layerP.lights.channelsD[indexP * header->channelsPerLight + header->offsetRGB2]);
-      if (header->offsetRGB3 != UINT8_MAX) reOrderAndDimRGBW(&packet_buffer[packetSize + 18 + header->offsetRGB3], &layerP.lights.channelsD[indexP * header->channelsPerLight + header->offsetRGB3]);
+      // the lights which fit in the package and in the output, in one pass. RGBWYP: one light at a time as they overlap
+      bool mixed = header->lightPreset == 9 && indexP < 72;  // RGBWYP this config assumes a mix of 4 channels and 6 channels per light !!!!
+      uint32_t nrOfLights = mixed ? 1 : MIN(MIN((ARTNET_CHANNELS_PER_PACKET - packetSize) / header->channelsPerLight, channels_remaining / header->channelsPerLight), header->nrOfLights - indexP);
+      if (nrOfLights == 0) nrOfLights = 1;  // a light which does not fit is sent as it always was
 
-      if (header->lightPreset == 9 && indexP < 72)  // RGBWYP this config assumes a mix of 4 channels and 6 channels per light !!!!
-        packetSize += 4;
-      else
-        packetSize += header->channelsPerLight;
+      // fill a package with the channels in wire order, dimmed and color corrected
+      layerP.outputStage.apply(&packet_buffer[packetSize + 18], &layerP.lights.channelsD[indexP * header->channelsPerLight], nrOfLights, indexP * header->channelsPerLight, maps);
 
-      channels_remaining -= header->channelsPerLight;
+      indexP += nrOfLights;
+      packetEnd = indexP * header->channelsPerLight;
+      packetSize += mixed ? 4 : nrOfLights * header->channelsPerLight;
+      channels_remaining -= nrOfLights * header->channelsPerLight;
 
       // if packet_buffer full, or output full, send the buffer
       if (packetSize + header->channelsPerLight > ARTNET_CHANNELS_PER_PACKET || channels_remaining < header->channelsPerLight) {  // next light will not fit in the package, so send what we got
@@ -0,0 +1,179 @@
+/**
+    @title     MoonLight
+    @file      D_DMXOut.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/moonlight/overview/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#if FT_MOONLIGHT
+
+  #include "driver/uart.h"
+
+  #define DMX_CHANNELS_PER_UNIVERSE 512
+  #define DMX_MIN_SLOTS 24       // short packets are padded so break to break stays above 1204µs
+  #define DMX_BAUD_RATE 250000   // 4µs per bit, 44µs per slot (8N2 + start bit)
+  #define DMX_BREAK_BITS 23      // 23 * 4µs = 92µs break (spec min 88µs), generated by the UART after the slots
+  #define DMX_MAB_BITS 3         // 3 * 4µs = 12µs mark after break (spec min 8µs) before the next start code
+  #define DMX_TX_BUFFER 1024     // ring buffer > one full packet so uart_write_bytes_with_break never blocks
+  #define DMX_RX_BUFFER 256      // uart_driver_install requires an RX buffer > SOC_UART_FIFO_LEN
+
+  #ifdef SOC_UART_HP_NUM
+    #define DMX_MAX_UNIVERSES (SOC_UART_HP_NUM - 1)  // UART0 is used for the serial monitor
+  #else
+    #define DMX_MAX_UNIVERSES (SOC_UART_NUM - 1)
+  #endif
+
+// Sends the lights as DMX512 over the RS-485 TX pins defined in the IO module, one universe per pin / UART.
+// The slots are copied in the UART driver ring buffer and shifted out by the UART interrupt, the break is generated by the UART itself.
+// A full universe takes ~23ms on the wire (max ~44 FPS), if a UART is still sending, that universe skips the frame instead of waiting.
+class DMXOutDriver : public DriverNode {
+ public:
+  static const char* name() { return "DMX Out"; }
+  static uint8_t dim() { return _NoD; }
+  static const char* tags() { return "☸️"; }
+
+  Char<32> status = "no RS-485 TX pins";
+
+  void setup() override {
+    DriverNode::setup();
+    addControl(status, "status", "text", 0, 32, true);  // read only
+  }
+
+  uint8_t txPins[DMX_MAX_UNIVERSES];
+  uart_port_t uartNums[DMX_MAX_UNIVERSES];
+  uint8_t nrOfUniverses = 0;
+  uint8_t packet[1 + DMX_CHANNELS_PER_UNIVERSE];  // start code + slots
+
+  void deleteUarts() {
+    for (uint8_t u = 0; u < nrOfUniverses; u++) {
+      if (uart_is_driver_installed(uartNums[u])) uart_driver_delete(uartNums[u]);
+    }
+    nrOfUniverses = 0;
+  }
+
+  bool hasOnLayout() const override { return true; }
+  void onLayout() override {
+    if (layerP.pass != 1 || layerP.monitorPass) return;
+
+    deleteUarts();
+
+    uint8_t pinDE = UINT8_MAX;
+    bool hasRX = false;
+    moduleIO->read([&](ModuleState& state) {
+      for (JsonObject pinObject : state.data["pins"].as<JsonArray>()) {
+        uint8_t usage = pinObject["usage"];
+        uint8_t gpio = pinObject["GPIO"];
+        if (usage == pin_RS485_TX) {
+          if (!GPIO_IS_VALID_OUTPUT_GPIO(gpio))
+            EXT_LOGE(ML_TAG, "gpio %d not valid", gpio);
+          else if (nrOfUniverses < DMX_MAX_UNIVERSES)
+            txPins[nrOfUniverses++] = gpio;
+          else
+            EXT_LOGW(ML_TAG, "No UART left for DMX pin %d (max %d)", gpio, DMX_MAX_UNIVERSES);
+        } else if (usage == pin_RS485_DE) {
+          pinDE = gpio;
+        } else if (usage == pin_RS485_RX) {
+          hasRX = true;
+        }
+      }
+    });
+
+    // the UARTs to use, highest first. UART1 is taken by the RS-485 code in the IO module if TX, RX and DE are assigned (or by anything else which installed a driver on it)
+    uart_port_t freeUarts[DMX_MAX_UNIVERSES];
+    uint8_t nrOfFreeUarts = 0;
+    bool uart1InUse = (hasRX && pinDE != UINT8_MAX) || uart_is_driver_installed(UART_NUM_1);  // ours are deleted above
+    for (int uartNum = DMX_MAX_UNIVERSES; uartNum >= 1; uartNum--) {
+      if (uartNum == UART_NUM_1 && uart1InUse) continue;
+      freeUarts[nrOfFreeUarts++] = (uart_port_t)uartNum;
+    }
+    if (nrOfUniverses > nrOfFreeUarts) {
+      EXT_LOGW(ML_TAG, "No UART left for DMX pins %d..%d (max %d%s)", nrOfFreeUarts + 1, nrOfUniverses, nrOfFreeUarts, uart1InUse ? ", UART1 used by RS-485" : "");
+      nrOfUniverses = nrOfFreeUarts;
+    }
+
+    // the transceiver only sends, so keep it in driver mode
+    if (pinDE != UINT8_MAX && GPIO_IS_VALID_OUTPUT_GPIO(pinDE)) {
+      gpio_set_direction((gpio_num_t)pinDE, GPIO_MODE_OUTPUT);
+      gpio_set_level((gpio_num_t)pinDE, 1);
+    }
+
+    uart_config_t uart_config = {
+        .baud_rate = DMX_BAUD_RATE,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_2,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+
+    Char<32> statusString = "#";
+    statusString += nrOfUniverses;
+    statusString += ":";
+    uint8_t installed = 0;
+    for (uint8_t u = 0; u < nrOfUniverses; u++) {
+      uart_port_t uartNum = freeUarts[u];
+      if (uart_is_driver_installed(uartNum)) uart_driver_delete(uartNum);
+      if (uart_driver_install(uartNum, DMX_RX_BUFFER, DMX_TX_BUFFER, 0, NULL, 0) != ESP_OK || uart_param_config(uartNum, &uart_config) != ESP_OK || uart_set_pin(uartNum, txPins[u], UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK) {
+        EXT_LOGE(ML_TAG, "DMX universe %d: UART%d on pin %d failed", u + 1, uartNum, txPins[u]);
+        if (uart_is_driver_installed(uartNum)) uart_driver_delete(uartNum);
+        continue;
+      }
+      uart_set_tx_idle_num(uartNum, DMX_MAB_BITS);
+
+      // start with a packet without slots so the first real packet is preceded by a break
+      packet[0] = 0;  // start code 0: dimmer data
+      uart_write_bytes_with_break(uartNum, packet, 1, DMX_BREAK_BITS);
+
+      txPins[installed] = txPins[u];
+      uartNums[installed++] = uartNum;
+      EXT_LOGD(ML_TAG, "DMX universe %d: UART%d pin %d", installed, uartNum, txPins[u]);
+
+      Char<12> tmp;
+      tmp.format(" %d", txPins[u]);
+      statusString += tmp;
+    }
+    nrOfUniverses = installed;
+
+    updateControl("status", nrOfUniverses ? statusString.c_str() : "no RS-485 TX pins");
+    moduleNodes->requestUIUpdate = true;
+  }
+
+  void loop() override {
+    if (nrOfUniverses == 0) return;
+
+    DriverNode::loop();
+
+    LightsHeader* header = &layerP.lights.header;
+    uint16_t lightsPerUniverse = DMX_CHANNELS_PER_UNIVERSE / header->channelsPerLight;  // lights are not split over universes
+    OutputStage::Maps maps = outputMaps();
+
+    for (uint8_t u = 0; u < nrOfUniverses; u++) {
+      uint32_t indexP = u * lightsPerUniverse;
+      if (indexP >= header->nrOfLights) break;
+
+      if (uart_wait_tx_done(uartNums[u], 0) != ESP_OK) continue;  // previous packet still on the wire: skip this frame, don't wait
+
+      uint16_t nrOfLights = MIN(lightsPerUniverse, header->nrOfLights - indexP);
+      uint16_t slots = nrOfLights * header->channelsPerLight;
+
+      packet[0] = 0;  // start code
+      // the channels in wire order, dimmed and color corrected
+      layerP.outputStage.apply(&packet[1], &layerP.lights.channelsD[indexP * header->channelsPerLight], nrOfLights, indexP * header->channelsPerLight, maps);
+      if (slots < DMX_MIN_SLOTS) {
+        memset(&packet[1 + slots], 0, DMX_MIN_SLOTS - slots);
+        slots = DMX_MIN_SLOTS;
+      }
+
+      // queued in the ring buffer and sent by the UART interrupt, followed by the break for the next packet
+      uart_write_bytes_with_break(uartNums[u], packet, 1 + slots, DMX_BREAK_BITS);
+    }
+  }
+
+  ~DMXOutDriver() override { deleteUarts(); }
+};
+
+#endif
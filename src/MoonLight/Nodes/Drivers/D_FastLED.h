@@ -57,18 +57,12 @@ class FastLEDDriver : public Node {
     addControl(status, "status", "text", 0, 32, true);
   }
 
-  uint16_t savedMaxPower = UINT16_MAX;
   void loop() override {
     if (FastLED.count()) {
-      if (FastLED.getBrightness() != layerP.lights.header.brightness) {
-        EXT_LOGD(ML_TAG, "setBrightness %d", layerP.lights.header.brightness);
-        FastLED.setBrightness(layerP.lights.header.brightness);
-      }
-
-      if (layerP.maxPower != savedMaxPower) {
-        EXT_LOGD(ML_TAG, "setMaxPower %d watt", layerP.maxPower);
-        FastLED.setMaxPowerInMilliWatts(1000 * layerP.maxPower);  // 5v, 2000mA, to protect usb while developing
-        savedMaxPower = layerP.maxPower;
+      // brightness within the power budget, estimated per frame by layerP.estimatePower (per pin and total)
+      if (FastLED.getBrightness() != layerP.powerBrightness) {
+        EXT_LOGD(ML_TAG, "setBrightness %d", layerP.powerBrightness);
+        FastLED.setBrightness(layerP.powerBrightness);
       }
 
       // FastLED Led Controllers
@@ -559,7 +553,6 @@ class FastLEDDriver : public Node {
       }  // for pinIndex < nrOfPins
     }
 
-    FastLED.setMaxPowerInMilliWatts(1000 * layerP.maxPower);  // 5v, 2000mA, to protect usb while developing
   }
 };
 
@@ -0,0 +1,265 @@
+/**
+    @title     MoonLight
+    @file      D_FrameRecorder.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/moonlight/overview/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#if FT_MOONLIGHT
+
+  #include <atomic>
+
+  #include "FrameCodec.h"
+
+  #define RECORDER_MAX_CATCH_UP 10  // max frames repeated if the drivers were slower than the recording FPS
+  #define RECORDER_RING_SIZE 65536  // write behind buffer with PSRAM, without it 2 frames
+  #define RECORDER_WRITE_CHUNK 4096
+
+// Records the driver channels (channelsD) to a file at a fixed frame rate, played back by the Frame Player effect.
+// Frames are delta compressed (see FrameCodec.h), with a key frame every keyFrameInterval frames to seek.
+// The driver only encodes the frames into a ring buffer, a writer task writes the ring to the file system, so flash erase stalls
+// do not delay the driver task. If the ring is full the frame is recorded as a repeat of the previous frame (4 bytes), and the
+// next frame which fits is a key frame. The driver and the writer hand over with openRequested / closeRequested:
+// the ring and the file are only touched by the driver while the writer is idle.
+class FrameRecorderDriver : public Node {
+ public:
+  static const char* name() { return "Frame Recorder"; }
+  static uint8_t dim() { return _NoD; }
+  static const char* tags() { return "☸️"; }
+
+  bool record = false;
+  Char<32> fileName = "/recording.mlf";
+  uint8_t fps = 40;
+  Char<32> status = "stopped";
+
+  void setup() override {
+    addControl(record, "record", "checkbox");
+    addControl(fileName, "file", "text", 0, 32);
+    addControl(fps, "fps", "number", 1, 100);
+    addControl(status, "status", "text", 0, 32, true);  // read only
+
+    xTaskCreateUniversal(writerTask, "FrameRecorder", 4096, this, 1, &taskHandle, 0);  // low priority, below the effect and driver tasks
+  }
+
+  void onUpdate(const Char<20>& oldValue, const JsonObject& control) override {
+    if (control["name"] == "record" || control["name"] == "file" || control["name"] == "fps") requestRestart = true;  // start / stop in loop, not in the http task
+  }
+
+  // owned by the driver (loop)
+  bool requestRestart = false;
+  bool recording = false;
+  bool keyFrameDue = false;  // a key frame did not fit in the ring
+  FrameCodec::FileHeader header;
+  uint8_t* prevFrame = nullptr;
+  uint8_t* recordBuffer = nullptr;
+  uint32_t frameNr = 0;
+  uint32_t repeatedFrames = 0;  // not recorded as the ring was full
+  unsigned long nextFrameMillis = 0;
+  size_t bytesQueued = 0;
+
+  // shared with the writer task
+  Char<32> filePath;  // set by the driver while the writer is idle
+  File file;          // owned by the writer
+  uint8_t* ring = nullptr;
+  uint32_t ringSize = 0;
+  std::atomic<uint32_t> ringHead = 0;  // bytes queued by the driver
+  std::atomic<uint32_t> ringTail = 0;  // bytes written by the writer
+  std::atomic<bool> fileOpen = false;
+  std::atomic<bool> openRequested = false;
+  std::atomic<bool> closeRequested = false;  // close after the ring is written
+  std::atomic<bool> writeFailed = false;
+
+  TaskHandle_t taskHandle = nullptr;
+  std::atomic<bool> stopTask = false;
+  std::atomic<bool> taskDone = false;
+
+  static void writerTask(void* parameter) { ((FrameRecorderDriver*)parameter)->writer(); }
+
+  void writer() {
+    while (!stopTask) {
+      if (openRequested) {
+        file = ESPFS.open(filePath.c_str(), FILE_WRITE);
+        if (!file) {
+          EXT_LOGE(ML_TAG, "Recorder: could not open %s", filePath.c_str());
+          writeFailed = true;
+        }
+        fileOpen = (bool)file;
+        openRequested = false;
+      }
+      if (fileOpen) {
+        drainRing();
+        if (writeFailed) closeFile();
+      }
+      // a close requested after an open is done after the open (the driver requests them in that order)
+      if (closeRequested && !openRequested && (!fileOpen || ringTail == ringHead)) {
+        if (fileOpen) closeFile();
+        closeRequested = false;
+      }
+      vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    if (fileOpen) {
+      drainRing();
+      closeFile();
+    }
+    taskDone = true;
+    vTaskDelete(NULL);
+  }
+
+  void drainRing() {
+    while (!writeFailed) {
+      uint32_t tail = ringTail;
+      uint32_t index = tail % ringSize;
+      uint32_t chunk = MIN(MIN(ringHead - tail, ringSize - index), RECORDER_WRITE_CHUNK);
+      if (chunk == 0) return;
+      if (file.write(&ring[index], chunk) != chunk) {
+        EXT_LOGE(ML_TAG, "Recorder: write failed, file system full?");
+        writeFailed = true;
+        return;
+      }
+      ringTail = tail + chunk;
+      if (stopTask) return;
+    }
+  }
+
+  void closeFile() {
+    file.close();
+    fileOpen = false;
+    if (fileChanged) fileChanged(filePath.c_str(), "FrameRecorder");  // index the recording in the File Manager
+  }
+
+  bool writerIdle() const { return !openRequested && !closeRequested && !fileOpen; }
+
+  // copy to the ring, false if it does not fit
+  bool ringWrite(const uint8_t* data, uint32_t size) {
+    uint32_t head = ringHead;
+    if (ringSize - (head - ringTail) < size) return false;
+    uint32_t index = head % ringSize;
+    uint32_t first = MIN(size, ringSize - index);
+    memcpy(&ring[index], data, first);
+    memcpy(ring, data + first, size - first);
+    ringHead = head + size;
+    return true;
+  }
+
+  void stop() {
+    if (!recording) return;
+    recording = false;
+    closeRequested = true;  // the writer writes what is left in the ring and closes the file
+    Char<32> statusString;
+    statusString.format("%d frames %dKB", frameNr, bytesQueued / 1024);
+    updateControl("status", writeFailed ? "write failed" : statusString.c_str());
+    moduleNodes->requestUIUpdate = true;
+    EXT_LOGI(ML_TAG, "Recorded %d frames (%d repeated as the file system was behind), %d bytes in %s", frameNr, repeatedFrames, bytesQueued, filePath.c_str());
+  }
+
+  // only while the writer is idle
+  void start() {
+    header = FrameCodec::FileHeader();
+    header.channelsPerLight = layerP.lights.header.channelsPerLight;
+    header.frameInterval = 1000 / fps;
+    header.nrOfChannels = layerP.lights.header.nrOfChannels;
+
+    freeMB(prevFrame);
+    freeMB(recordBuffer);
+    prevFrame = allocMB<uint8_t>(header.nrOfChannels, "recorder");
+    recordBuffer = allocMB<uint8_t>(FrameCodec::maxRecordSize(header.nrOfChannels), "recorder");
+    uint32_t minSize = 2 * FrameCodec::maxRecordSize(header.nrOfChannels);
+    uint32_t neededSize = psramFound() ? MAX(RECORDER_RING_SIZE, minSize) : minSize;
+    if (ringSize != neededSize) {
+      freeMB(ring);
+      ring = allocMB<uint8_t>(neededSize, "recorder");
+      if (!ring && neededSize > minSize) {  // PSRAM full: fewer frames behind
+        neededSize = minSize;
+        ring = allocMB<uint8_t>(neededSize, "recorder");
+      }
+      ringSize = ring ? neededSize : 0;
+    }
+    if (!prevFrame || !recordBuffer || !ring) {
+      EXT_LOGE(ML_TAG, "Recorder: could not start %s", fileName.c_str());
+      updateControl("status", "could not start");
+      moduleNodes->requestUIUpdate = true;
+      return;
+    }
+
+    ringHead = 0;
+    ringTail = 0;
+    ringWrite((uint8_t*)&header, sizeof(header));
+    filePath = fileName;
+    writeFailed = false;
+    openRequested = true;
+
+    recording = true;
+    keyFrameDue = false;
+    frameNr = 0;
+    repeatedFrames = 0;
+    bytesQueued = sizeof(header);
+    nextFrameMillis = millis();
+    updateControl("status", "recording");
+    moduleNodes->requestUIUpdate = true;
+  }
+
+  void loop() override {
+    if (requestRestart) {
+      stop();
+      if (!writerIdle()) return;  // previous recording still being written
+      requestRestart = false;
+      if (record) start();
+    }
+    if (!recording) return;
+
+    if (writeFailed) {
+      stop();
+      return;
+    }
+
+    if (layerP.lights.header.nrOfChannels != header.nrOfChannels) {  // layout changed
+      EXT_LOGW(ML_TAG, "Recorder: number of channels changed, stopped");
+      stop();
+      return;
+    }
+
+    unsigned long now = millis();
+    if ((long)(now - nextFrameMillis) < 0) return;
+    if (now - nextFrameMillis > RECORDER_MAX_CATCH_UP * header.frameInterval) nextFrameMillis = now;  // stalled: don't fill the gap
+
+    // one record per frame slot, so the player can derive the time from the frame number. Repeated frames cost 4 bytes
+    while ((long)(now - nextFrameMillis) >= 0) {
+      bool isKeyFrame = keyFrameDue || frameNr % header.keyFrameInterval == 0;
+      size_t size = FrameCodec::encodeFrame(layerP.lights.channelsD, isKeyFrame ? nullptr : prevFrame, header.nrOfChannels, recordBuffer);
+      if (ringWrite(recordBuffer, size)) {
+        memcpy(prevFrame, layerP.lights.channelsD, header.nrOfChannels);
+        keyFrameDue = false;
+      } else {  // the file system is behind: repeat the previous frame, the next frame which fits is a key frame
+        size = FrameCodec::recordHeaderSize;
+        FrameCodec::writeRecordHeader(recordBuffer, 0, FrameCodec::deltaFrame);
+        if (!ringWrite(recordBuffer, size)) {
+          EXT_LOGE(ML_TAG, "Recorder: file system too slow");
+          stop();
+          return;
+        }
+        keyFrameDue = true;
+        repeatedFrames++;
+      }
+      bytesQueued += size;
+      frameNr++;
+      nextFrameMillis += header.frameInterval;
+    }
+  }
+
+  ~FrameRecorderDriver() override {
+    stop();
+    if (taskHandle) {
+      stopTask = true;
+      while (!taskDone) delay(10);  // the writer uses the ring and the file until it is done
+    }
+    freeMB(prevFrame);
+    freeMB(recordBuffer);
+    freeMB(ring);
+  }
+};
+
+#endif
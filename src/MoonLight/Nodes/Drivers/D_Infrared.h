@@ -35,6 +35,7 @@ class IRDriver : public Node {
   static const char* tags() { return "☸️"; }  // use emojis see https://moonmodules.org/MoonLight/moonlight/overview/#emoji-coding, ☸️ for drivers
 
   uint8_t pinInfrared = UINT8_MAX;
+  UpdateBus::Id pinsSubscription = UpdateBus::none;
   uint8_t irPreset = 1;
 
   void readPins() {
@@ -96,10 +97,12 @@ class IRDriver : public Node {
     addControlValue("Athom");  // see https://www.athom.tech/blank-1/wled-esp32-music-addressable-led-strip-controller
     addControlValue("Luxceo");
 
-    moduleIO->addUpdateHandler([this](const String& originId) { readPins(); }, false);
+    pinsSubscription = updateBus.subscribe("inputoutput/pins", [this](const char* topic, const char* originId) { readPins(); }, "Infrared pins");
     readPins();  // initially
   }
 
+  ~IRDriver() override { updateBus.unsubscribe(pinsSubscription); }  // the subscription calls this
+
   uint32_t codeOn;
   uint32_t codeOff;
   uint32_t codeBrightnessInc;
@@ -358,9 +361,9 @@ class IRDriver : public Node {
       if (nec_repeat == false) {
         if (combined_code == codeOff || combined_code == codeOn) {  // Lights on/off
           newState["lightsOn"] = state.data["lightsOn"].as<bool>() ? false : true;
-        } else if (combined_code == codePaletteInc) {                              // palette increase
-          newState["palette"] = MIN(state.data["palette"].as<uint8_t>() + 1, 11);  // to do: replace 8 with max palette count
-        } else if (combined_code == codePaletteDec) {                              // palette decrease
+        } else if (combined_code == codePaletteInc) {  // palette increase, up to the last palette file
+          newState["palette"] = MIN(state.data["palette"].as<uint8_t>() + 1, layerP.nrOfPalettes - 1);
+        } else if (combined_code == codePaletteDec) {  // palette decrease
           newState["palette"] = MAX(state.data["palette"].as<uint8_t>() - 1, 0);
         } else if (combined_code == codePresetDec) {  // next button - go to previous preset
           newState["preset"] = state.data["preset"];
@@ -0,0 +1,287 @@
+/**
+    @title     MoonLight
+    @file      D_SACNIn.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/moonlight/overview/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#if FT_MOONLIGHT
+
+  #include <lwip/sockets.h>
+
+  // E1.31 (sACN), also used by D_SACNOut.h
+  #define SACN_PORT 5568
+  #define SACN_CHANNELS_PER_UNIVERSE 512
+  #define SACN_DATA_HEADER_SIZE 126  // root layer (38) + framing layer (77) + DMP layer incl. start code (11)
+  #define SACN_VECTOR_ROOT_DATA 0x00000004
+  #define SACN_VECTOR_ROOT_EXTENDED 0x00000008
+  #define SACN_VECTOR_DATA_PACKET 0x00000002
+  #define SACN_VECTOR_EXTENDED_SYNC 0x00000001
+  #define SACN_VECTOR_EXTENDED_DISCOVERY 0x00000002
+  #define SACN_VECTOR_DISCOVERY_LIST 0x00000001
+  #define SACN_DISCOVERY_UNIVERSE 64214
+  #define SACN_OPTION_PREVIEW 0x80
+  #define SACN_OPTION_TERMINATED 0x40
+  #define SACN_SOURCE_TIMEOUT 2500  // ms, E131_NETWORK_DATA_LOSS_TIMEOUT
+  #define SACN_SYNC_TIMEOUT 2500    // ms, no sync packets: show universes as they come in
+  #define SACN_MAX_SOURCES 8        // source slots (one per source per universe) for merging and sync
+
+static const uint8_t SACN_ACN_ID[] = {0x41, 0x53, 0x43, 0x2d, 0x45, 0x31, 0x2e, 0x31, 0x37, 0x00, 0x00, 0x00};  // "ASC-E1.17"
+
+// multicast group of a universe: 239.255.{universe hi}.{universe lo}
+inline uint32_t sacnMulticastAddress(uint16_t universe) { return 0xEFFF0000 | universe; }
+
+class SACNInDriver : public Node {
+ public:
+  static const char* name() { return "sACN In"; }
+  static uint8_t dim() { return _NoD; }
+  static const char* tags() { return "☸️"; }
+
+  bool multicast = true;
+  uint8_t merge = 0;  // HTP
+  uint8_t targetLayer = 1;  // Physical is 0, virtual layer 0 (shown as 1) is 1 by default
+  uint16_t universeMin = 1;
+  uint16_t universeMax = 4;
+
+  void setup() override {
+    addControl(multicast, "multicast", "checkbox");
+    addControl(universeMin, "universeMin", "number", 1, 63999);
+    addControl(universeMax, "universeMax", "number", 1, 63999);
+    addControl(merge, "merge", "select");
+    addControlValue("HTP");  // highest takes precedence, per channel
+    addControlValue("LTP");  // latest takes precedence
+    addControl(targetLayer, "layer", "select");
+    addControlValue("Physical layer");
+    for (uint8_t i = 1; i <= layerP.layers.size(); i++) {  // start with one
+      Char<32> layerName;
+      layerName.format("Layer %d", i);
+      addControlValue(layerName.c_str());
+    }
+  }
+
+  void onUpdate(const Char<20>& oldValue, const JsonObject& control) override {
+    if (control["name"] == "multicast" || control["name"] == "universeMin" || control["name"] == "universeMax") {
+      requestInit = true;  // rejoin the multicast groups in loop, not in the http task
+    }
+  }
+
+  // a source sending a universe. Packets are kept so multiple sources can be merged and synced universes can be shown at once
+  struct Source {
+    uint8_t cid[16];
+    uint16_t universe = 0;  // 0: slot is free
+    uint8_t priority;
+    uint8_t sequence;
+    uint16_t syncAddress;
+    bool pending;  // waiting for a sync packet
+    unsigned long lastMillis;
+    uint16_t nrOfSlots;
+    uint8_t slots[SACN_CHANNELS_PER_UNIVERSE];
+  };
+
+  Source sources[SACN_MAX_SOURCES];
+  uint8_t mergeBuffer[SACN_CHANNELS_PER_UNIVERSE];
+  uint8_t packetBuffer[SACN_DATA_HEADER_SIZE + SACN_CHANNELS_PER_UNIVERSE];
+  int sock = -1;
+  bool requestInit = false;
+  uint32_t localIP = 0;
+  uint16_t joinedSyncAddress = 0;
+  unsigned long lastSyncMillis = 0;
+
+  bool joinGroup(uint16_t universe, bool join = true) {
+    ip_mreq mreq;
+    mreq.imr_multiaddr.s_addr = htonl(sacnMulticastAddress(universe));
+    mreq.imr_interface.s_addr = localIP;
+    if (setsockopt(sock, IPPROTO_IP, join ? IP_ADD_MEMBERSHIP : IP_DROP_MEMBERSHIP, &mreq, sizeof(mreq)) != 0) {
+      EXT_LOGW(ML_TAG, "sACN: %s universe %d failed (max igmp groups?)", join ? "join" : "leave", universe);
+      return false;
+    }
+    return true;
+  }
+
+  // one sync group at a time: the previous one is left, unless it is one of the universes (joined in openSocket)
+  void joinSyncGroup(uint16_t syncAddress) {
+    auto isUniverse = [this](uint16_t address) { return address >= universeMin && address <= universeMax; };
+    if (joinedSyncAddress && !isUniverse(joinedSyncAddress)) joinGroup(joinedSyncAddress, false);
+    joinedSyncAddress = 0;
+    if (isUniverse(syncAddress) || joinGroup(syncAddress)) joinedSyncAddress = syncAddress;
+  }
+
+  void openSocket() {
+    sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+      EXT_LOGE(ML_TAG, "sACN: no socket");
+      return;
+    }
+    int reuse = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(SACN_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);  // unicast and all joined multicast groups
+    if (bind(sock, (sockaddr*)&addr, sizeof(addr)) != 0) {
+      EXT_LOGE(ML_TAG, "sACN: bind port %d failed", SACN_PORT);
+      closeSocket();
+      return;
+    }
+
+    // IGMP join per universe
+    uint8_t joined = 0;
+    if (multicast) {
+      for (uint32_t universe = universeMin; universe <= universeMax; universe++) {
+        if (!joinGroup(universe)) break;
+        joined++;
+      }
+    }
+    joinedSyncAddress = 0;
+
+    EXT_LOGI(ML_TAG, "Listening for sACN on port %d, universes %d-%d (%d multicast)", SACN_PORT, universeMin, universeMax, joined);
+  }
+
+  void closeSocket() {
+    if (sock >= 0) close(sock);  // leaves the multicast groups
+    sock = -1;
+    for (Source& source : sources) source.universe = 0;
+  }
+
+  void loop() override {
+    IPAddress ip = WiFi.localIP() ? WiFi.localIP() : ETH.localIP();
+    if (!ip || requestInit) {
+      if (sock >= 0) {
+        EXT_LOGI(ML_TAG, "Stop Listening for sACN");
+        closeSocket();
+      }
+      requestInit = false;
+      if (!ip) return;
+    }
+
+    if (sock < 0) {
+      localIP = (uint32_t)ip;
+      openSocket();
+      if (sock < 0) return;
+    }
+
+    int packetSize;
+    while ((packetSize = recv(sock, packetBuffer, sizeof(packetBuffer), MSG_DONTWAIT)) > 0) {
+      if (packetSize < 49 || memcmp(&packetBuffer[4], SACN_ACN_ID, sizeof(SACN_ACN_ID)) != 0) continue;
+
+      uint32_t rootVector = get32(18);
+      if (rootVector == SACN_VECTOR_ROOT_DATA && packetSize >= SACN_DATA_HEADER_SIZE && get32(40) == SACN_VECTOR_DATA_PACKET)
+        handleData(packetSize);
+      else if (rootVector == SACN_VECTOR_ROOT_EXTENDED && get32(40) == SACN_VECTOR_EXTENDED_SYNC)
+        handleSync(get16(45));
+      // discovery packets are ignored
+    }
+  }
+
+  // sACN is big endian
+  uint16_t get16(uint16_t offset) { return (packetBuffer[offset] << 8) | packetBuffer[offset + 1]; }
+  uint32_t get32(uint16_t offset) { return ((uint32_t)get16(offset) << 16) | get16(offset + 2); }
+
+  void handleData(int packetSize) {
+    uint16_t universe = get16(113);
+    uint8_t options = packetBuffer[112];
+    if (universe < universeMin || universe > universeMax || (options & SACN_OPTION_PREVIEW)) return;
+    if (packetBuffer[125] != 0 || get16(123) == 0) return;  // only start code 0 (dimmer data), not e.g. 0xDD per channel priority
+
+    uint8_t* cid = &packetBuffer[22];
+    unsigned long now = millis();
+
+    Source* source = nullptr;
+    Source* freeSource = nullptr;
+    for (Source& s : sources) {
+      if (s.universe == universe && memcmp(s.cid, cid, sizeof(s.cid)) == 0) {
+        source = &s;
+        break;
+      }
+      if (!freeSource && (s.universe == 0 || now - s.lastMillis > SACN_SOURCE_TIMEOUT)) freeSource = &s;
+    }
+
+    if (options & SACN_OPTION_TERMINATED) {
+      if (source) {
+        source->universe = 0;
+        applyUniverse(universe);  // the remaining sources take over
+      }
+      return;
+    }
+
+    if (source) {
+      int8_t diff = packetBuffer[111] - source->sequence;
+      if (diff <= 0 && diff > -20) return;  // out of order or duplicate
+    } else {
+      if (!freeSource) return;  // more sources than slots
+      source = freeSource;
+      memcpy(source->cid, cid, sizeof(source->cid));
+      source->universe = universe;
+      EXT_LOGD(ML_TAG, "sACN: new source for universe %d", universe);
+    }
+
+    source->priority = packetBuffer[108];
+    source->syncAddress = get16(109);
+    source->sequence = packetBuffer[111];
+    source->lastMillis = now;
+    source->nrOfSlots = MIN(get16(123) - 1, MIN(packetSize - SACN_DATA_HEADER_SIZE, SACN_CHANNELS_PER_UNIVERSE));
+    memcpy(source->slots, &packetBuffer[SACN_DATA_HEADER_SIZE], source->nrOfSlots);
+
+    if (source->syncAddress && multicast && source->syncAddress != joinedSyncAddress) joinSyncGroup(source->syncAddress);
+
+    // synced: wait for the sync packet, unless no sync packets are coming in
+    source->pending = source->syncAddress && now - lastSyncMillis < SACN_SYNC_TIMEOUT;
+    if (!source->pending) applyUniverse(universe);
+  }
+
+  void handleSync(uint16_t syncAddress) {
+    lastSyncMillis = millis();
+    for (Source& source : sources) {
+      if (source.universe && source.pending && source.syncAddress == syncAddress) {
+        applyUniverse(source.universe);  // clears pending of all sources of this universe
+      }
+    }
+  }
+
+  // merge all live sources of a universe and write it to the lights
+  void applyUniverse(uint16_t universe) {
+    unsigned long now = millis();
+    uint8_t maxPriority = 0;
+    uint8_t nrOfSources = 0;
+    Source* latest = nullptr;
+    for (Source& s : sources) {
+      if (s.universe != universe || now - s.lastMillis > SACN_SOURCE_TIMEOUT) continue;
+      s.pending = false;
+      if (s.priority > maxPriority) {
+        maxPriority = s.priority;
+        nrOfSources = 0;
+        latest = nullptr;
+      }
+      if (s.priority == maxPriority) {
+        nrOfSources++;
+        if (!latest || (long)(s.lastMillis - latest->lastMillis) >= 0) latest = &s;
+      }
+    }
+    if (!latest) return;
+
+    uint8_t* channels = latest->slots;  // one source or LTP: no merge needed
+    uint16_t nrOfChannels = latest->nrOfSlots;
+    if (nrOfSources > 1 && merge == 0) {  // HTP
+      memset(mergeBuffer, 0, sizeof(mergeBuffer));
+      nrOfChannels = 0;
+      for (Source& s : sources) {
+        if (s.universe != universe || s.priority != maxPriority || now - s.lastMillis > SACN_SOURCE_TIMEOUT) continue;
+        for (uint16_t i = 0; i < s.nrOfSlots; i++) mergeBuffer[i] = MAX(mergeBuffer[i], s.slots[i]);
+        nrOfChannels = MAX(nrOfChannels, s.nrOfSlots);
+      }
+      channels = mergeBuffer;
+    }
+
+    int startLight = (universe - universeMin) * (SACN_CHANNELS_PER_UNIVERSE / layerP.lights.header.channelsPerLight);
+    layerP.setLights(targetLayer, startLight, channels, nrOfChannels);
+  }
+
+  ~SACNInDriver() override { closeSocket(); }
+};
+
+#endif
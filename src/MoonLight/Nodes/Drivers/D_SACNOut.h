@@ -0,0 +1,214 @@
+/**
+    @title     MoonLight
+    @file      D_SACNOut.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/moonlight/overview/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#if FT_MOONLIGHT
+
+  #include <AsyncUDP.h>
+
+  // E1.31 constants are defined in D_SACNIn.h
+  #define SACN_MAX_UNIVERSES 256              // per universe sequence numbers
+  #define SACN_DISCOVERY_INTERVAL 10000       // ms, E131_UNIVERSE_DISCOVERY_INTERVAL
+  #define SACN_DISCOVERY_HEADER_SIZE 120      // root layer (38) + framing layer (74) + discovery layer (8)
+  #define SACN_SYNC_PACKET_SIZE 49            // root layer (38) + framing layer (11)
+  #define SACN_DISCOVERY_UNIVERSES_PER_PAGE 512
+
+class SACNOutDriver : public DriverNode {
+ public:
+  static const char* name() { return "sACN Out"; }
+  static uint8_t dim() { return _NoD; }
+  static const char* tags() { return "☸️"; }
+
+  bool multicast = true;
+  Char<32> controllerIP3s = "11";  // unicast only
+  uint16_t universeStart = 1;
+  uint8_t priority = 100;      // 0..200, receivers show the source with the highest priority
+  uint16_t syncUniverse = 0;   // 0: no sync packets
+  uint8_t FPSLimiter = 50;     // default 50 FPS
+
+  void setup() override {
+    DriverNode::setup();
+
+    addControl(multicast, "multicast", "checkbox");
+    addControl(controllerIP3s, "controllerIPs", "text", 0, 32);
+    addControl(universeStart, "universeStart", "number", 1, 63999);
+    addControl(priority, "priority", "number", 0, 200);
+    addControl(syncUniverse, "syncUniverse", "number", 0, 63999);
+    addControl(FPSLimiter, "Limiter", "number", 1, 255, false, "FPS");
+
+    // component identifier and source name: same for all packets of this device
+    uint64_t mac = ESP.getEfuseMac();
+    memcpy(cid, "MoonLight", 10);  // 10 bytes incl. terminator, followed by the 6 byte MAC
+    for (uint8_t i = 0; i < 6; i++) cid[10 + i] = mac >> (8 * i);
+    snprintf(sourceName, sizeof(sourceName), "MoonLight %02X%02X%02X", cid[13], cid[14], cid[15]);
+  }
+
+  uint8_t ipAddresses[16];  // max 16
+  uint8_t nrOfIPAddresses = 0;
+
+  void onUpdate(const Char<20>& oldValue, const JsonObject& control) override {
+    DriverNode::onUpdate(oldValue, control);  // !!
+
+    if (control["name"] == "controllerIPs") {
+      nrOfIPAddresses = 0;
+      controllerIP3s.split(",", [this](const char* token, uint8_t nr) {
+        int ipSegment = atoi(token);
+        if (nrOfIPAddresses < std::size(ipAddresses) && ipSegment >= 0 && ipSegment <= 255) {
+          ipAddresses[nrOfIPAddresses] = ipSegment;
+          nrOfIPAddresses++;
+        } else
+          EXT_LOGW(MB_TAG, "Too many IPs provided (%d) or invalid IP segment: %d ", nrOfIPAddresses, ipSegment);
+      });
+    }
+  }
+
+  // loop variables:
+  uint8_t cid[16];
+  char sourceName[64] = {0};
+  uint8_t packetBuffer[SACN_DATA_HEADER_SIZE + SACN_CHANNELS_PER_UNIVERSE];
+  uint8_t discoveryBuffer[SACN_DISCOVERY_HEADER_SIZE + 2 * SACN_DISCOVERY_UNIVERSES_PER_PAGE];
+  uint8_t sequenceNumbers[SACN_MAX_UNIVERSES] = {0};  // per universe, receivers detect lost and out of order packets per universe
+  uint8_t syncSequenceNumber = 0;
+  uint16_t nrOfUniverses = 0;  // sent in the last frame, for discovery
+  unsigned long lastMillis = 0;
+  unsigned long lastDiscoveryMillis = 0;
+  AsyncUDP sacnUdp;
+
+  // sACN is big endian
+  void set16(uint8_t* buffer, uint16_t offset, uint16_t value) {
+    buffer[offset] = value >> 8;
+    buffer[offset + 1] = value;
+  }
+  void set32(uint8_t* buffer, uint16_t offset, uint32_t value) {
+    set16(buffer, offset, value >> 16);
+    set16(buffer, offset + 2, value);
+  }
+  void setFlagsAndLength(uint8_t* buffer, uint16_t offset, uint16_t packetSize) { set16(buffer, offset, 0x7000 | (packetSize - offset)); }
+
+  void setRootLayer(uint8_t* buffer, uint16_t packetSize, uint32_t vector) {
+    set16(buffer, 0, 0x0010);  // preamble size
+    set16(buffer, 2, 0x0000);  // postamble size
+    memcpy(&buffer[4], SACN_ACN_ID, sizeof(SACN_ACN_ID));
+    setFlagsAndLength(buffer, 16, packetSize);
+    set32(buffer, 18, vector);
+    memcpy(&buffer[22], cid, sizeof(cid));
+  }
+
+  void sendPacket(uint8_t* buffer, uint16_t packetSize, uint16_t universe, IPAddress& unicastIP) {
+    if (multicast) {
+      uint32_t group = sacnMulticastAddress(universe);
+      sacnUdp.writeTo(buffer, packetSize, IPAddress(group >> 24, group >> 16, group >> 8, group), SACN_PORT);
+    } else {
+      for (uint8_t i = 0; i < nrOfIPAddresses; i++) {
+        unicastIP[3] = ipAddresses[i];
+        sacnUdp.writeTo(buffer, packetSize, unicastIP, SACN_PORT);
+      }
+    }
+  }
+
+  void sendUniverse(uint16_t universe, uint16_t nrOfChannels, IPAddress& unicastIP) {
+    uint16_t packetSize = SACN_DATA_HEADER_SIZE + nrOfChannels;
+    setRootLayer(packetBuffer, packetSize, SACN_VECTOR_ROOT_DATA);
+
+    // framing layer
+    setFlagsAndLength(packetBuffer, 38, packetSize);
+    set32(packetBuffer, 40, SACN_VECTOR_DATA_PACKET);
+    memcpy(&packetBuffer[44], sourceName, sizeof(sourceName));
+    packetBuffer[108] = priority;
+    set16(packetBuffer, 109, syncUniverse);
+    packetBuffer[111] = sequenceNumbers[(universe - universeStart) % SACN_MAX_UNIVERSES]++;
+    packetBuffer[112] = 0;  // options
+    set16(packetBuffer, 113, universe);
+
+    // DMP layer
+    setFlagsAndLength(packetBuffer, 115, packetSize);
+    packetBuffer[117] = 0x02;            // vector: set property
+    packetBuffer[118] = 0xa1;            // address type & data type
+    set16(packetBuffer, 119, 0x0000);    // first property address
+    set16(packetBuffer, 121, 0x0001);    // address increment
+    set16(packetBuffer, 123, nrOfChannels + 1);  // property value count, including the start code
+    packetBuffer[125] = 0;               // start code
+
+    sendPacket(packetBuffer, packetSize, universe, unicastIP);
+  }
+
+  void sendSync(IPAddress& unicastIP) {
+    uint8_t sync[SACN_SYNC_PACKET_SIZE];
+    setRootLayer(sync, sizeof(sync), SACN_VECTOR_ROOT_EXTENDED);
+    setFlagsAndLength(sync, 38, sizeof(sync));
+    set32(sync, 40, SACN_VECTOR_EXTENDED_SYNC);
+    sync[44] = syncSequenceNumber++;
+    set16(sync, 45, syncUniverse);
+    set16(sync, 47, 0);  // reserved
+    sendPacket(sync, sizeof(sync), syncUniverse, unicastIP);
+  }
+
+  // lets sACN consoles and visualizers find the universes we send
+  void sendDiscovery() {
+    uint8_t lastPage = nrOfUniverses ? (nrOfUniverses - 1) / SACN_DISCOVERY_UNIVERSES_PER_PAGE : 0;
+    for (uint8_t page = 0; page <= lastPage; page++) {
+      uint16_t first = page * SACN_DISCOVERY_UNIVERSES_PER_PAGE;
+      uint16_t count = MIN(nrOfUniverses - first, SACN_DISCOVERY_UNIVERSES_PER_PAGE);
+      uint16_t packetSize = SACN_DISCOVERY_HEADER_SIZE + 2 * count;
+
+      setRootLayer(discoveryBuffer, packetSize, SACN_VECTOR_ROOT_EXTENDED);
+      setFlagsAndLength(discoveryBuffer, 38, packetSize);
+      set32(discoveryBuffer, 40, SACN_VECTOR_EXTENDED_DISCOVERY);
+      memcpy(&discoveryBuffer[44], sourceName, sizeof(sourceName));
+      set32(discoveryBuffer, 108, 0);  // reserved
+      setFlagsAndLength(discoveryBuffer, 112, packetSize);
+      set32(discoveryBuffer, 114, SACN_VECTOR_DISCOVERY_LIST);
+      discoveryBuffer[118] = page;
+      discoveryBuffer[119] = lastPage;
+      for (uint16_t i = 0; i < count; i++) set16(discoveryBuffer, SACN_DISCOVERY_HEADER_SIZE + 2 * i, universeStart + first + i);  // sorted
+
+      uint32_t group = sacnMulticastAddress(SACN_DISCOVERY_UNIVERSE);
+      sacnUdp.writeTo(discoveryBuffer, packetSize, IPAddress(group >> 24, group >> 16, group >> 8, group), SACN_PORT);
+    }
+  }
+
+  void loop() override {
+    DriverNode::loop();
+
+    LightsHeader* header = &layerP.lights.header;
+
+    IPAddress unicastIP = WiFi.isConnected() ? WiFi.localIP() : ETH.localIP();
+    if (!unicastIP) return;  // if no connection
+    if (!multicast && nrOfIPAddresses == 0) return;
+
+    // skip frames above the limiter instead of delaying, so other drivers keep their own pace
+    if (millis() - lastMillis < 1000 / FPSLimiter) return;
+    lastMillis = millis();
+
+    uint16_t lightsPerUniverse = SACN_CHANNELS_PER_UNIVERSE / header->channelsPerLight;  // lights are not split over universes
+    uint16_t universe = universeStart;
+    OutputStage::Maps maps = outputMaps();
+
+    for (uint32_t indexP = 0; indexP < header->nrOfLights; indexP += lightsPerUniverse) {
+      uint16_t nrOfLights = MIN(lightsPerUniverse, header->nrOfLights - indexP);
+      uint32_t index = indexP * header->channelsPerLight;
+
+      // the channels in wire order, dimmed and color corrected
+      layerP.outputStage.apply(&packetBuffer[SACN_DATA_HEADER_SIZE], &layerP.lights.channelsD[index], nrOfLights, index, maps);
+      sendUniverse(universe++, nrOfLights * header->channelsPerLight, unicastIP);  // the last one can be partially filled
+    }
+
+    nrOfUniverses = universe - universeStart;
+
+    if (syncUniverse) sendSync(unicastIP);  // receivers show all universes of this frame at once
+
+    if (millis() - lastDiscoveryMillis > SACN_DISCOVERY_INTERVAL) {
+      lastDiscoveryMillis = millis();
+      sendDiscovery();
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,84 @@
+/**
+    @title     MoonLight
+    @file      Dither.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/moonlight/overview/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#pragma once
+
+// Temporal dithering of the driver output, used by the drivers which convert the channels themselves (OutputStage, parlio).
+// Each driver keeps its own LUT, the threshold only depends on the frame counter and the channel index (test/test_dither).
+//
+// Brightness and color correction are applied with a LUT giving 8.8 fixed point values instead of 8 bit,
+// the fraction is turned into an on / off pattern over the frames: value 25.3 is shown as 26 in 3 of 10 frames.
+// This keeps fades smooth at low brightness where the 8 bit LUT only has a few levels left.
+//
+// The 8.8 LUT is derived from the 8 bit maps of the leds driver (brightness, color correction and whatever curve the driver applies),
+// so switching dither on or off does not change the colors: the integer part is the 8 bit map value, the fraction rises linearly
+// from one step of the map to the next. The shown value is always the 8 bit value or one above it.
+//
+// The threshold is ordered (bit reversed frame counter, van der Corput) instead of error diffusion:
+// it needs no per channel state, so multiple drivers in the same frame output the same values.
+// Any aligned block of 2^n frames spreads the thresholds evenly, so the average is exact over 256 frames and close after a few.
+
+#include <stdint.h>
+#include <string.h>
+
+namespace Dither {
+
+static const uint8_t spread = 167;  // odd multiplier: neighbouring channels get different thresholds, so they don't switch together
+
+inline uint8_t reverse8(uint8_t b) {
+  b = (b & 0xF0) >> 4 | (b & 0x0F) << 4;
+  b = (b & 0xCC) >> 2 | (b & 0x33) << 2;
+  b = (b & 0xAA) >> 1 | (b & 0x55) << 1;
+  return b;
+}
+
+// 8.8 fixed point output value per color channel: red, green, blue, white
+struct Lut {
+  uint16_t map[4][256];
+  uint8_t source[4][256];  // the 8 bit maps map is built from
+
+  // from the 8 bit maps of the leds driver (red, green, blue, white), only rebuilds if they changed
+  void build(const uint8_t* const maps[4]) {
+    for (uint8_t c = 0; c < 4; c++) {
+      if (memcmp(source[c], maps[c], 256) == 0) continue;
+      memcpy(source[c], maps[c], 256);
+      build(map[c], maps[c]);
+    }
+  }
+
+  // knots where the 8 bit map steps up: between 2 knots the value rises linearly from one step to the next,
+  // after the last knot with the slope of the segment before it. Clamped to the 8 bit value + 1, and 255 is not exceeded
+  static void build(uint16_t* map, const uint8_t* map8) {
+    uint16_t from = 0;                       // knot at the start of the segment
+    uint32_t slope = 0;                      // of the previous segment, 8.8 per input step times 256
+    for (uint16_t to = 1; to <= 256; to++) {  // to: knot at the end of the segment
+      if (to < 256 && map8[to] == map8[to - 1]) continue;
+      if (to < 256) slope = ((uint32_t)(map8[to] - map8[from]) << 16) / (to - from);
+      for (uint16_t i = from; i < to; i++) {
+        uint32_t value = ((uint32_t)map8[from] << 8) + ((slope * (i - from)) >> 8);
+        uint32_t max = map8[i] == 255 ? 0xFF00 : (map8[i] << 8) | 0xFF;
+        map[i] = value > max ? max : value;
+      }
+      from = to;
+    }
+  }
+};
+
+// per frame part of the threshold, call once per frame with an incrementing frame counter
+inline uint8_t frameThreshold(uint8_t frame) { return reverse8(frame); }
+
+// threshold of a channel in this frame (index: channel index in the lights)
+inline uint8_t threshold(uint8_t frameThreshold, uint32_t index) { return frameThreshold ^ (uint8_t)(index * spread); }
+
+// 8.8 value to 8 bits: rounded up if the fraction is above the threshold. 0 stays 0, 255.0 stays 255
+inline uint8_t apply(uint16_t value, uint8_t threshold) { return (value + threshold) >> 8; }
+
+}  // namespace Dither
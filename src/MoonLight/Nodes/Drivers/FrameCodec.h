@@ -0,0 +1,148 @@
+/**
+    @title     MoonLight
+    @file      FrameCodec.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/moonlight/overview/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#pragma once
+
+// Frame recording format used by the Frame Recorder driver and the Frame Player effect.
+// Shared by the recorder and the player, round trips are tested in test/test_frame_codec.
+//
+// File: FileHeader followed by frame records.
+// Record: 4 bytes: payload size (24 bits, little endian) + type, followed by the payload.
+//   key frame: all channels
+//   delta frame: changes to the previous frame as [varint skip][varint count][count channels], repeated.
+//     A frame without changes has an empty payload.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace FrameCodec {
+
+static const uint8_t version = 1;
+static const uint8_t recordHeaderSize = 4;
+static const uint8_t keyFrame = 0;
+static const uint8_t deltaFrame = 1;
+static const uint8_t maxGap = 4;  // equal channels inside a run of changes cost less to copy than to start a new run
+
+struct FileHeader {
+  char magic[4] = {'M', 'L', 'F', 'R'};
+  uint8_t version = FrameCodec::version;
+  uint8_t channelsPerLight = 3;
+  uint16_t frameInterval = 25;   // ms between frames
+  uint32_t nrOfChannels = 0;     // per frame
+  uint16_t keyFrameInterval = 50;  // a key frame every n frames, to seek (later if the file system of the recorder was behind)
+  uint16_t reserved = 0;
+
+  bool isValid() const { return memcmp(magic, "MLFR", 4) == 0 && version == FrameCodec::version && nrOfChannels > 0 && frameInterval > 0; }
+};
+static_assert(sizeof(FileHeader) == 16, "FileHeader is stored as is");
+
+// max size of an encoded record, to size the encode buffer
+inline size_t maxRecordSize(uint32_t nrOfChannels) { return recordHeaderSize + nrOfChannels; }
+
+inline void writeRecordHeader(uint8_t* out, uint32_t payloadSize, uint8_t type) {
+  out[0] = payloadSize;
+  out[1] = payloadSize >> 8;
+  out[2] = payloadSize >> 16;
+  out[3] = type;
+}
+
+inline uint32_t recordPayloadSize(const uint8_t* record) { return record[0] | (record[1] << 8) | ((uint32_t)record[2] << 16); }
+inline uint8_t recordType(const uint8_t* record) { return record[3]; }
+
+inline size_t putVarint(uint8_t* out, uint32_t value) {
+  size_t n = 0;
+  while (value >= 0x80) {
+    out[n++] = value | 0x80;
+    value >>= 7;
+  }
+  out[n++] = value;
+  return n;
+}
+
+inline bool getVarint(const uint8_t*& in, const uint8_t* end, uint32_t& value) {
+  value = 0;
+  for (uint8_t shift = 0; in < end && shift < 32; shift += 7) {
+    uint8_t b = *in++;
+    value |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+// encode frame as a record in out (at least maxRecordSize bytes). prev is the previous frame, nullptr for a key frame.
+// A delta which is not smaller than the frame itself is stored as a key frame. Returns the record size.
+inline size_t encodeFrame(const uint8_t* frame, const uint8_t* prev, uint32_t nrOfChannels, uint8_t* out) {
+  if (prev) {
+    uint8_t* payload = out + recordHeaderSize;
+    size_t size = 0;
+    uint32_t pos = 0;  // first channel not yet encoded
+    uint32_t i = 0;
+    bool smaller = true;
+    while (smaller) {
+      while (i < nrOfChannels && frame[i] == prev[i]) i++;
+      if (i == nrOfChannels) break;
+
+      uint32_t start = i;
+      uint32_t end = i;  // one past the last changed channel of this run
+      while (i < nrOfChannels && i - end <= maxGap) {
+        if (frame[i] != prev[i]) end = i + 1;
+        i++;
+      }
+      i = end;
+
+      uint32_t count = end - start;
+      smaller = size + 10 + count < nrOfChannels;  // 10: max size of the two varints
+      if (!smaller) break;
+      size += putVarint(payload + size, start - pos);
+      size += putVarint(payload + size, count);
+      memcpy(payload + size, frame + start, count);
+      size += count;
+      pos = end;
+    }
+    if (smaller) {
+      writeRecordHeader(out, size, deltaFrame);
+      return recordHeaderSize + size;
+    }
+  }
+
+  writeRecordHeader(out, nrOfChannels, keyFrame);
+  memcpy(out + recordHeaderSize, frame, nrOfChannels);
+  return recordHeaderSize + nrOfChannels;
+}
+
+// apply a record to frame, which holds the previous frame for a delta record. Returns false if the record is corrupt.
+inline bool decodeFrame(const uint8_t* record, uint8_t* frame, uint32_t nrOfChannels) {
+  uint32_t payloadSize = recordPayloadSize(record);
+  const uint8_t* in = record + recordHeaderSize;
+  const uint8_t* end = in + payloadSize;
+
+  if (recordType(record) == keyFrame) {
+    if (payloadSize != nrOfChannels) return false;
+    memcpy(frame, in, nrOfChannels);
+    return true;
+  }
+  if (recordType(record) != deltaFrame) return false;
+
+  uint32_t pos = 0;
+  while (in < end) {
+    uint32_t skip, count;
+    if (!getVarint(in, end, skip) || !getVarint(in, end, count)) return false;
+    pos += skip;
+    if (pos + count > nrOfChannels || in + count > end) return false;
+    memcpy(frame + pos, in, count);
+    in += count;
+    pos += count;
+  }
+  return true;
+}
+
+}  // namespace FrameCodec
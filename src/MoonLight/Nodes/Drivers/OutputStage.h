@@ -0,0 +1,125 @@
+/**
+    @title     MoonLight
+    @file      OutputStage.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/moonlight/drivers/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#pragma once
+
+// Converts the driver channels (channelsD) of a range of lights into wire order with brightness and color correction,
+// used by the drivers which put the channels in packets themselves (Art-Net, sACN, DMX).
+// The plans of the light presets are tested in test/test_output_stage.
+//
+// The plan is compiled when the light preset changes (DriverNode::onUpdate): one step per color channel of each RGB(W) group of a light
+// (offsetRGB, offsetRGB1..3): the channel it is read from, the channel it is written to and the map (red, green, blue or white).
+// Channels without a step (pan, tilt, ...) are copied. A frame is then one pass over the lights, without looking up the offsets in the header per light.
+// The maps are the 8 bit LUTs of the leds driver (brightness and color correction) or, if dither is on, the 8.8 LUT (see Dither.h).
+
+#include <stdint.h>
+#include <string.h>
+
+#include "Dither.h"
+
+class OutputStage {
+ public:
+  // the maps of a frame: red, green, blue, white
+  struct Maps {
+    const uint8_t* map8[4] = {nullptr, nullptr, nullptr, nullptr};
+    const Dither::Lut* dither = nullptr;  // if set used instead of map8
+    uint8_t threshold = 0;                // dither threshold of this frame
+  };
+
+  uint8_t channelsPerLight = 3;
+
+  OutputStage() {
+    const uint8_t group = 0;
+    compile(3, &group, 1, 1, 0, 2, UINT8_MAX);  // GRB, as LightsHeader
+  }
+
+  // groups: offsets of the RGB(W) groups in a light, UINT8_MAX: no group. red, green, blue, white: channel of that color within a group, white UINT8_MAX: no white
+  void compile(uint8_t channelsPerLight, const uint8_t* groups, uint8_t nrOfGroups, uint8_t red, uint8_t green, uint8_t blue, uint8_t white) {
+    this->channelsPerLight = channelsPerLight;
+    nrOfSteps = 0;
+    const uint8_t order[4] = {red, green, blue, white};
+    uint8_t nrOfColors = white != UINT8_MAX ? 4 : 3;
+    for (uint8_t g = 0; g < nrOfGroups && g < maxGroups; g++) {
+      if (groups[g] == UINT8_MAX) continue;
+      for (uint8_t c = 0; c < nrOfColors; c++) {
+        uint16_t out = groups[g] + order[c];
+        uint16_t in = groups[g] + c;
+        if (out >= channelsPerLight || in >= channelsPerLight) continue;  // group does not fit in the light
+        steps[nrOfSteps++] = {(uint8_t)out, (uint8_t)in, c};
+      }
+    }
+
+    // if each channel of the light is written by a step, the copy can be left out (RGB and RGBW strips)
+    uint8_t written = 0;
+    for (uint16_t channel = 0; channel < channelsPerLight; channel++) {
+      for (uint8_t s = 0; s < nrOfSteps; s++) {
+        if (steps[s].out == channel) {
+          written++;
+          break;
+        }
+      }
+    }
+    allMapped = written == channelsPerLight;
+  }
+
+  // nrOfLights lights from in (channelsD) to out (packet, not overlapping in). index: channel index of in in channelsD, for the dither threshold
+  void apply(uint8_t* out, const uint8_t* in, uint16_t nrOfLights, uint32_t index, const Maps& maps) const {
+    if (!allMapped) memcpy(out, in, (size_t)nrOfLights * channelsPerLight);
+
+    if (maps.dither) {
+      for (uint16_t i = 0; i < nrOfLights; i++) {
+        for (uint8_t s = 0; s < nrOfSteps; s++) {
+          const Step& step = steps[s];
+          out[step.out] = Dither::apply(maps.dither->map[step.map][in[step.in]], Dither::threshold(maps.threshold, index + step.in));
+        }
+        out += channelsPerLight;
+        in += channelsPerLight;
+        index += channelsPerLight;
+      }
+      return;
+    }
+
+    if (nrOfSteps == 3 && channelsPerLight == 3) {  // RGB strips: the steps in registers
+      const Step s0 = steps[0], s1 = steps[1], s2 = steps[2];
+      const uint8_t *m0 = maps.map8[s0.map], *m1 = maps.map8[s1.map], *m2 = maps.map8[s2.map];
+      for (uint16_t i = 0; i < nrOfLights; i++) {
+        out[s0.out] = m0[in[s0.in]];
+        out[s1.out] = m1[in[s1.in]];
+        out[s2.out] = m2[in[s2.in]];
+        out += 3;
+        in += 3;
+      }
+      return;
+    }
+
+    for (uint16_t i = 0; i < nrOfLights; i++) {
+      for (uint8_t s = 0; s < nrOfSteps; s++) {
+        const Step& step = steps[s];
+        out[step.out] = maps.map8[step.map][in[step.in]];
+      }
+      out += channelsPerLight;
+      in += channelsPerLight;
+    }
+  }
+
+ private:
+  static const uint8_t maxGroups = 4;  // offsetRGB, offsetRGB1..3
+
+  struct Step {
+    uint8_t out;  // channel in the light on the wire
+    uint8_t in;   // channel in the light in channelsD
+    uint8_t map;  // 0..3: red, green, blue, white
+  };
+
+  Step steps[maxGroups * 4];
+  uint8_t nrOfSteps = 0;
+  bool allMapped = false;
+};
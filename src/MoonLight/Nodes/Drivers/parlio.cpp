@@ -25,13 +25,14 @@ namespace LedMatrixDetail {
 
 // This intermediate step is common to all packing functions.
 // It transposes the data for 32 time-slices into a cache-friendly temporary buffer.
-inline void transpose_32_slices(uint32_t (&transposed_slices)[32], const uint8_t* input_buffer, const uint32_t pixel_in_pin, const uint32_t input_component, const uint32_t pixels_per_pin, const uint32_t num_active_pins, const uint32_t COMPONENTS_PER_PIXEL, const uint32_t* waveform_cache, const uint8_t* brightness_cache) {
+inline void transpose_32_slices(uint32_t (&transposed_slices)[32], const uint8_t* input_buffer, const uint32_t pixel_in_pin, const uint32_t input_component, const uint32_t pixels_per_pin, const uint32_t num_active_pins, const uint32_t COMPONENTS_PER_PIXEL, const uint32_t* waveform_cache, const uint8_t* brightness_cache, const uint16_t* dither_cache, const uint8_t dither_threshold) {
   memset(transposed_slices, 0, sizeof(uint32_t) * 32);
 
   for (uint32_t pin = 0; pin < num_active_pins; ++pin) {
     const uint32_t pixel_idx = (pin * pixels_per_pin) + pixel_in_pin;
     const uint32_t component_idx = (pixel_idx * COMPONENTS_PER_PIXEL) + input_component;  // ← Now uses input_component!
-    const uint8_t data_byte = brightness_cache[input_buffer[component_idx]];
+    // dither_cache: 8.8 fixed point LUT, the fraction is dithered over the frames (see Dither.h)
+    const uint8_t data_byte = dither_cache ? Dither::apply(dither_cache[input_buffer[component_idx]], Dither::threshold(dither_threshold, component_idx)) : brightness_cache[input_buffer[component_idx]];
     const uint32_t waveform = waveform_cache[data_byte];
     const uint32_t pin_bit = (1 << pin);
 
@@ -147,7 +148,7 @@ uint8_t gamma8(uint8_t b) {  // we do nothing with gamma for now
 }
 
 // 1. Add the RGB offsets parameter to the function signature
-void create_transposed_led_output_optimized(const uint8_t* input_buffer, uint16_t* output_buffer, const uint32_t pixels_per_pin, const uint32_t num_active_pins, const bool is_rgbw, const uint8_t offsetR, const uint8_t offsetG, const uint8_t offsetB) {
+void create_transposed_led_output_optimized(const uint8_t* input_buffer, uint16_t* output_buffer, const uint32_t pixels_per_pin, const uint32_t num_active_pins, const bool is_rgbw, const uint8_t offsetR, const uint8_t offsetG, const uint8_t offsetB, const Dither::Lut* ditherLut, const uint8_t ditherThreshold) {
   // Only keep waveform cache (for WS2812 protocol timing)
   static uint32_t waveform_cache[256];
   static bool waveform_cache_initialized = false;
@@ -226,7 +227,9 @@ void create_transposed_led_output_optimized(const uint8_t* input_buffer, uint16_
         break;
       }
 
-      LedMatrixDetail::transpose_32_slices(transposed_slices, input_buffer, pixel_in_pin, input_component, pixels_per_pin, num_active_pins, COMPONENTS_PER_PIXEL, waveform_cache, brightness_cache);
+      const uint16_t* dither_cache = ditherLut ? ditherLut->map[input_component] : nullptr;
+
+      LedMatrixDetail::transpose_32_slices(transposed_slices, input_buffer, pixel_in_pin, input_component, pixels_per_pin, num_active_pins, COMPONENTS_PER_PIXEL, waveform_cache, brightness_cache, dither_cache, ditherThreshold);
 
       const uint32_t component_start_word = (pixel_in_pin * WAVEFORM_WORDS_PER_PIXEL) + (component_in_pixel * 32);
       uint8_t* current_out_ptr = out_base_ptr + (component_start_word * bit_width / 8);
@@ -262,7 +265,7 @@ parlio_transmit_config_t transmit_config = {.idle_value = 0x00,  // the idle val
 
 static portMUX_TYPE parlio_spinlock = portMUX_INITIALIZER_UNLOCKED;
 
-uint8_t IRAM_ATTR __attribute__((hot)) show_parlio(uint8_t* parallelPins, uint32_t length, uint8_t* buffer_in, bool isRGBW, uint8_t outputs, uint16_t leds_per_output, uint8_t offSetR, uint8_t offsetG, uint8_t offsetB) {
+uint8_t IRAM_ATTR __attribute__((hot)) show_parlio(uint8_t* parallelPins, uint32_t length, uint8_t* buffer_in, bool isRGBW, uint8_t outputs, uint16_t leds_per_output, uint8_t offSetR, uint8_t offsetG, uint8_t offsetB, const Dither::Lut* ditherLut, uint8_t ditherThreshold) {
   if (length != outputs * leds_per_output) {
     delay(100);
     Serial.printf("Parallel IO isn't set correctly. Check length, outputs, and LEDs per output. (%d != %d x %d)\n", length, outputs, leds_per_output);
@@ -384,7 +387,7 @@ uint8_t IRAM_ATTR __attribute__((hot)) show_parlio(uint8_t* parallelPins, uint32
     //  offsetB = 2;
   #endif
 
-  create_transposed_led_output_optimized(parallel_buffer_remapped, parallel_buffer_repacked, leds_per_output, outputs, isRGBW, offSetR, offsetG, offsetB);
+  create_transposed_led_output_optimized(parallel_buffer_remapped, parallel_buffer_repacked, leds_per_output, outputs, isRGBW, offSetR, offsetG, offsetB, ditherLut, ditherThreshold);
 
   // Calculate the exact size of ONE PIXEL's data in bits and bytes.
   const uint32_t symbols_per_pixel = isRGBW ? 128 : 96;
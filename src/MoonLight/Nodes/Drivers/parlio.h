@@ -12,7 +12,9 @@
 #pragma once
 #include <Arduino.h>
 
+#include "Dither.h"
+
 #if FT_MOONLIGHT
 
-uint8_t show_parlio(uint8_t* parallelPins, uint32_t length, uint8_t* buffer_in, bool isRGBW, uint8_t outputs, uint16_t leds_per_output, uint8_t offSetR, uint8_t offsetG, uint8_t offsetB);
+uint8_t show_parlio(uint8_t* parallelPins, uint32_t length, uint8_t* buffer_in, bool isRGBW, uint8_t outputs, uint16_t leds_per_output, uint8_t offSetR, uint8_t offsetG, uint8_t offsetB, const Dither::Lut* ditherLut = nullptr, uint8_t ditherThreshold = 0);
 #endif
\ No newline at end of file
@@ -16,6 +16,7 @@ class RainbowEffect : public Node {
   static const char* name() { return "Rainbow"; }
   static uint8_t dim() { return _1D; }
   static const char* tags() { return "🔥⚡️"; }
+  static constexpr NodeCaps caps() { return {.readsPrevious = false, .fullOverwrite = true}; }  // glitter is added to this frame
 
   uint8_t speed = 8;  // default 8*32 = 256 / 256 = 1 = hue++
   uint8_t deltaHue = 7;
@@ -16,6 +16,7 @@ class SolidEffect : public Node {
   static const char* name() { return "Solid"; }
   static uint8_t dim() { return _3D; }
   static const char* tags() { return "🔥"; }
+  static constexpr NodeCaps caps() { return {.readsPrevious = false, .fullOverwrite = true, .bandParallel = true}; }
 
   uint8_t red = 182;
   uint8_t green = 15;
@@ -167,7 +168,7 @@ class RipplesEffect : public Node {
 
   void loop() override {
     float ripple_interval = 1.3f * ((255.0f - interval) / 128.0f) * sqrtf(layer->size.y);
-    float time_interval = millis() / (100.0 - speed) / ((256.0f - 128.0f) / 20.0f);
+    float time_interval = layerP.frameScheduler.frameMillis / (100.0 - speed) / ((256.0f - 128.0f) / 20.0f);
 
     layer->fadeToBlackBy(255);
 
@@ -177,7 +178,7 @@ class RipplesEffect : public Node {
         float d = distance(layer->size.x / 2.0f, layer->size.z / 2.0f, 0.0f, (float)pos.x, (float)pos.z, 0.0f) / 9.899495f * layer->size.y;
         pos.y = floor(layer->size.y / 2.0f * (1 + sinf(d / ripple_interval + time_interval)));  // between 0 and layer->size.y
 
-        layer->setRGB(pos, (CRGB)CHSV(millis() / 50 + random8(64), 200, 255));
+        layer->setRGB(pos, (CRGB)CHSV(layerP.frameScheduler.frameMillis / 50 + random8(64), 200, 255));
       }
     }
   }
@@ -233,9 +234,9 @@ class ScrollingTextEffect : public Node {
       choice = preset;
     else {
       if (strlen(textIn) == 0)
-        choice = (millis() / 1000 % 8) + 2;
+        choice = (layerP.frameScheduler.frameMillis / 1000 % 8) + 2;
       else
-        choice = (millis() / 1000 % 9) + 1;
+        choice = (layerP.frameScheduler.frameMillis / 1000 % 9) + 1;
     }
 
     IPAddress activeIP = WiFi.isConnected() ? WiFi.localIP() : ETH.localIP();
@@ -290,7 +291,7 @@ class ScrollingTextEffect : public Node {
     //   Serial.printf(" %d:%s", choice-1, text.c_str());
 
     // if (text && strnlen(text.c_str(), 2) > 0) {
-    layer->drawText(text.c_str(), 0, 1, font, CRGB::Red, -(millis() / 25 * speed / 256));  // instead of call
+    layer->drawText(text.c_str(), 0, 1, font, CRGB::Red, -(layerP.frameScheduler.frameMillis / 25 * speed / 256));  // instead of call
     // }
 
   #if USE_M5UNIFIEDDisplay
@@ -316,7 +317,7 @@ class SinusEffect : public Node {
   void loop() override {
     layer->fadeToBlackBy(70);
 
-    uint8_t hueOffset = millis() / 10;
+    uint8_t hueOffset = layerP.frameScheduler.frameMillis / 10;
     static uint16_t phase = 0;  // Tracks the phase of the sine wave
     uint8_t brightness = 255;
 
@@ -347,7 +348,7 @@ class SphereMoveEffect : public Node {
   void loop() override {
     layer->fadeToBlackBy(255);
 
-    float time_interval = millis() / (100 - speed) / ((256.0f - 128.0f) / 20.0f);
+    float time_interval = layerP.frameScheduler.frameMillis / (100 - speed) / ((256.0f - 128.0f) / 20.0f);
 
     Coord3D origin;
     origin.x = layer->size.x / 2.0 * (1.0 + sinf(time_interval));
@@ -363,7 +364,7 @@ class SphereMoveEffect : public Node {
           float d = distance(pos.x, pos.y, pos.z, origin.x, origin.y, origin.z);
 
           if (d > diameter && d < diameter + 1.0) {
-            layer->setRGB(pos, (CRGB)CHSV(millis() / 50 + random8(64), 200, 255));
+            layer->setRGB(pos, (CRGB)CHSV(layerP.frameScheduler.frameMillis / 50 + random8(64), 200, 255));
           }
         }
       }
@@ -409,7 +410,7 @@ class StarFieldEffect : public Node {  // Inspired by Daniel Shiffman's Coding T
   Star stars[255];
 
   void loop() override {
-    if (!speed || millis() - step < 1000 / speed) return;  // Not enough time passed
+    if (!speed || layerP.frameScheduler.frameMillis - step < 1000 / speed) return;  // Not enough time passed
 
     layer->fadeToBlackBy(blur);
 
@@ -441,7 +442,7 @@ class StarFieldEffect : public Node {  // Inspired by Daniel Shiffman's Coding T
       }
     }
 
-    step = millis();
+    step = layerP.frameScheduler.frameMillis;
   }
 };  // StarFieldEffect
 
@@ -480,7 +481,7 @@ class PraxisEffect : public Node {
     // uint16_t micro_mutator = beatsin8(microMutatorFreq, microMutatorMin, microMutatorMax); // beatsin16(2, 550, 900);
 
     Coord3D pos = {0, 0, 0};
-    uint8_t huebase = millis() / 40;  // 1 + ~huespeed
+    uint8_t huebase = layerP.frameScheduler.frameMillis / 40;  // 1 + ~huespeed
 
     for (pos.x = 0; pos.x < layer->size.x; pos.x++) {
       for (pos.y = 0; pos.y < layer->size.y; pos.y++) {
@@ -519,7 +520,7 @@ class WaveEffect : public Node {
   void loop() override {
     layer->fadeToBlackBy(fade);  // should only fade rgb ...
 
-    CRGB color = CHSV(millis() / 50, 255, 255);
+    CRGB color = CHSV(layerP.frameScheduler.frameMillis / 50, 255, 255);
 
     int prevPos = layer->size.x / 2;  // somewhere in the middle
 
@@ -546,7 +547,7 @@ class WaveEffect : public Node {
         pos = (bs8 + beatsin8(bpm * 0.65, 0, 255, y * 200) + beatsin8(bpm * 1.43, 0, 255, y * 300)) * layer->size.x / 256 / 3;
         break;
       case 5:
-        pos = inoise8(millis() * bpm / 256 + y * 1000) * layer->size.x / 256;
+        pos = inoise8(layerP.frameScheduler.frameMillis * bpm / 256 + y * 1000) * layer->size.x / 256;
         break;  // bpm not really bpm, more speed
       default:
         pos = 0;
@@ -594,7 +595,7 @@ class FreqSawsEffect : public Node {
     memset(lastBpm, 0, sizeof(lastBpm));
     memset(phaseOffset, 0, sizeof(phaseOffset));
 
-    lastTime = millis();
+    lastTime = layerP.frameScheduler.frameMillis;
   }
 
   uint16_t bandSpeed[NUM_GEQ_CHANNELS];
@@ -606,7 +607,7 @@ class FreqSawsEffect : public Node {
   void loop() override {
     layer->fadeToBlackBy(fade);
     // Update timing for frame-rate independent phase
-    unsigned long currentTime = millis();
+    unsigned long currentTime = layerP.frameScheduler.frameMillis;
     uint32_t deltaMs = currentTime - lastTime;
     lastTime = currentTime;
 
@@ -937,13 +938,13 @@ class RubiksCubeEffect : public Node {
   RotateFunc rotateFuncs[6] = {&Cube::rotateFront, &Cube::rotateBack, &Cube::rotateLeft, &Cube::rotateRight, &Cube::rotateTop, &Cube::rotateBottom};
 
   void loop() override {
-    if (doInit && millis() > step || step - 3100 > millis()) {  // step - 3100 > millis() temp fix for default on boot
-      step = millis() + 1000;
+    if (doInit && layerP.frameScheduler.frameMillis > step || step - 3100 > layerP.frameScheduler.frameMillis) {  // step - 3100 > frameMillis temp fix for default on boot
+      step = layerP.frameScheduler.frameMillis + 1000;
       doInit = false;
       init();
     }
 
-    if (!turnsPerSecond || millis() - step < 1000 / turnsPerSecond || millis() < step) return;
+    if (!turnsPerSecond || layerP.frameScheduler.frameMillis - step < 1000 / turnsPerSecond || layerP.frameScheduler.frameMillis < step) return;
 
     Move move = randomTurning ? createRandomMoveStruct(cubeSize, prevFaceMoved) : unpackMove(moveList[moveIndex]);
 
@@ -952,12 +953,12 @@ class RubiksCubeEffect : public Node {
     cube.drawCube(layer);
 
     if (!randomTurning && moveIndex == 0) {
-      step = millis() + 3000;
+      step = layerP.frameScheduler.frameMillis + 3000;
       doInit = true;
       return;
     }
     if (!randomTurning) moveIndex--;
-    step = millis();
+    step = layerP.frameScheduler.frameMillis;
   }
 };
 
@@ -1138,7 +1139,7 @@ class ParticlesEffect : public Node {
       layer->setRGB(initPos, particles[index].color);
     }
     EXT_LOGD(ML_TAG, "Particles Set Up\n");
-    step = millis();
+    step = layerP.frameScheduler.frameMillis;
   }
 
   Particle particles[255];
@@ -1147,7 +1148,7 @@ class ParticlesEffect : public Node {
   float gravity[3];
 
   void loop() override {
-    if (!speed || millis() - step < 1000 / speed) return;  // Not enough time passed
+    if (!speed || layerP.frameScheduler.frameMillis - step < 1000 / speed) return;  // Not enough time passed
 
     float gravityX, gravityY, gravityZ;  // Gravity if using gyro or random gravity
 
@@ -1165,8 +1166,8 @@ class ParticlesEffect : public Node {
   #endif
 
     if (randomGravity) {
-      if (millis() - gravUpdate > gravityChangeInterval * 1000) {
-        gravUpdate = millis();
+      if (layerP.frameScheduler.frameMillis - gravUpdate > gravityChangeInterval * 1000) {
+        gravUpdate = layerP.frameScheduler.frameMillis;
         float scale = 5.0f;
         // Generate Perlin noise values and scale them
         gravity[0] = (inoise8(step, 0, 0) / 128.0f - 1.0f) * scale;
@@ -1192,7 +1193,7 @@ class ParticlesEffect : public Node {
       particles[index].updatePositionandDraw(layer, index, debugPrint);
     }
 
-    step = millis();
+    step = layerP.frameScheduler.frameMillis;
   }
 };
 
@@ -1283,7 +1284,7 @@ class SpiralFireEffect : public Node {
     layer->fadeToBlackBy(40);
 
     Coord3D pos;
-    uint16_t time = millis() >> 4;
+    uint16_t time = layerP.frameScheduler.frameMillis >> 4;
 
     // Calculate center of the cone
     float centerX = layer->size.x / 2.0f;
@@ -1498,6 +1499,7 @@ class PixelMapEffect : public Node {
   static const char* name() { return "PixelMap"; }
   static uint8_t dim() { return _3D; }
   static const char* tags() { return "💫"; }
+  static constexpr NodeCaps caps() { return {.readsPrevious = false, .fullOverwrite = true}; }
 
   Coord3D pos = {0, 0, 0};
 
@@ -1506,7 +1508,7 @@ class PixelMapEffect : public Node {
   void loop() override {
     layer->fill_solid(CRGB::Black);
 
-    layer->setRGB(pos, CHSV(millis() / 50 + random8(64), 255, 255));  // ColorFromPalette(layerP.palette,call, bri);
+    layer->setRGB(pos, CHSV(layerP.frameScheduler.frameMillis / 50 + random8(64), 255, 255));  // ColorFromPalette(layerP.palette,call, bri);
   }
 };  // PixelMap
 
@@ -1515,6 +1517,7 @@ class MarioTestEffect : public Node {
   static const char* name() { return "MarioTest"; }
   static uint8_t dim() { return _2D; }
   static const char* tags() { return "💫"; }
+  static constexpr NodeCaps caps() { return {.readsPrevious = false, .fullOverwrite = true}; }
 
   bool background = false;
   Coord3D offset = {0, 0, 0};
@@ -1575,12 +1578,10 @@ class RingRandomFlowEffect : public RingEffect {
 
   uint8_t* hue = nullptr;
 
-  ~RingRandomFlowEffect() { freeMB(hue); }
+  ~RingRandomFlowEffect() { freeArena(hue); }
 
   void onSizeChanged(const Coord3D& prevSize) override {
-    freeMB(hue);
-    hue = allocMB<uint8_t>(layer->size.y);
-    if (!hue) {
+    if (!allocArena(hue, layer->size.y)) {
       EXT_LOGE(ML_TAG, "allocate hue failed");
     }
   }
@@ -1645,4 +1646,278 @@ class AudioRingsEffect : public RingEffect {
   }
 };
 
+  #include <algorithm>
+  #include <atomic>
+
+  #include "MoonLight/Nodes/Drivers/FrameCodec.h"
+
+  #define PLAYER_RING_SIZE 65536  // read ahead buffer with PSRAM, without it 2 frames
+  #define PLAYER_READ_CHUNK 4096
+
+// Plays files made by the Frame Recorder driver into the physical layer. A reader task reads ahead from the file system into a
+// ring buffer, the effect only decodes the frames which are due. The effect and the reader hand over with ready: the effect
+// requests open / seek and stops reading the ring, the reader sets ready when done.
+class FramePlayerEffect : public Node {
+ public:
+  static const char* name() { return "Frame Player"; }
+  static uint8_t dim() { return _3D; }
+  static const char* tags() { return "🔥💫"; }
+
+  Char<32> fileName = "/recording.mlf";
+  bool play = true;
+  bool repeat = true;
+  bool clockSync = false;
+  uint16_t position = 0;  // seconds
+  Char<32> status = "";
+
+  void setup() override {
+    addControl(fileName, "file", "text", 0, 32);
+    addControl(play, "play", "checkbox");
+    addControl(repeat, "repeat", "checkbox");
+    addControl(clockSync, "clockSync", "checkbox");
+    addControl(position, "position", "number", 0, 65535, false, "s");
+    addControl(status, "status", "text", 0, 32, true);  // read only
+
+    xTaskCreateUniversal(readerTask, "FramePlayer", 4096, this, 1, &taskHandle, 0);  // low priority, below the effect and driver tasks
+  }
+
+  void onUpdate(const Char<20>& oldValue, const JsonObject& control) override {
+    if (control["name"] == "file") requestOpen = true;
+    if (control["name"] == "position") requestPosition = true;
+  }
+
+  // owned by the effect (loop)
+  bool requestOpen = true;
+  bool requestPosition = false;
+  uint8_t* frame = nullptr;  // the frame shown, previous frame for delta records
+  uint8_t* record = nullptr;
+  uint32_t bufferChannels = 0;
+  unsigned long startMillis = 0;
+
+  // owned by the reader task while !ready, by the effect while ready
+  std::atomic<bool> ready = false;
+  int32_t currentFrame = -1;     // frame in frame[]
+  uint32_t nextRecordFrame = 0;  // frame of the next record in the ring
+  std::atomic<uint8_t> command = 0;  // 1: open, 2: seek
+  std::atomic<const char*> openError = nullptr;  // set by the reader if the file can not be played, shown in status by the effect
+  uint32_t seekFrame = 0;
+  File file;
+  FrameCodec::FileHeader header;
+  uint32_t nrOfFrames = 0;
+  std::vector<uint32_t, VectorRAMAllocator<uint32_t>> keyFrames;  // frame numbers of the key frames, ascending
+  std::vector<uint32_t, VectorRAMAllocator<uint32_t>> keyFrameOffsets;
+  uint8_t* ring = nullptr;
+  uint32_t ringSize = 0;
+  std::atomic<uint32_t> ringHead = 0;  // bytes written by the reader
+  std::atomic<uint32_t> ringTail = 0;  // bytes consumed by the effect
+
+  TaskHandle_t taskHandle = nullptr;
+  std::atomic<bool> stopTask = false;
+  std::atomic<bool> taskDone = false;
+
+  static void readerTask(void* parameter) { ((FramePlayerEffect*)parameter)->reader(); }
+
+  void reader() {
+    while (!stopTask) {
+      uint8_t cmd = command.exchange(0);
+      if (cmd == 1) openFile();
+      if (cmd && file) seekFile();
+      if (ready) fillRing();
+      vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    if (file) file.close();
+    taskDone = true;
+    vTaskDelete(NULL);
+  }
+
+  void openFile() {
+    if (file) file.close();
+    nrOfFrames = 0;
+    keyFrames.clear();
+    keyFrameOffsets.clear();
+
+    file = ESPFS.open(fileName.c_str());
+    if (!file || file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) || !header.isValid()) {
+      EXT_LOGW(ML_TAG, "Player: %s is not a recording", fileName.c_str());
+      if (file) file.close();
+      openError = "not a recording";
+      return;
+    }
+
+    // index the key frames to seek: walk the record headers only. By type, as the recorder moves a key frame if its file system was behind
+    uint32_t offset = sizeof(header);
+    uint8_t recordHeader[FrameCodec::recordHeaderSize];
+    while (file.seek(offset) && file.read(recordHeader, sizeof(recordHeader)) == sizeof(recordHeader)) {
+      if (FrameCodec::recordType(recordHeader) == FrameCodec::keyFrame) {
+        keyFrames.push_back(nrOfFrames);
+        keyFrameOffsets.push_back(offset);
+      }
+      offset += sizeof(recordHeader) + FrameCodec::recordPayloadSize(recordHeader);
+      nrOfFrames++;
+    }
+
+    uint32_t minSize = 2 * FrameCodec::maxRecordSize(header.nrOfChannels);
+    uint32_t neededSize = psramFound() ? MAX(PLAYER_RING_SIZE, minSize) : minSize;
+    if (ringSize != neededSize) {
+      freeMB(ring);
+      ring = allocMB<uint8_t>(neededSize, "player");
+      if (!ring && neededSize > minSize) {  // PSRAM full: less read ahead
+        neededSize = minSize;
+        ring = allocMB<uint8_t>(neededSize, "player");
+      }
+      ringSize = ring ? neededSize : 0;
+    }
+    if (!ring || keyFrames.empty()) {
+      file.close();
+      openError = ring ? "no frames" : "could not start";
+    }
+    EXT_LOGI(ML_TAG, "Player: %s %d frames of %d channels", fileName.c_str(), nrOfFrames, header.nrOfChannels);
+  }
+
+  // to the last key frame at or before seekFrame (the first key frame if there is none)
+  void seekFile() {
+    size_t keyFrame = std::upper_bound(keyFrames.begin(), keyFrames.end(), seekFrame) - keyFrames.begin();
+    if (keyFrame) keyFrame--;
+    file.seek(keyFrameOffsets[keyFrame]);
+    ringHead = 0;
+    ringTail = 0;
+    nextRecordFrame = keyFrames[keyFrame];
+    currentFrame = -1;  // no previous frame for delta records
+    ready = true;
+  }
+
+  void fillRing() {
+    while (true) {
+      uint32_t head = ringHead;
+      uint32_t free = ringSize - (head - ringTail);
+      uint32_t index = head % ringSize;
+      uint32_t chunk = MIN(MIN(free, ringSize - index), PLAYER_READ_CHUNK);
+      if (chunk < PLAYER_READ_CHUNK / 4) return;  // full enough
+      size_t bytesRead = file.read(&ring[index], chunk);
+      if (bytesRead == 0) return;  // end of file
+      ringHead = head + bytesRead;
+      if (command || stopTask) return;
+    }
+  }
+
+  void ringRead(uint8_t* dest, uint32_t tail, uint32_t size) {
+    uint32_t index = tail % ringSize;
+    uint32_t first = MIN(size, ringSize - index);
+    memcpy(dest, &ring[index], first);
+    memcpy(dest + first, ring, size - first);
+  }
+
+  // take the next record from the ring if it is completely read. false if not (yet) available.
+  // Each record is a frame slot: a record which can not be decoded still counts, the frames after it are skipped until the next key frame
+  bool decodeNext() {
+    uint32_t tail = ringTail;
+    uint32_t available = ringHead - tail;
+    if (available < FrameCodec::recordHeaderSize) return false;
+    ringRead(record, tail, FrameCodec::recordHeaderSize);
+    uint32_t recordSize = FrameCodec::recordHeaderSize + FrameCodec::recordPayloadSize(record);
+    if (recordSize > FrameCodec::maxRecordSize(bufferChannels)) {  // corrupt size: the next record can not be found, continue at the next key frame
+      auto next = std::upper_bound(keyFrames.begin(), keyFrames.end(), nextRecordFrame);
+      EXT_LOGW(ML_TAG, "Player: record of frame %d corrupt", nextRecordFrame);
+      if (next != keyFrames.end()) seek(*next);
+      return false;
+    }
+    if (available < recordSize) return false;
+    ringRead(record, tail, recordSize);
+    ringTail = tail + recordSize;
+    uint32_t recordFrame = nextRecordFrame++;
+
+    if (currentFrame == -1 && FrameCodec::recordType(record) != FrameCodec::keyFrame) return true;  // delta without previous frame
+    if (!FrameCodec::decodeFrame(record, frame, bufferChannels)) {
+      currentFrame = -1;  // frame is partly updated: wait for a key frame
+      return true;
+    }
+    currentFrame = recordFrame;
+    return true;
+  }
+
+  void seek(uint32_t frameNr) {
+    ready = false;
+    seekFrame = frameNr;
+    command = 2;
+  }
+
+  uint32_t targetFrame() {
+    if (clockSync) {  // all devices with the same file and NTP time show the same frame
+      struct timeval tv;
+      gettimeofday(&tv, nullptr);
+      if (tv.tv_sec > 1600000000) return (((uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000) / header.frameInterval) % nrOfFrames;
+    }
+
+    if (!play) startMillis = millis() - MAX(currentFrame, 0) * header.frameInterval;  // pause: resume from the current frame
+    uint32_t frameNr = (millis() - startMillis) / header.frameInterval;
+    if (frameNr >= nrOfFrames) {
+      if (!repeat) return nrOfFrames - 1;
+      startMillis += (frameNr / nrOfFrames) * nrOfFrames * header.frameInterval;
+      frameNr %= nrOfFrames;
+    }
+    return frameNr;
+  }
+
+  void loop() override {
+    if (requestOpen) {
+      requestOpen = false;
+      ready = false;
+      command = 1;
+      startMillis = millis();
+      return;
+    }
+    if (!ready) {
+      const char* error = openError.exchange(nullptr);
+      if (error) {
+        updateControl("status", error);
+        moduleNodes->requestUIUpdate = true;
+        bufferChannels = 0;  // the status of the next file which opens is shown
+      }
+      return;
+    }
+
+    if (bufferChannels != header.nrOfChannels) {  // new file
+      freeMB(frame);
+      freeMB(record);
+      frame = allocMB<uint8_t>(header.nrOfChannels, "player");
+      record = allocMB<uint8_t>(FrameCodec::maxRecordSize(header.nrOfChannels), "player");
+      bufferChannels = (frame && record) ? header.nrOfChannels : 0;
+
+      Char<32> statusString;
+      statusString.format("%d frames %ds", nrOfFrames, nrOfFrames * header.frameInterval / 1000);
+      if (header.channelsPerLight != layerP.lights.header.channelsPerLight) statusString += " preset?";
+      updateControl("status", statusString.c_str());
+      moduleNodes->requestUIUpdate = true;
+      if (!bufferChannels) return;
+    }
+
+    if (requestPosition) {
+      requestPosition = false;
+      startMillis = millis() - position * 1000;
+    }
+
+    uint32_t target = targetFrame();
+
+    // backwards or far ahead: restart from the nearest key frame
+    if (target + 1 < nextRecordFrame || target >= nextRecordFrame + 2 * header.keyFrameInterval) {
+      seek(target);
+      return;
+    }
+
+    while (nextRecordFrame <= target && decodeNext());
+
+    if (currentFrame >= 0) layerP.setLights(0, 0, frame, bufferChannels);
+  }
+
+  ~FramePlayerEffect() override {
+    if (taskHandle) {
+      stopTask = true;
+      while (!taskDone) delay(10);  // the reader uses the ring until it is done, a file system read can take long
+    }
+    freeMB(ring);
+    freeMB(frame);
+    freeMB(record);
+  }
+};
+
 #endif
\ No newline at end of file
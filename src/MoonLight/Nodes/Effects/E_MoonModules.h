@@ -11,6 +11,8 @@
 
 #if FT_MOONLIGHT
 
+  #include "MoonLight/Nodes/Effects/LifeBoard.h"
+
 // Written by Ewoud Wijma in 2022, inspired by https://natureofcode.com/book/chapter-7-cellular-automata/ and https://github.com/DougHaber/nlife-color ,
 // Modified By: Brandon Butler / @Brandon502 / wildcats08 in 2024
 // todo: ewowi check with wildcats08: can background color be removed as it is now easy to add solid as background color (blending ...?)
@@ -20,7 +22,7 @@ class GameOfLifeEffect : public Node {
   static uint8_t dim() { return _3D; }  // supports 3D but also 2D (1D as well?)
   static const char* tags() { return "🔥💫🎨"; }
 
-  void placePentomino(uint8_t* futureCells, bool colorByAge) {
+  void placePentomino(uint32_t* futureCells, bool colorByAge) {
     uint8_t pattern[5][2] = {{1, 0}, {0, 1}, {1, 1}, {2, 1}, {2, 2}};  // R-pentomino
     if (!random8(5)) pattern[0][1] = 3;                                // 1/5 chance to use glider
     CRGB color = ColorFromPalette(layerP.palette, random8());
@@ -32,7 +34,7 @@ class GameOfLifeEffect : public Node {
       for (int i = 0; i < 5; i++) {
         int nx = x + pattern[i][0];
         int ny = y + pattern[i][1];
-        if (getBitValue(futureCells, layer->XYZUnModified(Coord3D(nx, ny, z)))) {
+        if (board.get(futureCells, nx, ny, z)) {
           canPlace = false;
           break;
         }
@@ -41,7 +43,7 @@ class GameOfLifeEffect : public Node {
         for (int i = 0; i < 5; i++) {
           int nx = x + pattern[i][0];
           int ny = y + pattern[i][1];
-          setBitValue(futureCells, layer->XYZUnModified(Coord3D(nx, ny, z)), true);
+          board.set(futureCells, nx, ny, z, true);
           layer->setRGB(Coord3D(nx, ny, z), colorByAge ? CRGB::Green : color);
         }
         return;
@@ -92,6 +94,7 @@ class GameOfLifeEffect : public Node {
           surviveNumbers[num] = true;
       }
     }
+    board.setRule(birthNumbers, surviveNumbers);
   }
 
   void setup() override {
@@ -115,6 +118,8 @@ class GameOfLifeEffect : public Node {
     addControl(colorByAge, "colorByAge", "checkbox");
     addControl(infinite, "infinite", "checkbox");
     addControl(blur, "blur", "slider", 0, 255);
+
+    setBirthAndSurvive();
   }
 
   void onUpdate(const Char<20>& oldValue, const JsonObject& control) override {
@@ -134,29 +139,36 @@ class GameOfLifeEffect : public Node {
   bool birthNumbers[9];
   bool surviveNumbers[9];
   CRGB prevPalette;
-  uint8_t* cells = nullptr;
-  uint8_t* futureCells = nullptr;
+  // bit boards (LifeBoard): 32 cells per word
+  LifeBoard board;
+  uint32_t* cells = nullptr;
+  uint32_t* futureCells = nullptr;
+  uint32_t* mapped = nullptr;  // 3D: cells which are lights, only they can live
+  uint32_t* fading = nullptr;  // dead cells still blending to the background
   uint8_t* cellColors = nullptr;
 
   void startNewGameOfLife() {
     // EXT_LOGD(ML_TAG, "startNewGameOfLife");
     prevPalette = ColorFromPalette(layerP.palette, 0);
     generation = 1;
-    disablePause ? step = millis() : step = millis() + 1500;
+    disablePause ? step = layerP.frameScheduler.frameMillis : step = layerP.frameScheduler.frameMillis + 1500;
 
-    if (!cells || !futureCells || !cellColors) return;
+    if (!cells || !futureCells || !mapped || !fading || !cellColors) return;
 
     // Setup Grid
     memset(cells, 0, dataSize);
+    memset(fading, 0, dataSize);
     memset(cellColors, 0, layer->size.x * layer->size.y * layer->size.z);
 
     for (int x = 0; x < layer->size.x; x++)
       for (int y = 0; y < layer->size.y; y++)
         for (int z = 0; z < layer->size.z; z++) {
-          if (layer->layerDimension == _3D && !layer->isMapped(layer->XYZUnModified(Coord3D(x, y, z)))) continue;
+          bool isMapped = layer->layerDimension != _3D || layer->isMapped(layer->XYZUnModified(Coord3D(x, y, z)));
+          board.set(mapped, x, y, z, isMapped);
+          if (!isMapped) continue;
           if (random8(100) < lifeChance) {
             int index = layer->XYZUnModified(Coord3D(x, y, z));
-            setBitValue(cells, index, true);
+            board.set(cells, x, y, z, true);
             cellColors[index] = random8(1, 255);
             layer->setRGB(Coord3D(x, y, z), colorByAge ? CRGB::Green : ColorFromPalette(layerP.palette, cellColors[index]));
             // layer->setRGB(Coord3D(x,y,z), bgColor); // Color set in redraw loop
@@ -172,50 +184,61 @@ class GameOfLifeEffect : public Node {
     cubeGliderLength = gliderLength * 6;  // Change later for rectangular cuboid
   }
 
-  int dataSize = 0;
+  int dataSize = 0;  // bytes of a bit board
 
   ~GameOfLifeEffect() override {
-    freeMB(cells);
-    freeMB(futureCells);
-    freeMB(cellColors);
+    freeArena(cells);
+    freeArena(futureCells);
+    freeArena(mapped);
+    freeArena(fading);
+    freeArena(cellColors);
   }
 
   void onSizeChanged(const Coord3D& prevSize) override {
-    dataSize = ((layer->size.x * layer->size.y * layer->size.z + 7) / 8);
+    board.setSize(layer->size.x, layer->size.y, layer->size.z);
+    dataSize = board.nrOfWords * sizeof(uint32_t);
 
-    freeMB(cells);
-    freeMB(futureCells);
-    freeMB(cellColors);
+    allocArena(cells, board.nrOfWords);
+    allocArena(futureCells, board.nrOfWords);
+    allocArena(mapped, board.nrOfWords);
+    allocArena(fading, board.nrOfWords);
+    allocArena(cellColors, layer->size.x * layer->size.y * layer->size.z);
 
-    cells = allocMB<uint8_t>(dataSize);
-    futureCells = allocMB<uint8_t>(dataSize);
-    cellColors = allocMB<uint8_t>(layer->size.x * layer->size.y * layer->size.z);
-
-    if (!cells || !futureCells || !cellColors) {
-      EXT_LOGE(ML_TAG, "allocation of cells || !futureCells || !cellColors failed");
+    if (!cells || !futureCells || !mapped || !fading || !cellColors) {
+      EXT_LOGE(ML_TAG, "allocation of cells || !futureCells || !mapped || !fading || !cellColors failed");
+      return;
     }
 
     startNewGameOfLife();
   }
 
+  // call f(x, y, z) for each cell set in bits, the cells x = w * 32.. of row y of plane z
+  template <typename F>
+  void forEachCell(uint32_t bits, uint16_t w, uint16_t y, uint16_t z, F f) {
+    while (bits) {
+      uint8_t bit = __builtin_ctz(bits);
+      bits &= bits - 1;
+      f(w * 32 + bit, y, z);
+    }
+  }
+
   void loop() override {
-    if (!cells || !futureCells || !cellColors) return;
+    if (!cells || !futureCells || !mapped || !fading || !cellColors) return;
 
-    if (generation == 0 && step < millis()) {
+    if (generation == 0 && step < layerP.frameScheduler.frameMillis) {
       // EXT_LOGD(ML_TAG, "gen / step");
       startNewGameOfLife();
       return;  // show the start
     }
 
     CRGB bgColor = CRGB(bgC.x, bgC.y, bgC.z);
-    CRGB color = ColorFromPalette(layerP.palette, random8());  // Used if all parents died
 
     int fadedBackground = 0;
     if (blur > 220 && !colorByAge) {  // Keep faded background if blur > 220
       fadedBackground = bgColor.r + bgColor.g + bgColor.b + 20 + (blur - 220);
       blur -= (blur - 220);
     }
-    bool blurDead = step > millis() && !fadedBackground;
+    bool blurDead = step > layerP.frameScheduler.frameMillis && !fadedBackground;
     // Redraw Loop
     if (generation <= 1 || blurDead) {  // Readd overlay support when implemented
       for (int x = 0; x < layer->size.x; x++)
@@ -225,7 +248,7 @@ class GameOfLifeEffect : public Node {
             Coord3D cLocPos = Coord3D(x, y, z);
             uint16_t cLoc = layer->XYZ(cLocPos);  // Current cell location (led index)
             if (!layer->isMapped(cIndex)) continue;
-            bool alive = getBitValue(cells, cIndex);
+            bool alive = board.get(cells, x, y, z);
             bool recolor = (alive && generation == 1 && cellColors[cIndex] == 0 && !random(16));  // Palette change or Initial Color
             // Redraw alive if palette changed, spawn initial colors randomly, age alive cells while paused
             if (alive && recolor) {
@@ -245,74 +268,80 @@ class GameOfLifeEffect : public Node {
     }
 
     // if (!speed || step > millis() || millis() - step < 1000 / speed) return; // Check if enough time has passed for updating
-    if (!speed || step > millis() || (speed != 100 && millis() - step < 1000 / speed)) return;  // Uncapped speed when slider maxed
+    if (!speed || step > layerP.frameScheduler.frameMillis || (speed != 100 && layerP.frameScheduler.frameMillis - step < 1000 / speed)) return;  // Uncapped speed when slider maxed
 
     // Update Game of Life
-    int aliveCount = 0, deadCount = 0;                         // Detect solo gliders and dead grids
     const int zAxis = (layer->layerDimension == _3D) ? 1 : 0;  // Avoids looping through z axis neighbors if 2D
+    // Wrap is disabled when unchecked, for 3D fixtures, every 1500 generations, and solo gliders
     bool disableWrap = !wrap || soloGlider || generation % 1500 == 0 || zAxis;
-    // Loop through all cells. Count neighbors, apply rules, setPixel
-    for (int x = 0; x < layer->size.x; x++)
-      for (int y = 0; y < layer->size.y; y++)
-        for (int z = 0; z < layer->size.z; z++) {
-          Coord3D cPos = Coord3D(x, y, z);
-          uint16_t cIndex = layer->XYZUnModified(cPos);
-          bool cellValue = getBitValue(cells, cIndex);
-          if (cellValue)
-            aliveCount++;
-          else
-            deadCount++;
-          if (zAxis && !layer->isMapped(cIndex)) continue;  // Skip if not physical led on 3D fixtures
-          uint8_t neighbors = 0, colorCount = 0;
-          uint8_t nColors[9];
-
-          for (int i = -1; i <= 1; i++)
-            for (int j = -1; j <= 1; j++)
-              for (int k = -zAxis; k <= zAxis; k++) {
-                if (i == 0 && j == 0 && k == 0) continue;  // Ignore itself
-                Coord3D nPos = Coord3D(x + i, y + j, z + k);
-                if (nPos.isOutofBounds(layer->size)) {
-                  // Wrap is disabled when unchecked, for 3D fixtures, every 1500 generations, and solo gliders
-                  if (disableWrap) continue;
-                  nPos = (nPos + layer->size) % layer->size;  // Wrap around 3D
-                }
-                uint16_t nIndex = layer->XYZUnModified(nPos);
-                // Count neighbors and store up to 9 neighbor colors
-                if (getBitValue(cells, nIndex)) {
-                  neighbors++;
-                  if (cellValue || colorByAge) continue;  // Skip if cell is alive (color already set) or color by age (colors are not used)
-                  if (cellColors[nIndex] == 0) continue;  // Skip if neighbor color is 0 (dead cell)
-                  nColors[colorCount % 9] = cellColors[nIndex];
-                  colorCount++;
-                }
-              }
-          // Rules of Life
-          if (cellValue && !surviveNumbers[neighbors]) {
-            // Loneliness or Overpopulation
-            setBitValue(futureCells, cIndex, false);
-            layer->blendColor(cPos, bgColor, blur);
-          } else if (!cellValue && birthNumbers[neighbors]) {
-            // Reproduction
-            setBitValue(futureCells, cIndex, true);
-            uint8_t colorIndex = nColors[random8(colorCount)];
+    int aliveCount = LifeBoard::count(cells, board.nrOfWords);  // Detect solo gliders and dead grids
+    int deadCount = layer->size.x * layer->size.y * layer->size.z - aliveCount;
+    board.step(cells, futureCells, !disableWrap, zAxis, zAxis ? mapped : nullptr);
+
+    CRGB paletteColor = ColorFromPalette(layerP.palette, 0);
+    bool paletteChanged = paletteColor != prevPalette;
+    prevPalette = paletteColor;
+
+    // Only the cells which changed (or still fade / age) are drawn
+    for (uint16_t z = 0; z < board.sizeZ; z++)
+      for (uint16_t y = 0; y < board.sizeY; y++)
+        for (uint16_t w = 0; w < board.wordsPerRow; w++) {
+          size_t word = board.index(w * 32, y, z);
+          uint32_t now = cells[word];
+          uint32_t next = futureCells[word];
+
+          // Reproduction
+          forEachCell(next & ~now, w, y, z, [&](uint16_t x, uint16_t y, uint16_t z) {
+            uint8_t colorCount = 0;
+            uint8_t nColors[9];
+            if (!colorByAge) {  // colors are not used with color by age
+              for (int i = -1; i <= 1; i++)
+                for (int j = -1; j <= 1; j++)
+                  for (int k = -zAxis; k <= zAxis; k++) {
+                    if (i == 0 && j == 0 && k == 0) continue;  // Ignore itself
+                    Coord3D nPos = Coord3D(x + i, y + j, z + k);
+                    if (nPos.isOutofBounds(layer->size)) {
+                      if (disableWrap) continue;
+                      nPos = (nPos + layer->size) % layer->size;  // Wrap around 3D
+                    }
+                    if (!board.get(cells, nPos.x, nPos.y, nPos.z)) continue;
+                    uint8_t nColor = cellColors[layer->XYZUnModified(nPos)];
+                    if (nColor == 0) continue;  // Skip if neighbor color is 0 (dead cell)
+                    nColors[colorCount % 9] = nColor;
+                    colorCount++;
+                  }
+            }
+            uint8_t colorIndex = colorCount ? nColors[random8(min(colorCount, (uint8_t)9))] : random8();
             if (random8(100) < mutation) colorIndex = random8();
-            cellColors[cIndex] = colorIndex;
+            Coord3D cPos = Coord3D(x, y, z);
+            cellColors[layer->XYZUnModified(cPos)] = colorIndex;
             layer->setRGB(cPos, colorByAge ? CRGB::Green : ColorFromPalette(layerP.palette, colorIndex));
-          } else {
-            // Blending, fade dead cells further causing blurring effect to moving cells
-            if (!cellValue) {
-              if (fadedBackground) {
-                CRGB val = layer->getRGB(cPos);
-                if (fadedBackground < val.r + val.g + val.b) layer->blendColor(cPos, bgColor, blur);
-              } else
-                layer->blendColor(cPos, bgColor, blur);
-            } else {  // alive
+          });
+
+          // Loneliness or Overpopulation
+          forEachCell(now & ~next, w, y, z, [&](uint16_t x, uint16_t y, uint16_t z) { layer->blendColor(Coord3D(x, y, z), bgColor, blur); });
+          fading[word] = (fading[word] | (now & ~next)) & ~next;
+
+          // Blending, fade dead cells further causing blurring effect to moving cells, until they reach the background (or fadedBackground)
+          forEachCell(fading[word] & ~now, w, y, z, [&](uint16_t x, uint16_t y, uint16_t z) {
+            Coord3D cPos = Coord3D(x, y, z);
+            CRGB val = layer->getRGB(cPos);
+            CRGB blended = blend(bgColor, val, blur);
+            if (blended == val || (fadedBackground && fadedBackground >= val.r + val.g + val.b))
+              board.set(fading, x, y, z, false);  // done
+            else
+              layer->setRGB(cPos, blended);
+          });
+
+          // Alive: age, or redraw if the palette changed
+          if (colorByAge || paletteChanged)
+            forEachCell(now & next, w, y, z, [&](uint16_t x, uint16_t y, uint16_t z) {
+              Coord3D cPos = Coord3D(x, y, z);
               if (colorByAge)
                 layer->blendColor(cPos, CRGB::Red, 248);
               else
-                layer->setRGB(cPos, ColorFromPalette(layerP.palette, cellColors[cIndex]));
-            }
-          }
+                layer->setRGB(cPos, ColorFromPalette(layerP.palette, cellColors[layer->XYZUnModified(cPos)]));
+            });
         }
 
     if (aliveCount == 5)
@@ -331,7 +360,7 @@ class GameOfLifeEffect : public Node {
     }
     if (repetition) {
       generation = 0;
-      disablePause ? step = millis() : step = millis() + 1000;
+      disablePause ? step = layerP.frameScheduler.frameMillis : step = layerP.frameScheduler.frameMillis + 1000;
       return;
     }
     // Update CRC values
@@ -339,7 +368,7 @@ class GameOfLifeEffect : public Node {
     if (gliderLength && generation % gliderLength == 0) spaceshipCRC = crc;
     if (cubeGliderLength && generation % cubeGliderLength == 0) cubeGliderCRC = crc;
     (generation)++;
-    step = millis();
+    step = layerP.frameScheduler.frameMillis;
   }
 };  // GameOfLife
 
@@ -48,7 +48,7 @@ class Troy1MoveEffect : public Node {
   uint8_t range = 20;
   uint8_t colorwheel = 0;
   uint8_t colorwheelbrightness = 255;  // 0-255, 0 = off, 255 = full brightness
-  time_t cooldown = millis();
+  time_t cooldown = layerP.frameScheduler.frameMillis;
 
   bool autoMove = true;
   bool audioReactive = true;
@@ -101,8 +101,8 @@ class Troy1MoveEffect : public Node {
   void loop() override {
     for (int x = 0; x < layer->size.x; x++) {  // loop over lights defined in layout
       if (audioReactive) {
-        if (sharedData.bands[2] > 200 && cooldown + 3000 < millis()) {  // cooldown for 3 seconds
-          cooldown = millis();
+        if (sharedData.bands[2] > 200 && cooldown + 3000 < layerP.frameScheduler.frameMillis) {  // cooldown for 3 seconds
+          cooldown = layerP.frameScheduler.frameMillis;
           colorwheel = random8(8) * 5;  // random colorwheel index and convert to 0-35 range
         }
         layer->setGobo(x, colorwheel);
@@ -178,7 +178,7 @@ class Troy2MoveEffect : public Node {
   uint8_t zoom = 20;
   uint8_t range = 20;
   uint8_t cutin = 200;
-  time_t cooldown = millis();
+  time_t cooldown = layerP.frameScheduler.frameMillis;
 
   bool autoMove = true;
   bool audioReactive = true;
@@ -220,7 +220,7 @@ class Troy2MoveEffect : public Node {
         if (sharedData.bands[0] > cutin) {
           layer->setZoom(x, 255);
           coolDownSet = true;
-        } else if (cooldown + 5000 < millis()) {
+        } else if (cooldown + 5000 < layerP.frameScheduler.frameMillis) {
           layer->setZoom(x, 0);
           coolDownSet = true;
         }
@@ -242,7 +242,7 @@ class Troy2MoveEffect : public Node {
         // layer->setBrightness(x, layerP.lights.header.brightness); // done automatically
       }
     }
-    if (coolDownSet) cooldown = millis();
+    if (coolDownSet) cooldown = layerP.frameScheduler.frameMillis;
   }
 };
 
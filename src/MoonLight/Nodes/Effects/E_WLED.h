@@ -28,15 +28,13 @@ class BouncingBallsEffect : public Node {
   Ball (*balls)[maxNumBalls] = nullptr;  //[maxColumns][maxNumBalls];
   uint16_t ballsSize = 0;
 
-  ~BouncingBallsEffect() override { freeMB(balls); }
+  ~BouncingBallsEffect() override { freeArena(balls); }
 
   void onSizeChanged(const Coord3D& prevSize) override {
-    Ball(*newAlloc)[maxNumBalls] = reallocMB<Ball[maxNumBalls]>(balls, layer->size.x);
-
-    if (newAlloc) {
-      balls = newAlloc;
+    if (allocArena(balls, layer->size.x)) {
       ballsSize = layer->size.x;
     } else {
+      ballsSize = 0;
       EXT_LOGE(ML_TAG, "(re)allocate balls failed");
     }
   }
@@ -49,7 +47,7 @@ class BouncingBallsEffect : public Node {
     // non-chosen color is a random color
     const float gravity = -9.81f;  // standard value of gravity
     // const bool hasCol2 = SEGCOLOR(2);
-    const unsigned long time = millis();
+    const unsigned long time = layerP.frameScheduler.frameMillis;
 
     // not necessary as effectControls is cleared at setup()
     //  if (call == 0) {
@@ -191,7 +189,7 @@ class DistortionWavesEffect : public Node {
   void loop() override {
     uint8_t w = 2;
 
-    uint16_t a = millis() / 32;
+    uint16_t a = layerP.frameScheduler.frameMillis / 32;
     uint16_t a2 = a / 2;
     uint16_t a3 = a / 3;
 
@@ -326,20 +324,19 @@ class GEQEffect : public Node {
     addControl(colorBars, "colorBars", "checkbox");
     addControl(smoothBars, "smoothBars", "checkbox");
 
-    step = millis();
+    step = layerP.frameScheduler.frameMillis;
   }
 
   uint16_t* previousBarHeight = nullptr;
   uint8_t previousBarHeightSize = 0;
 
-  ~GEQEffect() { freeMB(previousBarHeight); }
+  ~GEQEffect() { freeArena(previousBarHeight); }
 
   void onSizeChanged(const Coord3D& prevSize) override {
-    uint16_t* newAlloc = reallocMB<uint16_t>(previousBarHeight, layer->size.x);
-    if (newAlloc) {
-      previousBarHeight = newAlloc;
+    if (allocArena(previousBarHeight, layer->size.x)) {
       previousBarHeightSize = layer->size.x;
     } else {
+      previousBarHeightSize = 0;
       EXT_LOGE(ML_TAG, "(re)allocate previousBarHeight failed");
     }
   }
@@ -352,8 +349,8 @@ class GEQEffect : public Node {
   #endif
 
     bool rippleTime = false;
-    if (millis() - step >= (256U - ripple)) {
-      step = millis();
+    if (layerP.frameScheduler.frameMillis - step >= (256U - ripple)) {
+      step = layerP.frameScheduler.frameMillis;
       rippleTime = true;
     }
 
@@ -416,7 +413,7 @@ class GEQEffect : public Node {
       if (previousBarHeight && pos.x < previousBarHeightSize) {
         if (barHeight > previousBarHeight[pos.x]) previousBarHeight[pos.x] = barHeight;                                  // drive the peak up
         if ((ripple > 0) && (previousBarHeight[pos.x] > 0) && (previousBarHeight[pos.x] < layer->size.y))                // WLEDMM avoid "overshooting" into other segments
-          layer->setRGB(Coord3D(pos.x, layer->size.y - previousBarHeight[pos.x]), (CRGB)CHSV(millis() / 50, 255, 255));  // take millis()/50 color for the time being
+          layer->setRGB(Coord3D(pos.x, layer->size.y - previousBarHeight[pos.x]), (CRGB)CHSV(layerP.frameScheduler.frameMillis / 50, 255, 255));  // take frameMillis/50 color for the time being
 
         if (rippleTime && previousBarHeight[pos.x] > 0) previousBarHeight[pos.x]--;  // delay/ripple effect
       }
@@ -442,7 +439,7 @@ class LissajousEffect : public Node {
 
   void loop() override {
     layer->fadeToBlackBy(fadeRate);
-    uint_fast16_t phase = millis() * speed / 256;  // allow user to control rotation speed, speed between 0 and 255!
+    uint_fast16_t phase = layerP.frameScheduler.frameMillis * speed / 256;  // allow user to control rotation speed, speed between 0 and 255!
     Coord3D locn = {0, 0, 0};
     for (int i = 0; i < 256; i++) {
       // WLEDMM: stick to the original calculations of xlocn and ylocn
@@ -450,7 +447,7 @@ class LissajousEffect : public Node {
       locn.y = cos8(phase / 2 + i * 2);
       locn.x = (layer->size.x < 2) ? 1 : (::map(2 * locn.x, 0, 511, 0, 2 * (layer->size.x - 1)) + 1) / 2;  // softhack007: "*2 +1" for proper rounding
       locn.y = (layer->size.y < 2) ? 1 : (::map(2 * locn.y, 0, 511, 0, 2 * (layer->size.y - 1)) + 1) / 2;  // "layer->size.y > 2" is needed to avoid div/0 in ::map()
-      layer->setRGB(locn, ColorFromPalette(layerP.palette, millis() / 100 + i, 255));
+      layer->setRGB(locn, ColorFromPalette(layerP.palette, layerP.frameScheduler.frameMillis / 100 + i, 255));
     }
   }
 };
@@ -472,7 +469,7 @@ class Noise2DEffect : public Node {
   void loop() override {
     for (int y = 0; y < layer->size.y; y++) {
       for (int x = 0; x < layer->size.x; x++) {
-        uint8_t pixelHue8 = inoise8(x * scale, y * scale, millis() / (16 - speed));
+        uint8_t pixelHue8 = inoise8(x * scale, y * scale, layerP.frameScheduler.frameMillis / (16 - speed));
         layer->setRGB(Coord3D(x, y), ColorFromPalette(layerP.palette, pixelHue8));
       }
     }
@@ -637,8 +634,8 @@ class PacManEffect : public Node {
       if (maxBlinkPos < 20) maxBlinkPos = 20;
       int startBlinkingGhostsLED = (layer->nrOfLights < 64) ? (int)layer->nrOfLights / 3 : map(blinkDistance, 20, 255, 20, maxBlinkPos);
 
-      if (millis() > step) {
-        step = millis();
+      if (layerP.frameScheduler.frameMillis > step) {
+        step = layerP.frameScheduler.frameMillis;
         aux1TimingCounter++;
       }
 
@@ -852,7 +849,7 @@ class AntEffect : public Node {
     int confusedAntIndex = random(0, numAnts);  // the first random ant to go backwards
 
     for (int i = 0; i < MAX_ANTS; i++) {
-      ants[i].lastBumpUpdate = millis();
+      ants[i].lastBumpUpdate = layerP.frameScheduler.frameMillis;
 
       // Random velocity
       float velocity = VELOCITY_MIN + (VELOCITY_MAX - VELOCITY_MIN) * random16(1000, 5000) / 5000.0f;
@@ -880,20 +877,20 @@ class AntEffect : public Node {
 
     // Update and render each ant
     for (int i = 0; i < numAnts; i++) {
-      float timeSinceLastUpdate = float(millis() - ants[i].lastBumpUpdate) / timeConversionFactor;
+      float timeSinceLastUpdate = float(layerP.frameScheduler.frameMillis - ants[i].lastBumpUpdate) / timeConversionFactor;
       float newPosition = ants[i].position + ants[i].velocity * timeSinceLastUpdate;
 
       // Reset ants that wandered too far off-track (e.g., after intensity change)
       if (newPosition < -0.5f || newPosition > 1.5f) {
         newPosition = ants[i].position = random16(0, 10000) / 10000.0f;
-        ants[i].lastBumpUpdate = millis();
+        ants[i].lastBumpUpdate = layerP.frameScheduler.frameMillis;
       }
 
       // Handle boundary conditions (bounce or wrap)
       if (newPosition <= 0.0f && ants[i].velocity < 0.0f) {
-        handleBoundary(ants[i], newPosition, gatherFood, true, millis());
+        handleBoundary(ants[i], newPosition, gatherFood, true, layerP.frameScheduler.frameMillis);
       } else if (newPosition >= 1.0f && ants[i].velocity > 0.0f) {
-        handleBoundary(ants[i], newPosition, gatherFood, false, millis());
+        handleBoundary(ants[i], newPosition, gatherFood, false, layerP.frameScheduler.frameMillis);
       }
 
       // Handle collisions between ants (if not passing by)
@@ -906,7 +903,7 @@ class AntEffect : public Node {
           float collisionTime = (timeConversionFactor * (ants[i].position - ants[j].position) + ants[i].velocity * timeOffset) / (ants[j].velocity - ants[i].velocity);
 
           // Check if collision occurred in valid time window
-          float timeSinceJ = float(millis() - ants[j].lastBumpUpdate);
+          float timeSinceJ = float(layerP.frameScheduler.frameMillis - ants[j].lastBumpUpdate);
           if (collisionTime > MIN_COLLISION_TIME_MS && collisionTime < timeSinceJ) {
             // Update positions to collision point
             float adjustedTime = (collisionTime + float(ants[j].lastBumpUpdate - ants[i].lastBumpUpdate)) / timeConversionFactor;
@@ -926,7 +923,7 @@ class AntEffect : public Node {
             }
 
             // Recalculate position after collision
-            newPosition = ants[i].position + ants[i].velocity * (millis() - ants[i].lastBumpUpdate) / timeConversionFactor;
+            newPosition = ants[i].position + ants[i].velocity * (layerP.frameScheduler.frameMillis - ants[i].lastBumpUpdate) / timeConversionFactor;
           }
         }
       }
@@ -946,7 +943,7 @@ class AntEffect : public Node {
       }
 
       // Update ant state
-      ants[i].lastBumpUpdate = millis();
+      ants[i].lastBumpUpdate = layerP.frameScheduler.frameMillis;
       ants[i].position = newPosition;
     }
 
@@ -991,21 +988,20 @@ class TetrixEffect : public Node {
   uint16_t nrOfDrops = 0;
 
   void onSizeChanged(const Coord3D& prevSize) override {
-    Tetris* newAlloc = reallocMB<Tetris>(drops, layer->size.x);
-    if (newAlloc) {
-      drops = newAlloc;
+    if (allocArena(drops, layer->size.x)) {
       nrOfDrops = layer->size.x;
     } else {
-      EXT_LOGE(ML_TAG, "(re)allocate drops failed");  // keep old (if existed)
+      nrOfDrops = 0;
+      EXT_LOGE(ML_TAG, "(re)allocate drops failed");
     }
     for (int i = 0; i < nrOfDrops; i++) {
       drops[i].stack = 0;               // reset brick stack size
-      drops[i].step = millis() + 2000;  // start by fading out strip
+      drops[i].step = layerP.frameScheduler.frameMillis + 2000;  // start by fading out strip
       if (oneColor) drops[i].col = 0;   // use only one color from palette
     }
   }
 
-  ~TetrixEffect() override { freeMB(drops); };
+  ~TetrixEffect() override { freeArena(drops); };
 
   void loop() override {
     if (!drops) return;
@@ -1045,13 +1041,13 @@ class TetrixEffect : public Node {
         } else {                                                                 // we hit bottom
           drops[x].step = 0;                                                     // proceed with next brick, go back to init
           drops[x].stack += drops[x].brick;                                      // increase the stack size
-          if (drops[x].stack >= layer->size.y) drops[x].step = millis() + 2000;  // fade out stack
+          if (drops[x].stack >= layer->size.y) drops[x].step = layerP.frameScheduler.frameMillis + 2000;  // fade out stack
         }
       }
 
       if (drops[x].step > 2) {  // fade strip
         drops[x].brick = 0;     // reset brick size (no more growing)
-        if (drops[x].step > millis()) {
+        if (drops[x].step > layerP.frameScheduler.frameMillis) {
           // allow fading of virtual strip
           for (int i = 0; i < layer->size.y; i++) layer->blendColor(Coord3D(x, i), CRGB::Black, 25);  // 10% blend
         } else {
@@ -1081,6 +1077,7 @@ class PopCornEffect : public Node {
   static const char* name() { return "PopCorn"; }
   static uint8_t dim() { return _1D; }  // 2D-ish? check latest in WLED...
   static const char* tags() { return "♪🎨🐙"; }
+  static constexpr NodeCaps caps() { return {.readsPrevious = false, .fullOverwrite = true, .usesAudio = true}; }
 
   uint8_t speed = 128;
   uint8_t numPopcorn = maxNumPopcorn / 2;
@@ -1181,7 +1178,7 @@ class WaverlyEffect : public Node {
     //  if ((soundPressure) && (audioSync->sync.volumeSmth > 0.5f)) audioSync->sync.volumeSmth = audioSync->sync.soundPressure;    // show sound pressure instead of volume
     //  if (agcDebug) audioSync->sync.volumeSmth = 255.0 - audioSync->sync.agcSensitivity;                    // show AGC level instead of volume
 
-    long t = millis() / 2;
+    long t = layerP.frameScheduler.frameMillis / 2;
     Coord3D pos = {0, 0, 0};  // initialize z otherwise wrong results
     for (pos.x = 0; pos.x < layer->size.x; pos.x++) {
       uint16_t thisVal = sharedData.volume * amplification * inoise8(pos.x * 45, t, t) / 4096;  // WLEDMM back to SR code
@@ -1193,7 +1190,7 @@ class WaverlyEffect : public Node {
         layer->addRGB(Coord3D((layer->size.x - 1) - pos.x, (layer->size.y - 1) - pos.y), color);
       }
     }
-    layer->blur2d(16);
+    layer->blur2d(16, true);  // optional
   }
 };  // Waverly
 
@@ -1225,7 +1222,7 @@ class BlackholeEffect : public Node {
     int x, y;
 
     layer->fadeToBlackBy(16 + (fadeRate >> 3));  // create fading trails
-    unsigned long t = millis() / 128;            // timebase
+    unsigned long t = layerP.frameScheduler.frameMillis / 128;            // timebase
     // outer stars
     for (size_t i = 0; i < 8; i++) {
       x = beatsin8(outerXfreq >> 3, 0, cols - 1, 0, ((i % 2) ? 128 : 0) + t * i);
@@ -1241,7 +1238,7 @@ class BlackholeEffect : public Node {
     // central white dot
     layer->setRGB(Coord3D(cols / 2, rows / 2), CRGB::White);
     // blur everything a bit
-    if (blur) layer->blur2d(blur);
+    if (blur) layer->blur2d(blur, true);  // optional
   }
 };
 
@@ -1284,11 +1281,11 @@ class DNAEffect : public Node {
       int posY1 = beatsin8(speed, 0, rows - 1, 0, phase);
       int posY2 = beatsin8(speed, 0, rows - 1, 0, phase + 128);
       if ((i == 0) || ((abs(lastY1 - posY1) < 2) && (abs(lastY2 - posY2) < 2))) {  // use original code when no holes
-        layer->setRGB(Coord3D(i, posY1), ColorFromPalette(layerP.palette, i * 5 + millis() / 17, beatsin8(5, 55, 255, 0, i * 10)));
-        layer->setRGB(Coord3D(i, posY2), ColorFromPalette(layerP.palette, i * 5 + 128 + millis() / 17, beatsin8(5, 55, 255, 0, i * 10 + 128)));
+        layer->setRGB(Coord3D(i, posY1), ColorFromPalette(layerP.palette, i * 5 + layerP.frameScheduler.frameMillis / 17, beatsin8(5, 55, 255, 0, i * 10)));
+        layer->setRGB(Coord3D(i, posY2), ColorFromPalette(layerP.palette, i * 5 + 128 + layerP.frameScheduler.frameMillis / 17, beatsin8(5, 55, 255, 0, i * 10 + 128)));
       } else {  // draw line to prevent holes
-        layer->drawLine(i - 1, lastY1, i, posY1, ColorFromPalette(layerP.palette, i * 5 + millis() / 17, beatsin8(5, 55, 255, 0, i * 10)));
-        layer->drawLine(i - 1, lastY2, i, posY2, ColorFromPalette(layerP.palette, i * 5 + 128 + millis() / 17, beatsin8(5, 55, 255, 0, i * 10 + 128)));
+        layer->drawLine(i - 1, lastY1, i, posY1, ColorFromPalette(layerP.palette, i * 5 + layerP.frameScheduler.frameMillis / 17, beatsin8(5, 55, 255, 0, i * 10)));
+        layer->drawLine(i - 1, lastY2, i, posY2, ColorFromPalette(layerP.palette, i * 5 + 128 + layerP.frameScheduler.frameMillis / 17, beatsin8(5, 55, 255, 0, i * 10 + 128)));
       }
       lastY1 = posY1;
       lastY2 = posY2;
@@ -1335,7 +1332,7 @@ class OctopusEffect : public Node {
   uint16_t rMapSize = 0;
   uint32_t step;
 
-  ~OctopusEffect() { freeMB(rMap); }
+  ~OctopusEffect() { freeArena(rMap); }
 
   void setRMap() {
     const uint8_t C_X = layer->size.x / 2 + (offset.x - 50) * layer->size.x / 100;
@@ -1354,12 +1351,11 @@ class OctopusEffect : public Node {
   }
 
   void onSizeChanged(const Coord3D& prevSize) override {
-    Map_t* newAlloc = reallocMB<Map_t>(rMap, layer->size.x * layer->size.y);
-    if (newAlloc) {
-      rMap = newAlloc;
+    if (allocArena(rMap, layer->size.x * layer->size.y)) {
       rMapSize = layer->size.x * layer->size.y;
       setRMap();
     } else {
+      rMapSize = 0;
       EXT_LOGE(ML_TAG, "(re)allocate rMap failed");
     }
   }
@@ -1367,7 +1363,7 @@ class OctopusEffect : public Node {
   void loop() override {
     if (rMap) {  // check if rMap allocation successful
 
-      step = millis() * speed / 25;  // sys.now/25 = 40 per second. speed / 32: 1-4 range ? (1-8 ??)
+      step = layerP.frameScheduler.frameMillis * speed / 25;  // sys.now/25 = 40 per second. speed / 32: 1-4 range ? (1-8 ??)
       if (radialWave)
         step = 3 * step / 4;  // 7/6 = 1.16 for RadialWave mode
       else
@@ -1634,7 +1630,7 @@ class FlowEffect : public Node {
   void loop() override {
     uint16_t counter = 0;
     if (speed != 0) {
-      counter = millis() * ((speed >> 2) + 1);
+      counter = layerP.frameScheduler.frameMillis * ((speed >> 2) + 1);
       counter = counter >> 8;
     }
 
@@ -1735,13 +1731,10 @@ class RainEffect : public Node {
   Spark* drops = nullptr;
   uint16_t nrOfDrops = 0;
 
-  ~RainEffect() override { freeMB(drops); }
+  ~RainEffect() override { freeArena(drops); }
 
   void onSizeChanged(const Coord3D& prevSize) override {
-    Spark* newAlloc = reallocMB<Spark>(drops, layer->size.x);
-
-    if (newAlloc) {
-      drops = newAlloc;
+    if (allocArena(drops, layer->size.x)) {
       nrOfDrops = layer->size.x;
       for (int x = 0; x < layer->size.x; x++) {
         drops[x].pos = 0;
@@ -1749,6 +1742,7 @@ class RainEffect : public Node {
         drops[x].vel = 0;
       }
     } else {
+      nrOfDrops = 0;
       EXT_LOGE(ML_TAG, "(re)allocate drops failed");
     }
   }
@@ -1811,13 +1805,10 @@ class DripEffect : public Node {
   Spark (*drops)[maxNumDrops] = nullptr;  //[maxColumns][maxNumBalls];
   uint16_t nrOfDrops = 0;
 
-  ~DripEffect() override { freeMB(drops); }
+  ~DripEffect() override { freeArena(drops); }
 
   void onSizeChanged(const Coord3D& prevSize) override {
-    Spark(*newAlloc)[maxNumDrops] = reallocMB<Spark[maxNumDrops]>(drops, layer->size.x);
-
-    if (newAlloc) {
-      drops = newAlloc;
+    if (allocArena(drops, layer->size.x)) {
       nrOfDrops = layer->size.x;
       for (int x = 0; x < layer->size.x; x++) {
         for (int j = 0; j < maxNumDrops; j++) {
@@ -1825,6 +1816,7 @@ class DripEffect : public Node {
         }
       }
     } else {
+      nrOfDrops = 0;
       EXT_LOGE(ML_TAG, "(re)allocate drops failed");
     }
   }
@@ -1920,7 +1912,7 @@ class HeartBeatEffect : public Node {
     uint8_t bpm = 40 + (speed);
     uint32_t msPerBeat = (60000L / bpm);
     uint32_t secondBeat = (msPerBeat / 3);
-    unsigned long beatTimer = millis() - step;
+    unsigned long beatTimer = layerP.frameScheduler.frameMillis - step;
 
     bri_lower = bri_lower * 2042 / (2048 + intensity);
 
@@ -1932,7 +1924,7 @@ class HeartBeatEffect : public Node {
     if (beatTimer > msPerBeat) {  // time to reset the beat timer?
       bri_lower = UINT16_MAX;     // full bri
       isSecond = false;
-      step = millis();
+      step = layerP.frameScheduler.frameMillis;
     }
 
     for (int i = 0; i < layer->size.y; i++) {
@@ -0,0 +1,203 @@
+/**
+    @title     MoonLight
+    @file      LifeBoard.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/moonlight/overview/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#pragma once
+
+// Bit parallel Game of Life, used by the Game Of Life effect. Checked against a cell by cell reference in test/test_life_board.
+//
+// A board is packed 32 cells per word: bit x % 32 of word x / 32 of a row, rows y of plane z: word (z * sizeY + y) * wordsPerRow + x / 32.
+// Bits beyond sizeX in the last word of a row are always 0.
+// A step counts the neighbors of 32 cells at once in bit slices (bit k of the count of cell x is bit x of slice k):
+//   2D: the 8 neighbors (3 rows, shifted left and right) are added with a carry save adder tree into 4 slices.
+//   3D: the 8 neighbors in the plane plus the 9 cells of the plane above and below (stacked planes) are added into 5 slices (max 26).
+// The rule is applied on the slices with the birth and survive masks (bit n set: n neighbors), counts above 8 never match.
+// Wrap: the row ends are connected (carry of the shift comes from the other end), and the first and last rows and planes.
+
+#include <stddef.h>
+#include <stdint.h>
+
+class LifeBoard {
+ public:
+  uint16_t sizeX = 0;
+  uint16_t sizeY = 0;
+  uint16_t sizeZ = 0;
+  uint16_t wordsPerRow = 0;
+  size_t nrOfWords = 0;  // of a board
+
+  uint16_t birthMask = 0;    // bit n: a dead cell with n neighbors is born
+  uint16_t surviveMask = 0;  // bit n: a living cell with n neighbors survives
+
+  void setSize(uint16_t x, uint16_t y, uint16_t z) {
+    sizeX = x;
+    sizeY = y;
+    sizeZ = z;
+    wordsPerRow = (x + 31) / 32;
+    nrOfWords = (size_t)wordsPerRow * y * z;
+    lastWord = wordsPerRow ? wordsPerRow - 1 : 0;
+    lastBit = x ? (x - 1) % 32 : 0;
+    tailMask = lastBit == 31 ? UINT32_MAX : (1u << (lastBit + 1)) - 1;
+  }
+
+  // birth and survive as in a rule string B3/S23: birth[3] = survive[2] = survive[3] = true
+  void setRule(const bool birth[9], const bool survive[9]) {
+    birthMask = 0;
+    surviveMask = 0;
+    for (uint8_t n = 0; n < 9; n++) {
+      if (birth[n]) birthMask |= 1 << n;
+      if (survive[n]) surviveMask |= 1 << n;
+    }
+  }
+
+  size_t index(uint16_t x, uint16_t y, uint16_t z) const { return ((size_t)z * sizeY + y) * wordsPerRow + x / 32; }
+  bool get(const uint32_t* board, uint16_t x, uint16_t y, uint16_t z) const { return (board[index(x, y, z)] >> (x % 32)) & 1; }
+  void set(uint32_t* board, uint16_t x, uint16_t y, uint16_t z, bool value) const {
+    if (value)
+      board[index(x, y, z)] |= 1u << (x % 32);
+    else
+      board[index(x, y, z)] &= ~(1u << (x % 32));
+  }
+
+  static uint32_t count(const uint32_t* board, size_t nrOfWords) {
+    uint32_t count = 0;
+    for (size_t i = 0; i < nrOfWords; i++) count += __builtin_popcount(board[i]);
+    return count;
+  }
+
+  // next generation of cells in next. mask (optional): only these cells can live (e.g. the mapped lights of a 3D fixture). Returns the living cells
+  uint32_t step(const uint32_t* cells, uint32_t* next, bool wrap, bool is3D, const uint32_t* mask = nullptr) {
+    this->wrap = wrap;
+    uint32_t alive = 0;
+    uint16_t rules = birthMask | surviveMask;
+    for (uint16_t z = 0; z < sizeZ; z++) {
+      const uint32_t* below = is3D ? plane(cells, (int)z - 1) : nullptr;
+      const uint32_t* own = plane(cells, z);
+      const uint32_t* above = is3D ? plane(cells, (int)z + 1) : nullptr;
+      for (uint16_t y = 0; y < sizeY; y++) {
+        for (uint16_t w = 0; w < wordsPerRow; w++) {
+          uint32_t slices[5];
+          uint8_t nrOfSlices = 4;
+          count8(own, y, w, slices);
+          if (is3D) {
+            nrOfSlices = 5;
+            slices[4] = 0;
+            if (below) add9(below, y, w, slices);
+            if (above) add9(above, y, w, slices);
+          }
+
+          uint32_t born = 0;
+          uint32_t keep = 0;
+          for (uint8_t n = 0; n < 9; n++) {
+            if (!((rules >> n) & 1)) continue;
+            uint32_t equal = UINT32_MAX;
+            for (uint8_t k = 0; k < nrOfSlices; k++) equal &= (n >> k) & 1 ? slices[k] : ~slices[k];
+            if ((birthMask >> n) & 1) born |= equal;
+            if ((surviveMask >> n) & 1) keep |= equal;
+          }
+
+          size_t i = ((size_t)z * sizeY + y) * wordsPerRow + w;
+          uint32_t result = (cells[i] & keep) | (~cells[i] & born);
+          if (w == lastWord) result &= tailMask;
+          if (mask) result &= mask[i];
+          next[i] = result;
+          alive += __builtin_popcount(result);
+        }
+      }
+    }
+    return alive;
+  }
+
+ private:
+  uint16_t lastWord = 0;
+  uint8_t lastBit = 0;  // bit of the last cell in the last word of a row
+  uint32_t tailMask = 0;
+  bool wrap = false;
+
+  const uint32_t* plane(const uint32_t* board, int z) const {
+    if (z < 0 || z >= sizeZ) {
+      if (!wrap) return nullptr;
+      z = (z + sizeZ) % sizeZ;
+    }
+    return board + (size_t)z * sizeY * wordsPerRow;
+  }
+
+  const uint32_t* row(const uint32_t* plane, int y) const {
+    if (y < 0 || y >= sizeY) {
+      if (!wrap) return nullptr;
+      y = (y + sizeY) % sizeY;
+    }
+    return plane + (size_t)y * wordsPerRow;
+  }
+
+  // bit x is cell x - 1
+  uint32_t west(const uint32_t* row, uint16_t w) const {
+    if (!row) return 0;
+    uint32_t carry = w ? row[w - 1] >> 31 : wrap ? (row[lastWord] >> lastBit) & 1 : 0;
+    return (row[w] << 1) | carry;
+  }
+
+  // bit x is cell x + 1
+  uint32_t east(const uint32_t* row, uint16_t w) const {
+    if (!row) return 0;
+    uint32_t value = row[w] >> 1;
+    if (w < lastWord)
+      value |= row[w + 1] << 31;
+    else if (wrap)
+      value |= (row[0] & 1) << lastBit;
+    return value;
+  }
+
+  static void fullAdd(uint32_t a, uint32_t b, uint32_t c, uint32_t& sum, uint32_t& carry) {
+    uint32_t t = a ^ b;
+    sum = t ^ c;
+    carry = (a & b) | (t & c);
+  }
+
+  // the 8 neighbors of the cells of word w in row y of plane, in 4 slices (1, 2, 4, 8)
+  void count8(const uint32_t* plane, uint16_t y, uint16_t w, uint32_t* slices) const {
+    const uint32_t* up = row(plane, (int)y - 1);
+    const uint32_t* mid = row(plane, y);
+    const uint32_t* down = row(plane, (int)y + 1);
+    uint32_t s0, c0, s1, c1, s2, c2, ones, c3, t, c4, twos, c5;
+    fullAdd(west(up, w), up ? up[w] : 0, east(up, w), s0, c0);
+    fullAdd(west(down, w), down ? down[w] : 0, east(down, w), s1, c1);
+    uint32_t g = west(mid, w), h = east(mid, w);
+    s2 = g ^ h;  // half adder
+    c2 = g & h;
+    fullAdd(s0, s1, s2, ones, c3);  // weight 1
+    fullAdd(c0, c1, c2, t, c4);     // weight 2
+    twos = t ^ c3;
+    c5 = t & c3;
+    slices[0] = ones;
+    slices[1] = twos;
+    slices[2] = c4 ^ c5;  // weight 4
+    slices[3] = c4 & c5;  // weight 8
+  }
+
+  // add the 9 cells of an adjacent plane (8 neighbors and the cell itself) to the 5 slices of the count
+  void add9(const uint32_t* plane, uint16_t y, uint16_t w, uint32_t* slices) const {
+    uint32_t nine[5];
+    count8(plane, y, w, nine);
+    nine[4] = 0;
+    const uint32_t* mid = row(plane, y);
+    uint32_t carry = mid[w];
+    for (uint8_t k = 0; k < 5 && carry; k++) {  // + the cell itself
+      uint32_t c = nine[k] & carry;
+      nine[k] ^= carry;
+      carry = c;
+    }
+    carry = 0;
+    for (uint8_t k = 0; k < 5; k++) {
+      uint32_t a = slices[k], b = nine[k];
+      slices[k] = a ^ b ^ carry;
+      carry = (a & b) | (carry & (a ^ b));
+    }
+  }
+};
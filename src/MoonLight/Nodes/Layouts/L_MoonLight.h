@@ -566,4 +566,222 @@ class SpiralLayout : public Node {
   }
 };
 
-#endif  // FT_MOONLIGHT
\ No newline at end of file
+  #include "MoonLight/Nodes/Layouts/LayoutFile.h"
+
+  #define LAYOUTFILE_CHUNK 512  // bytes read or written at a time
+
+// Lights from a coordinate file (CSV, JSON or xLights model, see LayoutFile.h), for irregular installations like trees and sculptures.
+// The file is streamed in chunks, not loaded as a whole. The result is stored as a cache file (file name + .mlc) with the quantized positions:
+// as long as the file (hash) and scale are the same, mapping reads the cache without parsing.
+class FileLayout : public Node {
+ public:
+  static const char* name() { return "File"; }
+  static uint8_t dim() { return _3D; }
+  static const char* tags() { return "🚥"; }
+
+  Char<32> fileName = "/layout.csv";
+  uint16_t scale = 1;  // coordinates are multiplied by scale, e.g. 100 for coordinates in meters and lights at least 1 cm apart
+  Char<32> status = "";
+
+  void setup() override {
+    addControl(fileName, "file", "text", 0, 32);
+    addControl(scale, "scale", "number", 1, 1000);
+    addControl(status, "status", "text", 0, 32, true);  // read only
+  }
+
+  void onUpdate(const Char<20>& oldValue, const JsonObject& control) override {
+    if (control["name"] == "file" || control["name"] == "scale") cacheChecked = false;  // remapping is requested by the node manager
+  }
+
+  // the cache is checked against the file once after a change, not in each mapping pass
+  bool cacheChecked = false;
+  size_t checkedSize = 0;
+  time_t checkedTime = 0;
+  uint8_t* chunk = nullptr;
+
+  void setStatus(const char* message) {
+    if (status == message) return;
+    updateControl("status", message);
+    moduleNodes->requestUIUpdate = true;
+  }
+
+  Char<40> cacheName() {
+    Char<40> name = fileName;
+    name += ".mlc";
+    return name;
+  }
+
+  uint32_t hashFile(File& source) {
+    uint32_t hash = LayoutFile::hashStart;
+    source.seek(0);
+    size_t bytesRead;
+    while ((bytesRead = source.read(chunk, LAYOUTFILE_CHUNK)) > 0) hash = LayoutFile::hash(hash, chunk, bytesRead);
+    return hash;
+  }
+
+  void parse(File& source, LayoutFile::Parser& parser) {
+    source.seek(0);
+    size_t bytesRead;
+    while ((bytesRead = source.read(chunk, LAYOUTFILE_CHUNK)) > 0) parser.feed((const char*)chunk, bytesRead);
+    parser.finish();
+  }
+
+  bool cacheIsValid(uint32_t sourceHash) {
+    File cache = ESPFS.open(cacheName().c_str());
+    if (!cache) return false;
+    LayoutFile::CacheHeader header;
+    bool valid = cache.read((uint8_t*)&header, sizeof(header)) == sizeof(header) && header.isValid(sourceHash, scale) && cache.size() == sizeof(header) + header.nrOfRecords * LayoutFile::recordSize;
+    cache.close();
+    return valid;
+  }
+
+  bool buildCache(File& source, uint32_t sourceHash) {
+    // first parse: the lowest coordinates (become 0) and the highest node number (xLights)
+    float min[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    uint32_t nrOfLights = 0;
+    uint32_t maxNodeNr = 0;
+    LayoutFile::Parser bounds;
+    bounds.onLight = [&](float x, float y, float z, uint32_t nodeNr) {
+      min[0] = MIN(min[0], x);
+      min[1] = MIN(min[1], y);
+      min[2] = MIN(min[2], z);
+      nrOfLights++;
+      maxNodeNr = MAX(maxNodeNr, nodeNr);
+    };
+    parse(source, bounds);
+    if (nrOfLights == 0) {
+      setStatus("no lights found");
+      return false;
+    }
+
+    // lights with a node number are put in wiring order first
+    uint8_t* ordered = nullptr;
+    if (maxNodeNr) {
+      ordered = allocMB<uint8_t>(maxNodeNr * LayoutFile::recordSize, "layout");
+      if (!ordered) {
+        setStatus("out of memory");
+        return false;
+      }
+      memset(ordered, 0xFF, maxNodeNr * LayoutFile::recordSize);  // marker: no light with this node number
+    }
+
+    // second parse: write the records
+    uint8_t* buffer = allocMB<uint8_t>(LAYOUTFILE_CHUNK, "layout");
+    File cache = ESPFS.open(cacheName().c_str(), FILE_WRITE);
+    LayoutFile::CacheHeader header;
+    header.scale = scale;
+    uint8_t noHeader[sizeof(header)] = {0};  // header written when complete
+    bool written = buffer && cache && cache.write(noHeader, sizeof(noHeader)) == sizeof(noHeader);
+
+    size_t bufferSize = 0;
+    bool lightsInPin = false;
+    auto put = [&](uint16_t x, uint16_t y, uint16_t z) {
+      if (!written) return;
+      LayoutFile::putRecord(&buffer[bufferSize], x, y, z);
+      bufferSize += LayoutFile::recordSize;
+      header.nrOfRecords++;
+      if (bufferSize + LayoutFile::recordSize > LAYOUTFILE_CHUNK) {
+        written = written && cache.write(buffer, bufferSize) == bufferSize;
+        bufferSize = 0;
+      }
+    };
+
+    LayoutFile::Parser lights;
+    lights.onLight = [&](float x, float y, float z, uint32_t nodeNr) {
+      uint16_t qx = LayoutFile::quantize(x, min[0], scale);
+      uint16_t qy = LayoutFile::quantize(y, min[1], scale);
+      uint16_t qz = LayoutFile::quantize(z, min[2], scale);
+      if (ordered && nodeNr)
+        LayoutFile::putRecord(&ordered[(nodeNr - 1) * LayoutFile::recordSize], qx, qy, qz);
+      else {
+        put(qx, qy, qz);
+        lightsInPin = true;
+      }
+    };
+    lights.onPin = [&]() {
+      if (lightsInPin) put(LayoutFile::marker, LayoutFile::marker_pin, UINT8_MAX);
+      lightsInPin = false;
+    };
+    if (written) parse(source, lights);
+
+    if (ordered) {
+      for (uint32_t i = 0; i < maxNodeNr; i++) {
+        const uint8_t* record = &ordered[i * LayoutFile::recordSize];
+        if (LayoutFile::recordValue(record, 0) == LayoutFile::marker) continue;
+        put(LayoutFile::recordValue(record, 0), LayoutFile::recordValue(record, 1), LayoutFile::recordValue(record, 2));
+        lightsInPin = true;
+      }
+      freeMB(ordered);
+    }
+    lights.onPin();  // lights after the last pin
+    if (bufferSize) written = written && cache.write(buffer, bufferSize) == bufferSize;
+    if (buffer) freeMB(buffer);
+
+    header.sourceHash = sourceHash;
+    written = written && cache.seek(0) && cache.write((uint8_t*)&header, sizeof(header)) == sizeof(header);
+    if (cache) cache.close();
+    if (!written) {
+      ESPFS.remove(cacheName().c_str());
+      setStatus("could not write cache");
+      return false;
+    }
+    EXT_LOGI(ML_TAG, "Layout %s: %d records cached", fileName.c_str(), header.nrOfRecords);
+    return true;
+  }
+
+  void readCache() {
+    File cache = ESPFS.open(cacheName().c_str());
+    if (!cache || !cache.seek(sizeof(LayoutFile::CacheHeader))) {
+      if (cache) cache.close();
+      return;
+    }
+    uint32_t nrOfLights = 0;
+    size_t bytesRead;
+    while ((bytesRead = cache.read(chunk, LAYOUTFILE_CHUNK / LayoutFile::recordSize * LayoutFile::recordSize)) > 0) {
+      for (size_t i = 0; i + LayoutFile::recordSize <= bytesRead; i += LayoutFile::recordSize) {
+        const uint8_t* record = &chunk[i];
+        if (LayoutFile::recordValue(record, 0) == LayoutFile::marker) {
+          if (LayoutFile::recordValue(record, 1) == LayoutFile::marker_pin) nextPin();
+        } else {
+          addLight(Coord3D(LayoutFile::recordValue(record, 0), LayoutFile::recordValue(record, 1), LayoutFile::recordValue(record, 2)));
+          nrOfLights++;
+        }
+      }
+    }
+    cache.close();
+    Char<32> message;
+    message.format("%d lights", nrOfLights);
+    setStatus(message.c_str());
+  }
+
+  bool hasOnLayout() const override { return true; }
+  uint32_t layoutVersion() const override { return fileVersion(fileName.c_str()); }
+  void onLayout() override {
+    File source = ESPFS.open(fileName.c_str());
+    if (!source || source.isDirectory()) {
+      if (source) source.close();
+      setStatus("file not found");
+      return;
+    }
+    chunk = allocMB<uint8_t>(LAYOUTFILE_CHUNK, "layout");  // not on the stack of the driver task
+    if (!chunk) {
+      source.close();
+      setStatus("out of memory");
+      return;
+    }
+
+    // a changed file is detected by size or time, the hash decides if the cache is still valid (e.g. the same file uploaded again)
+    if (!cacheChecked || source.size() != checkedSize || source.getLastWrite() != checkedTime) {
+      checkedSize = source.size();
+      checkedTime = source.getLastWrite();
+      uint32_t sourceHash = hashFile(source);
+      cacheChecked = cacheIsValid(sourceHash) || buildCache(source, sourceHash);
+    }
+    source.close();
+
+    if (cacheChecked) readCache();
+    freeMB(chunk);
+  }
+};
+
+#endif  // FT_MOONLIGHT
@@ -0,0 +1,295 @@
+/**
+    @title     MoonLight
+    @file      LayoutFile.h
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/moonlight/overview/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+#pragma once
+
+// Coordinate files used by the File layout. The parsers take chunks of text and do no file IO, see test/test_layout_file.
+//
+// Parser: streaming, feed the file in chunks of any size, no JSON document in memory. The format is detected from the first character:
+//   CSV (anything else): one light per line: x[,y[,z]], separated by comma, semicolon, space or tab. A line "pin" ends the lights of a pin.
+//     Lines starting with another word (e.g. a header x,y,z) are skipped, # starts a comment.
+//   JSON ([ or {): an array of lights: [[x,y,z],...], or an array of pins each with an array of lights: [[[x,y,z],...],[[x,y,z],...]].
+//     A light can also be an object: {"x":1,"y":2,"z":3}, the values are taken in order.
+//   xLights model (<, .xmodel export): the CustomModel attribute: cells separated by , rows by ; and layers by |,
+//     a cell contains the node number (wiring order) of the light at column (x), row (y), layer (z).
+//
+// Cache: the parsed and quantized lights, so mapping the layout again only reads the lights: CacheHeader followed by records of
+// 3 x uint16 little endian (x, y, z). A record with x == marker is not a light: y is the MarkerEnum, z its argument.
+// Also used by PhysicalLayer to cache the result of all layout nodes.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <functional>
+
+namespace LayoutFile {
+
+static const uint8_t version = 2;  // 2: pin marker records
+static const uint8_t recordSize = 6;
+static const uint16_t marker = UINT16_MAX;
+static const uint16_t maxCoordinate = UINT16_MAX - 1;
+static const uint32_t hashStart = 2166136261;  // FNV-1a
+
+struct CacheHeader {
+  char magic[4] = {'M', 'L', 'L', 'C'};
+  uint8_t version = LayoutFile::version;
+  uint8_t reserved = 0;
+  uint16_t scale = 1;        // quantization used (File layout)
+  uint32_t sourceHash = 0;   // FNV-1a of the coordinate file, or the layout key (PhysicalLayer)
+  uint32_t nrOfRecords = 0;  // lights and pin markers
+
+  bool isValid(uint32_t sourceHash, uint16_t scale) const { return memcmp(magic, "MLLC", 4) == 0 && version == LayoutFile::version && this->sourceHash == sourceHash && this->scale == scale; }
+};
+static_assert(sizeof(CacheHeader) == 16, "CacheHeader is stored as is");
+
+inline uint32_t hash(uint32_t hash, const uint8_t* data, size_t size) {
+  for (size_t i = 0; i < size; i++) hash = (hash ^ data[i]) * 16777619;
+  return hash;
+}
+
+inline void putRecord(uint8_t* out, uint16_t x, uint16_t y, uint16_t z) {
+  out[0] = x;
+  out[1] = x >> 8;
+  out[2] = y;
+  out[3] = y >> 8;
+  out[4] = z;
+  out[5] = z >> 8;
+}
+
+inline uint16_t recordValue(const uint8_t* record, uint8_t axis) { return record[axis * 2] | (record[axis * 2 + 1] << 8); }
+
+// coordinate file value to cache value: min of the axis becomes 0, multiplied by scale
+inline uint16_t quantize(float value, float min, uint16_t scale) {
+  float q = roundf((value - min) * scale);
+  return q <= 0 ? 0 : q >= maxCoordinate ? maxCoordinate : (uint16_t)q;
+}
+
+enum MarkerEnum {
+  marker_pin,   // end of the lights of a pin, z: ledPinDIO (UINT8_MAX: next pin)
+  marker_node,  // start of the lights of layout node z (PhysicalLayer)
+};
+
+enum Format { format_unknown, format_csv, format_json, format_xlights };
+
+class Parser {
+ public:
+  // nodeNr: wiring order of the light (xLights), 0 if the lights are in wiring order
+  std::function<void(float x, float y, float z, uint32_t nodeNr)> onLight;
+  std::function<void()> onPin;
+
+  Format format = format_unknown;
+
+  void feed(const char* data, size_t size) {
+    for (size_t i = 0; i < size; i++) feed(data[i]);
+  }
+
+  // end of file
+  void finish() {
+    if (format == format_csv) endLine();
+    if (format == format_xlights && inModel) endCell();
+  }
+
+ private:
+  char number[24];
+  uint8_t numberLength = 0;
+  float values[3];
+  uint8_t nrOfValues = 0;
+
+  // csv
+  bool lineStart = true;
+  bool skipLine = false;  // rest of the line is a comment or a word line
+  bool wordLine = false;  // line starting with a word, no light
+  char word[4];
+  uint8_t wordLength = 0;
+  bool inWord = false;
+
+  // json
+  static const uint8_t maxDepth = 16;
+  uint8_t depth = 0;
+  bool hasLights[maxDepth];  // an array at this depth contains lights
+  bool inString = false;
+  bool escape = false;
+
+  // xLights
+  static constexpr const char* modelAttribute = "CustomModel=\"";
+  uint8_t matched = 0;
+  bool inModel = false;
+  bool modelDone = false;  // only the first model in the file
+  uint16_t column = 0;
+  uint16_t row = 0;
+  uint16_t layer = 0;
+
+  static bool isNumberStart(char c) { return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.'; }
+
+  void feed(char c) {
+    if (format == format_unknown) {
+      if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || (uint8_t)c >= 0x80) return;  // whitespace and UTF-8 byte order mark
+      format = c == '[' || c == '{' ? format_json : c == '<' ? format_xlights : format_csv;
+    }
+    switch (format) {
+      case format_csv:
+        feedCSV(c);
+        break;
+      case format_json:
+        feedJSON(c);
+        break;
+      case format_xlights:
+        feedXLights(c);
+        break;
+      default:
+        break;
+    }
+  }
+
+  // returns true if c is part of a number
+  bool feedNumber(char c) {
+    if (isNumberStart(c) || (numberLength && (c == 'e' || c == 'E'))) {
+      if (numberLength < sizeof(number) - 1) number[numberLength++] = c;
+      return true;
+    }
+    if (numberLength) {
+      number[numberLength] = '\0';
+      if (nrOfValues < 3) values[nrOfValues++] = strtof(number, nullptr);  // more values (e.g. a color column) are ignored
+      numberLength = 0;
+    }
+    return false;
+  }
+
+  void emitLight(uint32_t nodeNr = 0) {
+    if (onLight) onLight(values[0], nrOfValues > 1 ? values[1] : 0, nrOfValues > 2 ? values[2] : 0, nodeNr);
+  }
+
+  void endLine() {
+    feedNumber('\n');
+    if (wordLength == 3 && strncmp(word, "pin", 3) == 0) {
+      if (onPin) onPin();
+    } else if (!wordLine && nrOfValues)
+      emitLight();
+    nrOfValues = 0;
+    lineStart = true;
+    skipLine = false;
+    wordLine = false;
+    inWord = false;
+    wordLength = 0;
+  }
+
+  void feedCSV(char c) {
+    if (c == '\n' || c == '\r') {
+      endLine();
+      return;
+    }
+    if (skipLine) {
+      char lower = c | 0x20;
+      if (inWord && lower >= 'a' && lower <= 'z') {
+        if (wordLength < sizeof(word)) word[wordLength++] = lower;  // longer words end with wordLength 4: not a known word
+      } else
+        inWord = false;
+      return;
+    }
+    if (c == '#') {
+      feedNumber(c);
+      skipLine = true;
+      return;
+    }
+    if (lineStart && c != ' ' && c != '\t') {
+      lineStart = false;
+      char lower = c | 0x20;
+      if (lower >= 'a' && lower <= 'z') {
+        skipLine = true;
+        wordLine = true;
+        inWord = true;
+        word[0] = lower;
+        wordLength = 1;
+        return;
+      }
+    }
+    feedNumber(c);
+  }
+
+  void feedJSON(char c) {
+    if (inString) {
+      if (escape)
+        escape = false;
+      else if (c == '\\')
+        escape = true;
+      else if (c == '"')
+        inString = false;
+      return;
+    }
+    if (feedNumber(c)) return;
+    if (c == '"')
+      inString = true;
+    else if (c == '[' || c == '{') {
+      if (depth < maxDepth) hasLights[depth] = false;
+      depth++;
+      nrOfValues = 0;
+    } else if ((c == ']' || c == '}') && depth) {
+      depth--;
+      if (nrOfValues) {
+        emitLight();
+        if (depth && depth <= maxDepth) hasLights[depth - 1] = true;
+      } else if (depth < maxDepth && hasLights[depth]) {
+        if (onPin) onPin();
+      }
+      nrOfValues = 0;
+    }
+  }
+
+  void endCell() {
+    feedNumber(',');
+    if (nrOfValues && values[0] >= 1) {
+      values[1] = row;
+      values[2] = layer;
+      uint32_t nodeNr = values[0];
+      values[0] = column;
+      nrOfValues = 3;
+      emitLight(nodeNr);
+    }
+    nrOfValues = 0;
+  }
+
+  void feedXLights(char c) {
+    if (modelDone) return;
+    if (!inModel) {
+      if (c == modelAttribute[matched])
+        matched++;
+      else
+        matched = c == modelAttribute[0] ? 1 : 0;
+      if (modelAttribute[matched] == '\0') {
+        inModel = true;
+        matched = 0;
+      }
+      return;
+    }
+    if (c >= '0' && c <= '9') {
+      feedNumber(c);
+      return;
+    }
+    if (c == ',' || c == ';' || c == '|' || c == '"') endCell();
+    if (c == ',')
+      column++;
+    else if (c == ';') {
+      row++;
+      column = 0;
+    } else if (c == '|') {
+      layer++;
+      row = 0;
+      column = 0;
+    } else if (c == '"') {
+      inModel = false;
+      modelDone = true;
+    }
+  }
+};
+
+}  // namespace LayoutFile
@@ -17,6 +17,7 @@ class CircleModifier : public Node {
   static const char* name() { return "Circle"; }
   static uint8_t dim() { return _2D; }  // 1D to 2D ...
   static const char* tags() { return "💎🐙"; }
+  static constexpr NodeCaps caps() { return {.readsPrevious = false}; }
 
   Coord3D modifierSize;
 
@@ -53,6 +54,7 @@ class MirrorModifier : public Node {
   static const char* name() { return "Mirror"; }
   static uint8_t dim() { return _3D; }
   static const char* tags() { return "💎🐙"; }
+  static constexpr NodeCaps caps() { return {.readsPrevious = false}; }
 
   bool mirrorX = true;
   bool mirrorY = false;
@@ -88,6 +90,7 @@ class MultiplyModifier : public Node {
   static const char* name() { return "Multiply"; }
   static uint8_t dim() { return _3D; }
   static const char* tags() { return "💎"; }
+  static constexpr NodeCaps caps() { return {.readsPrevious = false}; }
 
   Coord3D proMulti = {2, 2, 2};
   bool mirror = false;
@@ -120,6 +123,7 @@ class PinwheelModifier : public Node {
   static const char* name() { return "Pinwheel"; }
   static uint8_t dim() { return _3D; }  // test zTwist...
   static const char* tags() { return "💎"; }
+  static constexpr NodeCaps caps() { return {.readsPrevious = false}; }
 
   uint8_t petals = 60;
   uint8_t swirlVal = 30;
@@ -142,7 +146,7 @@ class PinwheelModifier : public Node {
 
   void modifySize() override {
     if (layer->layerDimension > _1D && layer->effectDimension > _1D) {
-      layer->size.y = sqrt(sq(max<uint8_t>(layer->size.x - layer->middle.x, layer->middle.x)) + sq(max<uint8_t>(layer->size.y - layer->middle.y, layer->middle.y))) + 1;  // Adjust y before x
+      layer->size.y = sqrt(sq(max<int>(layer->size.x - layer->middle.x, layer->middle.x)) + sq(max<int>(layer->size.y - layer->middle.y, layer->middle.y))) + 1;  // Adjust y before x
       layer->size.x = petals;
       layer->size.z = 1;
     } else {
@@ -268,6 +272,7 @@ class RotateModifier : public Node {
   static const char* name() { return "Rotate"; }
   static uint8_t dim() { return _2D; }
   static const char* tags() { return "💎💫"; }
+  static constexpr NodeCaps caps() { return {.readsPrevious = false}; }
 
   bool expand = false;
   bool flip, reverse, alternate;
@@ -294,7 +299,7 @@ class RotateModifier : public Node {
 
   void modifySize() override {
     if (expand) {
-      uint8_t size = MAX(layer->size.x, MAX(layer->size.y, layer->size.z));
+      uint16_t size = MAX(layer->size.x, MAX(layer->size.y, layer->size.z));
       size = sqrt(size * size * 2) + 1;
       Coord3D offset = Coord3D((size - layer->size.x) / 2, (size - layer->size.y) / 2, 0);
 
@@ -354,9 +359,12 @@ class RotateModifier : public Node {
       shearY = sinf(angleRadians) * Fixed_Scale;       // f by softhack007
 
       prevAngle = angle;
+      layer->invalidateXYZ();
     }
   }
 
+  bool hasModifyXYZ() const override { return true; }  // frame static: only changes with the angle
+
   void modifyXYZ(Coord3D& position) override {
     if (angle == 0) return;  // No rotation needed
     if (flip) {
@@ -381,7 +389,7 @@ class RotateModifier : public Node {
     if (x2 >= maxX || y1 >= maxY || x2 < 0 || y1 < 0)
       position = {INT16_MAX, INT8_MAX, 0};
     else
-      position = {static_cast<uint16_t>(x2), static_cast<uint8_t>(y1), 0};
+      position = {static_cast<uint16_t>(x2), static_cast<uint16_t>(y1), 0};
 
     // Translate position back and assign
     // position.x = x2 + midX;
@@ -395,6 +403,7 @@ class TransposeModifier : public Node {
   static const char* name() { return "Transpose"; }
   static uint8_t dim() { return _3D; }
   static const char* tags() { return "💎🐙"; }
+  static constexpr NodeCaps caps() { return {.readsPrevious = false}; }
 
   bool transposeXY = true;
   bool transposeXZ = false;
@@ -464,6 +473,7 @@ class CheckerboardModifier : public Node {
  public:
   static const char* name() { return "Checkerboard"; }
   static const char* tags() { return "💎💫"; }
+  static constexpr NodeCaps caps() { return {.readsPrevious = false}; }
 
   Coord3D size = {3, 3, 3};
   bool invert = false;
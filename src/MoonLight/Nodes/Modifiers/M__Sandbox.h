@@ -43,6 +43,7 @@ class ExampleModifier : public Node {
   void modifyPosition(Coord3D& position) override { position = modifierSize * 2 - 1 - position; }
 
   // modify the position of each light on each frame
+  bool hasModifyXYZ() const override { return true; }  // frame static (default of isModifyXYZStatic), call layer->invalidateXYZ() if its result changes
   void modifyXYZ(Coord3D& position) override { position = modifierSize - position; }
 };
 
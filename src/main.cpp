@@ -130,10 +130,12 @@ void effectTask(void* pvParameters) {
     // Check state under lock
     xSemaphoreTake(swapMutex, portMAX_DELAY);
 
-    if (layerP.lights.header.isPositions == 0 && !newFrameReady) {  // within mutex as driver task can change this
+    if (layerP.lights.header.isPositions == 0 && !newFrameReady && layerP.frameScheduler.isDue(micros())) {  // within mutex as driver task can change this
+      layerP.frameScheduler.beginFrame(micros());
+
       if (layerP.lights.useDoubleBuffer) {
         xSemaphoreGive(swapMutex);
-        memcpy(layerP.lights.channelsE, layerP.lights.channelsD, layerP.lights.header.nrOfChannels);  // Copy previous frame (channelsD) to working buffer (channelsE)
+        layerP.seedChannels();  // Copy previous frame (channelsD) to working buffer (channelsE), only what changed
       }
 
       layerP.loop();
@@ -143,12 +145,15 @@ void effectTask(void* pvParameters) {
         layerP.loop20ms();
       }
 
+      layerP.frameScheduler.endFrame(micros());
+
       if (layerP.lights.useDoubleBuffer) {  // Atomic swap channels
         xSemaphoreTake(swapMutex, portMAX_DELAY);
         uint8_t* temp = layerP.lights.channelsD;
         layerP.lights.channelsD = layerP.lights.channelsE;
         layerP.lights.channelsE = temp;
       }
+      layerP.swapDirty();
       newFrameReady = true;
     }
 
@@ -169,6 +174,7 @@ void driverTask(void* pvParameters) {
     if (layerP.lights.header.isPositions == 3) {
       EXT_LOGD(ML_TAG, "positions done (3 -> 0)");
       layerP.lights.header.isPositions = 0;
+      layerP.requestFullFrame = true;  // channelsE contained the positions
     }
 
     if (layerP.lights.header.isPositions == 0) {
@@ -321,8 +327,10 @@ void setup() {
 
   // MoonBase
   #if FT_ENABLED(FT_MOONBASE)
+  updateBus.clock = []() -> uint32_t { return micros(); };  // for the subscriber stats
   fileManager.begin();
   for (Module* module : modules) module->begin();
+  ModulePersistence::begin();  // writes the modules on save
 
   // 🌙
   xTaskCreateUniversal(effectTask,                          // task function
@@ -347,6 +355,8 @@ void setup() {
   // run UI stuff in the sveltekit task
   esp32sveltekit.addLoopFunction([]() {
     for (Module* module : modules) module->loop();
+    fileManager.loop();    // file changes of other tasks
+    updateBus.deliver();  // call the subscribers of changed files and controls
 
     // every second
     static unsigned long lastSecond = 0;
@@ -360,6 +370,10 @@ void setup() {
   #if FT_ENABLED(FT_MOONLIGHT)
       // set shared data (eg used in scrolling text effect)
       sharedData.fps = esp32sveltekit.getAnalyticsService()->lps;
+      esp32sveltekit.getAnalyticsService()->currentEstimate = layerP.estimatedCurrent / 1000.0;
+      esp32sveltekit.getAnalyticsService()->frameJitter = layerP.frameScheduler.stats.jitterAvg;
+      esp32sveltekit.getAnalyticsService()->frameOverruns = layerP.frameScheduler.stats.overruns;
+      esp32sveltekit.getAnalyticsService()->changed = layerP.changedPercent;
       sharedData.connectionStatus = (uint8_t)esp32sveltekit.getConnectionStatus();
       sharedData.clientListSize = esp32sveltekit.getServer()->getClientList().size();
       sharedData.connectedClients = esp32sveltekit.getSocket()->getConnectedClients();
@@ -0,0 +1,87 @@
+/**
+    @title     MoonBase
+    @file      test_main.cpp
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/develop/development/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+// ControlMessage: the 13 byte messages of socket.ts sendControl decode, anything else is rejected
+
+#include <unity.h>
+
+#include "MoonBase/ControlMessage.h"
+
+void setUp() {}
+void tearDown() {}
+
+// as socket.ts sendControl builds it
+static void encode(uint8_t* data, const char* module, uint8_t node, uint8_t control, uint8_t type, uint32_t raw) {
+  uint32_t hash = ControlMessage::hash(module);
+  data[0] = ControlMessage::marker;
+  data[1] = ControlMessage::version;
+  for (uint8_t i = 0; i < 4; i++) data[2 + i] = hash >> (8 * i);
+  data[6] = node;
+  data[7] = control;
+  data[8] = type;
+  for (uint8_t i = 0; i < 4; i++) data[9 + i] = raw >> (8 * i);
+}
+
+void test_int() {
+  uint8_t data[ControlMessage::size];
+  encode(data, "effects", 2, 5, ControlMessage::value_int, (uint32_t)-300);
+  ControlMessage::Message message;
+  TEST_ASSERT_TRUE(ControlMessage::isControlMessage(data, sizeof(data)));
+  TEST_ASSERT_TRUE(ControlMessage::decode(data, sizeof(data), message));
+  TEST_ASSERT_EQUAL_UINT32(ControlMessage::hash("effects"), message.moduleHash);
+  TEST_ASSERT_EQUAL(2, message.node);
+  TEST_ASSERT_EQUAL(5, message.control);
+  TEST_ASSERT_EQUAL(-300, message.asInt());
+  TEST_ASSERT_TRUE(message.asFloat() == -300.0f);
+}
+
+void test_float() {
+  float value = 2.75f;
+  uint32_t raw;
+  memcpy(&raw, &value, 4);
+  uint8_t data[ControlMessage::size];
+  encode(data, "drivers", 0, 1, ControlMessage::value_float, raw);
+  ControlMessage::Message message;
+  TEST_ASSERT_TRUE(ControlMessage::decode(data, sizeof(data), message));
+  TEST_ASSERT_TRUE(message.asFloat() == 2.75f);
+  TEST_ASSERT_EQUAL(2, message.asInt());
+}
+
+void test_rejected() {
+  uint8_t data[ControlMessage::size + 1];
+  encode(data, "effects", 0, 0, ControlMessage::value_int, 1);
+  ControlMessage::Message message;
+  TEST_ASSERT_FALSE(ControlMessage::decode(data, ControlMessage::size - 1, message));  // too short
+  TEST_ASSERT_FALSE(ControlMessage::decode(data, ControlMessage::size + 1, message));  // too long
+  data[8] = 2;                                                                            // unknown type
+  TEST_ASSERT_FALSE(ControlMessage::decode(data, ControlMessage::size, message));
+  data[8] = ControlMessage::value_int;
+  data[1] = ControlMessage::version + 1;
+  TEST_ASSERT_FALSE(ControlMessage::decode(data, ControlMessage::size, message));
+  data[0] = 0x82;  // a MsgPack map: an event
+  TEST_ASSERT_FALSE(ControlMessage::isControlMessage(data, ControlMessage::size));
+  TEST_ASSERT_FALSE(ControlMessage::isControlMessage(data, 0));
+}
+
+// FNV-1a as in socket.ts
+void test_hash() {
+  TEST_ASSERT_EQUAL_UINT32(2166136261u, ControlMessage::hash(""));
+  TEST_ASSERT_EQUAL_UINT32(0xE40C292Cu, ControlMessage::hash("a"));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_int);
+  RUN_TEST(test_float);
+  RUN_TEST(test_rejected);
+  RUN_TEST(test_hash);
+  return UNITY_END();
+}
@@ -0,0 +1,187 @@
+/**
+    @title     MoonLight
+    @file      test_main.cpp
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/develop/development/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+// Dither: the 8.8 LUT matches the 8 bit maps of the leds driver, the thresholds average out to the 8.8 value
+
+#include <math.h>
+#include <stdio.h>
+#include <unity.h>
+
+#include <chrono>
+#include <set>
+
+#include "MoonLight/Nodes/Drivers/Dither.h"
+
+void setUp() {}
+void tearDown() {}
+
+// as the leds driver: brightness scaled linear
+static void linearMap(uint8_t* map, uint8_t brightness) {
+  for (uint16_t v = 0; v < 256; v++) map[v] = (v * (1 + brightness)) >> 8;
+}
+
+// gamma curve with brightness, steps of more than 1 at the top
+static void gammaMap(uint8_t* map, uint8_t brightness) {
+  for (uint16_t v = 0; v < 256; v++) map[v] = round(pow(v / 255.0, 2.2) * brightness);
+}
+
+static Dither::Lut lut;
+
+static void build(uint8_t maps[4][256]) {
+  const uint8_t* const mapPointers[4] = {maps[0], maps[1], maps[2], maps[3]};
+  lut.build(mapPointers);
+}
+
+// each brightness, linear and gamma, in the 4 channels
+static void forEachMap(void (*check)(const uint8_t* map8, const uint16_t* map)) {
+  static uint8_t maps[4][256];
+  for (uint16_t brightness = 0; brightness < 256; brightness += 5) {
+    linearMap(maps[0], brightness);
+    gammaMap(maps[1], brightness);
+    linearMap(maps[2], 255 - brightness);
+    gammaMap(maps[3], 255 - brightness);
+    build(maps);
+    for (uint8_t c = 0; c < 4; c++) check(maps[c], lut.map[c]);
+  }
+}
+
+void test_integer_part_is_map() {
+  forEachMap([](const uint8_t* map8, const uint16_t* map) {
+    for (uint16_t v = 0; v < 256; v++) TEST_ASSERT_EQUAL_UINT8(map8[v], map[v] >> 8);
+  });
+}
+
+// dither on shows the value of dither off or one above it, and never wraps around at 255
+void test_output_is_map_or_one_above() {
+  forEachMap([](const uint8_t* map8, const uint16_t* map) {
+    for (uint16_t v = 0; v < 256; v++) {
+      for (uint16_t t = 0; t < 256; t++) {
+        uint8_t out = Dither::apply(map[v], t);
+        TEST_ASSERT_TRUE(out == map8[v] || out == map8[v] + 1);
+      }
+    }
+  });
+}
+
+void test_zero_and_full() {
+  forEachMap([](const uint8_t* map8, const uint16_t* map) {
+    for (uint16_t t = 0; t < 256; t++) {
+      if (map8[0] == 0) TEST_ASSERT_EQUAL_UINT8(0, Dither::apply(map[0], t));
+      if (map8[255] == 255) TEST_ASSERT_EQUAL_UINT8(255, Dither::apply(map[255], t));
+    }
+  });
+}
+
+void test_monotonic() {
+  forEachMap([](const uint8_t*, const uint16_t* map) {
+    for (uint16_t v = 1; v < 256; v++) TEST_ASSERT_LESS_OR_EQUAL(map[v], map[v - 1]);
+  });
+}
+
+// 256 frames use each threshold once, for each channel
+void test_thresholds_cover_all() {
+  const uint32_t indexes[] = {0, 1, 2, 3, 100, 12345};
+  for (uint32_t index : indexes) {
+    bool seen[256] = {};
+    for (uint16_t frame = 0; frame < 256; frame++) seen[Dither::threshold(Dither::frameThreshold(frame), index)] = true;
+    for (uint16_t t = 0; t < 256; t++) TEST_ASSERT_TRUE(seen[t]);
+  }
+}
+
+// the sum over 256 frames is the 8.8 value: exact average. After 16 frames within 1/16
+void test_average() {
+  forEachMap([](const uint8_t*, const uint16_t* map) {
+    for (uint16_t v = 0; v < 256; v += 3) {
+      uint32_t sum = 0, sum16 = 0;
+      for (uint16_t frame = 0; frame < 256; frame++) {
+        uint8_t out = Dither::apply(map[v], Dither::threshold(Dither::frameThreshold(frame), v));
+        sum += out;
+        if (frame < 16) sum16 += out;
+      }
+      TEST_ASSERT_EQUAL_UINT32(map[v], sum);
+      TEST_ASSERT_UINT_WITHIN(16, map[v] >> 4, sum16);
+    }
+  });
+}
+
+// at low brightness the 8 bit map has a few levels left, dithered there are many more (visible as smooth fades)
+void test_levels_at_low_brightness() {
+  static uint8_t maps[4][256];
+  const uint8_t brightnesses[] = {10, 20, 40};
+  for (uint8_t brightness : brightnesses) {
+    for (uint8_t c = 0; c < 4; c++) linearMap(maps[c], brightness);
+    build(maps);
+    std::set<uint8_t> levels8;
+    std::set<uint16_t> levels;
+    for (uint16_t v = 0; v < 256; v++) {
+      levels8.insert(maps[0][v]);
+      levels.insert(lut.map[0][v]);
+    }
+    char message[64];
+    snprintf(message, sizeof(message), "brightness %d: %d levels, dithered %d", brightness, (int)levels8.size(), (int)levels.size());
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_THAN(4 * levels8.size(), levels.size());
+  }
+}
+
+void test_rebuild_when_maps_change() {
+  static uint8_t maps[4][256];
+  for (uint8_t c = 0; c < 4; c++) linearMap(maps[c], 255);
+  build(maps);
+  TEST_ASSERT_EQUAL_UINT16(0xFF00, lut.map[2][255]);
+  linearMap(maps[2], 127);
+  build(maps);
+  TEST_ASSERT_EQUAL_UINT8(maps[2][255], lut.map[2][255] >> 8);
+  TEST_ASSERT_EQUAL_UINT16(0xFF00, lut.map[1][255]);
+}
+
+// not an assert: ns per channel of the dithered and the 8 bit conversion
+void test_benchmark() {
+  static uint8_t maps[4][256];
+  for (uint8_t c = 0; c < 4; c++) gammaMap(maps[c], 128);
+  build(maps);
+  static uint8_t in[3 * 1024], out[3 * 1024];
+  for (uint16_t i = 0; i < sizeof(in); i++) in[i] = i * 7;
+  const uint16_t frames = 1000;
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint16_t frame = 0; frame < frames; frame++) {
+    for (uint16_t i = 0; i < sizeof(in); i++) out[i] = maps[i % 3][in[i]];
+    asm volatile("" : : "r"(out) : "memory");
+  }
+  auto mapped = std::chrono::steady_clock::now();
+  for (uint16_t frame = 0; frame < frames; frame++) {
+    uint8_t frameThreshold = Dither::frameThreshold(frame);
+    for (uint16_t i = 0; i < sizeof(in); i++) out[i] = Dither::apply(lut.map[i % 3][in[i]], Dither::threshold(frameThreshold, i));
+    asm volatile("" : : "r"(out) : "memory");
+  }
+  auto dithered = std::chrono::steady_clock::now();
+
+  double channels = (double)frames * sizeof(in);
+  char message[64];
+  snprintf(message, sizeof(message), "8 bit %.2f ns, dithered %.2f ns per channel", std::chrono::duration<double, std::nano>(mapped - start).count() / channels,
+           std::chrono::duration<double, std::nano>(dithered - mapped).count() / channels);
+  TEST_MESSAGE(message);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_integer_part_is_map);
+  RUN_TEST(test_output_is_map_or_one_above);
+  RUN_TEST(test_zero_and_full);
+  RUN_TEST(test_monotonic);
+  RUN_TEST(test_thresholds_cover_all);
+  RUN_TEST(test_average);
+  RUN_TEST(test_levels_at_low_brightness);
+  RUN_TEST(test_rebuild_when_maps_change);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
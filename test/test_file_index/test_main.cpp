@@ -0,0 +1,124 @@
+/**
+    @title     MoonBase
+    @file      test_main.cpp
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/develop/development/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+// FileIndex: paths are found, listed in name order and kept up to date on set, remove and rename
+
+#include <unity.h>
+
+#include <string>
+#include <vector>
+
+#include "MoonBase/Modules/FileIndex.h"
+
+static FileIndex* fileIndex;
+
+void setUp() {
+  fileIndex = new FileIndex();
+  fileIndex->set("/.config/lightscontrol.json", true, 100);
+  fileIndex->set("/presets/b.json", true, 20);
+  fileIndex->set("/presets/a.json", true, 10);
+  fileIndex->set("/presets/c.json", true, 30);
+  fileIndex->set("/scripts", false);
+}
+void tearDown() { delete fileIndex; }
+
+static std::vector<std::string> names(const char* folder, bool showHidden = true, size_t offset = 0, size_t limit = 0) {
+  std::vector<std::string> result;
+  fileIndex->list(fileIndex->find(folder), showHidden, offset, limit, [&](int32_t, const FileIndex::Entry& entry) { result.push_back(entry.name); });
+  return result;
+}
+
+void test_find() {
+  int32_t i = fileIndex->find("/presets/b.json");
+  TEST_ASSERT_TRUE(i != FileIndex::notFound);
+  TEST_ASSERT_TRUE(fileIndex->entry(i).isFile);
+  TEST_ASSERT_EQUAL_UINT32(20, fileIndex->entry(i).size);
+  TEST_ASSERT_EQUAL_STRING("/presets/b.json", fileIndex->path(i).c_str());
+  TEST_ASSERT_EQUAL(FileIndex::root, fileIndex->find("/"));
+  TEST_ASSERT_EQUAL(fileIndex->find("/presets"), fileIndex->find("presets/"));
+  TEST_ASSERT_EQUAL(FileIndex::notFound, fileIndex->find("/presets/d.json"));
+  TEST_ASSERT_EQUAL(FileIndex::notFound, fileIndex->find("/presets/b.json/x"));
+  TEST_ASSERT_FALSE(fileIndex->entry(fileIndex->find("/scripts")).isFile);
+  TEST_ASSERT_EQUAL(8, fileIndex->size());  // root, .config, its file, presets, 3 presets, scripts
+}
+
+void test_list_sorted_and_paged() {
+  std::vector<std::string> all = names("/presets");
+  TEST_ASSERT_EQUAL(3, all.size());
+  TEST_ASSERT_EQUAL_STRING("a.json", all[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("c.json", all[2].c_str());
+  std::vector<std::string> page = names("/presets", true, 1, 1);
+  TEST_ASSERT_EQUAL(1, page.size());
+  TEST_ASSERT_EQUAL_STRING("b.json", page[0].c_str());
+  TEST_ASSERT_EQUAL(3, fileIndex->list(fileIndex->find("/presets"), true, 2, 1, [](int32_t, const FileIndex::Entry&) {}));  // total in the folder
+}
+
+void test_hidden() {
+  TEST_ASSERT_EQUAL(3, fileIndex->count(FileIndex::root, true));
+  TEST_ASSERT_EQUAL(2, fileIndex->count(FileIndex::root, false));
+  std::vector<std::string> visible = names("/", false);
+  TEST_ASSERT_EQUAL_STRING("presets", visible[0].c_str());
+}
+
+void test_update() {
+  int32_t i = fileIndex->set("/presets/a.json", true, 11, 5);
+  TEST_ASSERT_EQUAL(i, fileIndex->find("/presets/a.json"));
+  TEST_ASSERT_EQUAL_UINT32(11, fileIndex->entry(i).size);
+  TEST_ASSERT_EQUAL_UINT32(5, fileIndex->entry(i).time);
+  TEST_ASSERT_EQUAL(8, fileIndex->size());
+}
+
+void test_remove_folder() {
+  TEST_ASSERT_TRUE(fileIndex->remove("/presets"));
+  TEST_ASSERT_EQUAL(FileIndex::notFound, fileIndex->find("/presets/a.json"));
+  TEST_ASSERT_EQUAL(4, fileIndex->size());
+  TEST_ASSERT_FALSE(fileIndex->remove("/presets"));
+  TEST_ASSERT_FALSE(fileIndex->remove("/"));
+  fileIndex->set("/x/y/z.sc", true);  // removed entries are reused
+  TEST_ASSERT_EQUAL(7, fileIndex->size());
+  TEST_ASSERT_EQUAL_STRING("/x/y/z.sc", fileIndex->path(fileIndex->find("/x/y/z.sc")).c_str());
+}
+
+void test_rename() {
+  TEST_ASSERT_TRUE(fileIndex->rename("/presets/c.json", "/presets/0.json"));
+  std::vector<std::string> all = names("/presets");
+  TEST_ASSERT_EQUAL_STRING("0.json", all[0].c_str());  // sorted again
+  TEST_ASSERT_EQUAL_UINT32(30, fileIndex->entry(fileIndex->find("/presets/0.json")).size);
+
+  TEST_ASSERT_TRUE(fileIndex->rename("/presets", "/scripts/old"));  // folder with contents, to a new folder
+  TEST_ASSERT_TRUE(fileIndex->find("/scripts/old/a.json") != FileIndex::notFound);
+  TEST_ASSERT_EQUAL(FileIndex::notFound, fileIndex->find("/presets"));
+
+  TEST_ASSERT_TRUE(fileIndex->rename("/scripts/old/a.json", "/scripts/old/b.json"));  // replaces b.json
+  TEST_ASSERT_EQUAL(2, names("/scripts/old").size());
+  TEST_ASSERT_EQUAL_UINT32(10, fileIndex->entry(fileIndex->find("/scripts/old/b.json")).size);
+  TEST_ASSERT_FALSE(fileIndex->rename("/nothing", "/x"));
+}
+
+// a file replaced by a folder of the same name and back
+void test_file_and_folder() {
+  fileIndex->set("/scripts/a.sc", true);
+  fileIndex->set("/scripts", true, 5);
+  TEST_ASSERT_EQUAL(FileIndex::notFound, fileIndex->find("/scripts/a.sc"));
+  TEST_ASSERT_EQUAL(0, fileIndex->count(fileIndex->find("/scripts"), true));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_find);
+  RUN_TEST(test_list_sorted_and_paged);
+  RUN_TEST(test_hidden);
+  RUN_TEST(test_update);
+  RUN_TEST(test_remove_folder);
+  RUN_TEST(test_rename);
+  RUN_TEST(test_file_and_folder);
+  return UNITY_END();
+}
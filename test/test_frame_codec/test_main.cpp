@@ -0,0 +1,137 @@
+/**
+    @title     MoonLight
+    @file      test_main.cpp
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/develop/development/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+// FrameCodec: frames encoded by the recorder decode to the same frames in the player
+
+#include <unity.h>
+
+#include <vector>
+
+#include "MoonLight/Nodes/Drivers/FrameCodec.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const uint32_t nrOfChannels = 300;
+
+// a moving dot on a background, with a few channels changing each frame
+static void makeFrame(uint8_t* frame, uint32_t frameNr) {
+  for (uint32_t i = 0; i < nrOfChannels; i++) frame[i] = i / 30;
+  frame[(frameNr * 3) % nrOfChannels] = 255;
+  frame[(frameNr * 7 + 1) % nrOfChannels] = frameNr;
+}
+
+void test_round_trip() {
+  std::vector<uint8_t> stream;
+  uint8_t frame[nrOfChannels], prev[nrOfChannels];
+  uint8_t out[FrameCodec::recordHeaderSize + nrOfChannels];
+  for (uint32_t f = 0; f < 100; f++) {
+    makeFrame(frame, f);
+    size_t size = FrameCodec::encodeFrame(frame, f % 50 == 0 ? nullptr : prev, nrOfChannels, out);
+    TEST_ASSERT_LESS_OR_EQUAL(FrameCodec::maxRecordSize(nrOfChannels), size);
+    stream.insert(stream.end(), out, out + size);
+    memcpy(prev, frame, nrOfChannels);
+  }
+
+  uint8_t decoded[nrOfChannels];
+  size_t offset = 0;
+  for (uint32_t f = 0; f < 100; f++) {
+    const uint8_t* record = &stream[offset];
+    TEST_ASSERT_EQUAL(f % 50 == 0 ? FrameCodec::keyFrame : FrameCodec::deltaFrame, FrameCodec::recordType(record));
+    TEST_ASSERT_TRUE(FrameCodec::decodeFrame(record, decoded, nrOfChannels));
+    makeFrame(frame, f);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame, decoded, nrOfChannels);
+    offset += FrameCodec::recordHeaderSize + FrameCodec::recordPayloadSize(record);
+  }
+  TEST_ASSERT_EQUAL(stream.size(), offset);
+}
+
+void test_unchanged_frame_is_header_only() {
+  uint8_t frame[nrOfChannels];
+  uint8_t out[FrameCodec::recordHeaderSize + nrOfChannels];
+  makeFrame(frame, 1);
+  TEST_ASSERT_EQUAL(FrameCodec::recordHeaderSize, FrameCodec::encodeFrame(frame, frame, nrOfChannels, out));
+  TEST_ASSERT_EQUAL(FrameCodec::deltaFrame, FrameCodec::recordType(out));
+}
+
+void test_large_change_is_key_frame() {
+  uint8_t frame[nrOfChannels], prev[nrOfChannels];
+  uint8_t out[FrameCodec::recordHeaderSize + nrOfChannels];
+  for (uint32_t i = 0; i < nrOfChannels; i++) {
+    frame[i] = i;
+    prev[i] = i + 1;
+  }
+  TEST_ASSERT_EQUAL(FrameCodec::maxRecordSize(nrOfChannels), FrameCodec::encodeFrame(frame, prev, nrOfChannels, out));
+  TEST_ASSERT_EQUAL(FrameCodec::keyFrame, FrameCodec::recordType(out));
+}
+
+void test_varint() {
+  const uint32_t values[] = {0, 1, 127, 128, 16383, 16384, 0xFFFFFFFF};
+  for (uint32_t value : values) {
+    uint8_t buffer[5];
+    size_t size = FrameCodec::putVarint(buffer, value);
+    const uint8_t* in = buffer;
+    uint32_t decoded;
+    TEST_ASSERT_TRUE(FrameCodec::getVarint(in, buffer + size, decoded));
+    TEST_ASSERT_EQUAL_UINT32(value, decoded);
+    TEST_ASSERT_EQUAL(size, in - buffer);
+  }
+}
+
+void test_corrupt_records() {
+  uint8_t frame[nrOfChannels], prev[nrOfChannels], decoded[nrOfChannels];
+  uint8_t out[FrameCodec::recordHeaderSize + nrOfChannels];
+  makeFrame(prev, 0);
+  makeFrame(frame, 1);
+  size_t size = FrameCodec::encodeFrame(frame, prev, nrOfChannels, out);
+  TEST_ASSERT_EQUAL(FrameCodec::deltaFrame, FrameCodec::recordType(out));
+
+  // a run past the end of the frame
+  uint8_t skip[5];
+  size_t skipSize = FrameCodec::putVarint(skip, nrOfChannels);
+  uint8_t bad[16];
+  memcpy(bad + FrameCodec::recordHeaderSize, skip, skipSize);
+  bad[FrameCodec::recordHeaderSize + skipSize] = 1;  // count
+  bad[FrameCodec::recordHeaderSize + skipSize + 1] = 0;
+  FrameCodec::writeRecordHeader(bad, skipSize + 2, FrameCodec::deltaFrame);
+  memcpy(decoded, prev, nrOfChannels);
+  TEST_ASSERT_FALSE(FrameCodec::decodeFrame(bad, decoded, nrOfChannels));
+
+  // payload cut short
+  FrameCodec::writeRecordHeader(out, size - FrameCodec::recordHeaderSize - 1, FrameCodec::deltaFrame);
+  TEST_ASSERT_FALSE(FrameCodec::decodeFrame(out, decoded, nrOfChannels));
+
+  // key frame of the wrong size, unknown type
+  FrameCodec::writeRecordHeader(out, nrOfChannels - 1, FrameCodec::keyFrame);
+  TEST_ASSERT_FALSE(FrameCodec::decodeFrame(out, decoded, nrOfChannels));
+  FrameCodec::writeRecordHeader(out, 0, 7);
+  TEST_ASSERT_FALSE(FrameCodec::decodeFrame(out, decoded, nrOfChannels));
+}
+
+void test_file_header() {
+  FrameCodec::FileHeader header;
+  TEST_ASSERT_FALSE(header.isValid());  // no channels
+  header.nrOfChannels = nrOfChannels;
+  TEST_ASSERT_TRUE(header.isValid());
+  header.magic[0] = 'X';
+  TEST_ASSERT_FALSE(header.isValid());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip);
+  RUN_TEST(test_unchanged_frame_is_header_only);
+  RUN_TEST(test_large_change_is_key_frame);
+  RUN_TEST(test_varint);
+  RUN_TEST(test_corrupt_records);
+  RUN_TEST(test_file_header);
+  return UNITY_END();
+}
@@ -0,0 +1,145 @@
+/**
+    @title     MoonLight
+    @file      test_main.cpp
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/develop/development/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+// FrameScheduler: free and fixed pacing of the animation time, skipped slots and the deadline
+
+#include <unity.h>
+
+#include "MoonLight/Layers/FrameScheduler.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const uint32_t interval = 20000;  // µs at 50 FPS
+
+// begin and end a frame which takes renderUs
+static void frame(FrameScheduler& scheduler, uint32_t startUs, uint32_t renderUs = 5000) {
+  scheduler.beginFrame(startUs);
+  scheduler.endFrame(startUs + renderUs);
+}
+
+void test_free_uses_measured_time() {
+  FrameScheduler scheduler;
+  TEST_ASSERT_EQUAL_UINT32(0, scheduler.interval());
+  frame(scheduler, 1000000);
+  TEST_ASSERT_EQUAL_UINT32(0, scheduler.frameMillis);
+  TEST_ASSERT_TRUE(scheduler.isDue(1000001));
+  frame(scheduler, 1016000);
+  TEST_ASSERT_EQUAL(16, scheduler.frameDelta);
+  frame(scheduler, 1041000);
+  TEST_ASSERT_EQUAL(25, scheduler.frameDelta);
+  TEST_ASSERT_EQUAL_UINT32(41, scheduler.frameMillis);
+  TEST_ASSERT_FALSE(scheduler.skipOptional);
+}
+
+// frames start late by a varying amount, the animation time still advances one interval per frame
+void test_fixed_steps_one_interval() {
+  FrameScheduler scheduler;
+  scheduler.pacing = pacing_fixed;
+  scheduler.targetFPS = 50;
+  TEST_ASSERT_EQUAL_UINT32(interval, scheduler.interval());
+  const uint32_t jitter[] = {0, 3000, 500, 7000, 0, 1200};
+  uint32_t prevMillis = 0;
+  for (uint8_t i = 0; i < 6; i++) {
+    uint32_t slot = 500000 + i * interval;
+    if (i) TEST_ASSERT_FALSE(scheduler.isDue(slot - 1));
+    TEST_ASSERT_TRUE(scheduler.isDue(slot + jitter[i]));
+    frame(scheduler, slot + jitter[i]);
+    TEST_ASSERT_EQUAL(20, scheduler.frameDelta);
+    if (i) TEST_ASSERT_EQUAL_UINT32(prevMillis + 20, scheduler.frameMillis);
+    prevMillis = scheduler.frameMillis;
+    TEST_ASSERT_FALSE(scheduler.skipOptional);  // fixed: never skips
+  }
+}
+
+// a frame which misses 2 slots advances the animation 3 intervals, so effects stay in time
+void test_missed_slots() {
+  FrameScheduler scheduler;
+  scheduler.pacing = pacing_fixed;
+  scheduler.targetFPS = 50;
+  frame(scheduler, 0);
+  uint32_t millis = scheduler.frameMillis;
+  frame(scheduler, 2 * interval + 100, 5000);  // slots at 20 and 40 ms, started in the 40 ms slot
+  TEST_ASSERT_EQUAL(40, scheduler.frameDelta);
+  TEST_ASSERT_EQUAL_UINT32(millis + 40, scheduler.frameMillis);
+  frame(scheduler, 3 * interval);
+  TEST_ASSERT_EQUAL(20, scheduler.frameDelta);
+
+  // the statistics of the second are taken at the first frame of the next second
+  frame(scheduler, 1000000);
+  TEST_ASSERT_EQUAL(3, scheduler.stats.frames);
+  TEST_ASSERT_EQUAL(1, scheduler.stats.skipped);
+}
+
+// a stall of more than maxCatchUp slots (e.g. mapping) restarts the grid instead of jumping the animation ahead
+void test_stall_restarts_grid() {
+  FrameScheduler scheduler;
+  scheduler.pacing = pacing_fixed;
+  scheduler.targetFPS = 50;
+  frame(scheduler, 0);
+  frame(scheduler, 2000000);
+  TEST_ASSERT_EQUAL(20, scheduler.frameDelta);
+  TEST_ASSERT_FALSE(scheduler.isDue(2000000 + interval - 1));
+  TEST_ASSERT_TRUE(scheduler.isDue(2000000 + interval));
+}
+
+void test_deadline_skips_after_overrun() {
+  FrameScheduler scheduler;
+  scheduler.pacing = pacing_deadline;
+  scheduler.targetFPS = 50;
+  frame(scheduler, 0, 25000);  // overruns its slot
+  scheduler.beginFrame(25000);
+  TEST_ASSERT_TRUE(scheduler.skipOptional);
+  scheduler.endFrame(30000);
+  scheduler.beginFrame(40000);  // back on the grid
+  TEST_ASSERT_FALSE(scheduler.skipOptional);
+  scheduler.endFrame(45000);
+  scheduler.beginFrame(60000 + interval / 2 + 1);  // started more than half an interval late
+  TEST_ASSERT_TRUE(scheduler.skipOptional);
+}
+
+void test_target_change_starts_new_grid() {
+  FrameScheduler scheduler;
+  scheduler.pacing = pacing_fixed;
+  scheduler.targetFPS = 50;
+  frame(scheduler, 0);
+  scheduler.targetFPS = 100;
+  TEST_ASSERT_TRUE(scheduler.isDue(1000));  // new interval: due at once
+  frame(scheduler, 1000);
+  TEST_ASSERT_EQUAL(10, scheduler.frameDelta);
+  TEST_ASSERT_FALSE(scheduler.isDue(1000 + 9999));
+}
+
+// µs clock wraps after 71 minutes
+void test_clock_wraps() {
+  FrameScheduler scheduler;
+  scheduler.pacing = pacing_fixed;
+  scheduler.targetFPS = 50;
+  uint32_t start = UINT32_MAX - 30000;
+  frame(scheduler, start);
+  uint32_t millis = scheduler.frameMillis;
+  TEST_ASSERT_FALSE(scheduler.isDue(start + interval - 1));
+  frame(scheduler, start + interval);  // wrapped
+  TEST_ASSERT_EQUAL(20, scheduler.frameDelta);
+  TEST_ASSERT_EQUAL_UINT32(millis + 20, scheduler.frameMillis);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_free_uses_measured_time);
+  RUN_TEST(test_fixed_steps_one_interval);
+  RUN_TEST(test_missed_slots);
+  RUN_TEST(test_stall_restarts_grid);
+  RUN_TEST(test_deadline_skips_after_overrun);
+  RUN_TEST(test_target_change_starts_new_grid);
+  RUN_TEST(test_clock_wraps);
+  return UNITY_END();
+}
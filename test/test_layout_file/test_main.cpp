@@ -0,0 +1,135 @@
+/**
+    @title     MoonLight
+    @file      test_main.cpp
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/develop/development/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+// LayoutFile: the coordinate file formats parse to the same lights in any chunk size, and the cache records
+
+#include <unity.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "MoonLight/Nodes/Layouts/LayoutFile.h"
+
+void setUp() {}
+void tearDown() {}
+
+struct Light {
+  float x, y, z;
+  uint32_t nodeNr;
+};
+
+// lights and pins (a pin is a light with nodeNr UINT32_MAX) of text, fed in chunks of chunkSize
+static std::vector<Light> parse(const char* text, size_t chunkSize, LayoutFile::Format* format = nullptr) {
+  std::vector<Light> lights;
+  LayoutFile::Parser parser;
+  parser.onLight = [&](float x, float y, float z, uint32_t nodeNr) { lights.push_back({x, y, z, nodeNr}); };
+  parser.onPin = [&]() { lights.push_back({0, 0, 0, UINT32_MAX}); };
+  size_t length = strlen(text);
+  for (size_t offset = 0; offset < length; offset += chunkSize) parser.feed(text + offset, std::min(chunkSize, length - offset));
+  parser.finish();
+  if (format) *format = parser.format;
+  return lights;
+}
+
+static void assertLights(const std::vector<Light>& expected, const char* text) {
+  for (size_t chunkSize : {(size_t)1, (size_t)3, (size_t)7, (size_t)4096}) {
+    std::vector<Light> lights = parse(text, chunkSize);
+    TEST_ASSERT_EQUAL(expected.size(), lights.size());
+    for (size_t i = 0; i < expected.size() && i < lights.size(); i++) {
+      TEST_ASSERT_EQUAL_UINT32(expected[i].nodeNr, lights[i].nodeNr);
+      if (expected[i].nodeNr == UINT32_MAX) continue;
+      TEST_ASSERT_TRUE(expected[i].x == lights[i].x && expected[i].y == lights[i].y && expected[i].z == lights[i].z);
+    }
+  }
+}
+
+static const uint32_t pin = UINT32_MAX;
+
+void test_csv() {
+  const char* csv =
+      "x,y,z\n"
+      "0,0,0\n"
+      "1.5;2 3  # comment\r\n"
+      "\n"
+      "-1e1\t4,5,99\n"
+      "pin\n"
+      "7\n";
+  LayoutFile::Format format;
+  parse(csv, 4096, &format);
+  TEST_ASSERT_EQUAL(LayoutFile::format_csv, format);
+  assertLights({{0, 0, 0, 0}, {1.5, 2, 3, 0}, {-10, 4, 5, 0}, {0, 0, 0, pin}, {7, 0, 0, 0}}, csv);
+}
+
+void test_json() {
+  LayoutFile::Format format;
+  parse("  [[1,2,3]]", 4096, &format);
+  TEST_ASSERT_EQUAL(LayoutFile::format_json, format);
+  // the end of an array of lights is a pin (the File layout only starts a pin if it has lights)
+  assertLights({{1, 2, 3, 0}, {4, 5, 0, 0}, {0, 0, 0, pin}}, "[[1,2,3],[4,5]]");
+  assertLights({{1, 2, 3, 0}, {4, 5, 6, 0}, {0, 0, 0, pin}}, "[{\"x\":1,\"y\":2,\"z\":3},{\"x\":4,\"y\":5,\"z\":6}]");
+  // an array per pin
+  assertLights({{1, 0, 0, 0}, {2, 0, 0, 0}, {0, 0, 0, pin}, {3, 0, 0, 0}, {0, 0, 0, pin}}, "[[[1,0,0],[2,0,0]],[[3,0,0]]]");
+  assertLights({{1, 2, 0, 0}, {0, 0, 0, pin}}, "{\"name\":\"a \\\" [1,2] b\",\"lights\":[[1,2]]}");  // brackets in strings are not lights
+}
+
+void test_xlights() {
+  const char* model = "<?xml version=\"1.0\"?>\n<custommodel name=\"m\" CustomModel=\"1,,2;,3,|4\" other=\"5\"/>";
+  LayoutFile::Format format;
+  parse(model, 4096, &format);
+  TEST_ASSERT_EQUAL(LayoutFile::format_xlights, format);
+  // cell: column x, row y, layer z, the cell value is the wiring order
+  assertLights({{0, 0, 0, 1}, {2, 0, 0, 2}, {1, 1, 0, 3}, {0, 0, 1, 4}}, model);
+}
+
+void test_quantize() {
+  TEST_ASSERT_EQUAL_UINT16(0, LayoutFile::quantize(-5, -5, 10));
+  TEST_ASSERT_EQUAL_UINT16(15, LayoutFile::quantize(-3.5, -5, 10));
+  TEST_ASSERT_EQUAL_UINT16(0, LayoutFile::quantize(-6, -5, 10));
+  TEST_ASSERT_EQUAL_UINT16(LayoutFile::maxCoordinate, LayoutFile::quantize(1e9, 0, 1));  // the marker is never a coordinate
+}
+
+void test_records() {
+  uint8_t record[LayoutFile::recordSize];
+  LayoutFile::putRecord(record, 1, 300, LayoutFile::maxCoordinate);
+  TEST_ASSERT_EQUAL_UINT16(1, LayoutFile::recordValue(record, 0));
+  TEST_ASSERT_EQUAL_UINT16(300, LayoutFile::recordValue(record, 1));
+  TEST_ASSERT_EQUAL_UINT16(LayoutFile::maxCoordinate, LayoutFile::recordValue(record, 2));
+  TEST_ASSERT_EQUAL_UINT8(44, record[2]);  // little endian
+  TEST_ASSERT_EQUAL_UINT8(1, record[3]);
+}
+
+void test_cache_header() {
+  LayoutFile::CacheHeader header;
+  header.sourceHash = 1234;
+  TEST_ASSERT_TRUE(header.isValid(1234, 1));
+  TEST_ASSERT_FALSE(header.isValid(1235, 1));
+  TEST_ASSERT_FALSE(header.isValid(1234, 2));
+  header.version = LayoutFile::version - 1;  // older record format
+  TEST_ASSERT_FALSE(header.isValid(1234, 1));
+}
+
+void test_hash() {
+  const uint8_t a[] = {1, 2, 3}, b[] = {1, 2, 4};
+  TEST_ASSERT_TRUE(LayoutFile::hash(LayoutFile::hashStart, a, 3) != LayoutFile::hash(LayoutFile::hashStart, b, 3));
+  TEST_ASSERT_EQUAL_UINT32(LayoutFile::hash(LayoutFile::hash(LayoutFile::hashStart, a, 1), a + 1, 2), LayoutFile::hash(LayoutFile::hashStart, a, 3));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_csv);
+  RUN_TEST(test_json);
+  RUN_TEST(test_xlights);
+  RUN_TEST(test_quantize);
+  RUN_TEST(test_records);
+  RUN_TEST(test_cache_header);
+  RUN_TEST(test_hash);
+  return UNITY_END();
+}
@@ -0,0 +1,140 @@
+/**
+    @title     MoonLight
+    @file      test_main.cpp
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/develop/development/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+// LifeBoard: the bit parallel step gives the same generations as counting the neighbors of each cell
+
+#include <stdlib.h>
+#include <unity.h>
+
+#include <vector>
+
+#include "MoonLight/Nodes/Effects/LifeBoard.h"
+
+void setUp() {}
+void tearDown() {}
+
+static LifeBoard board;
+
+// the next generation of one cell, counted one neighbor at a time
+static bool reference(const std::vector<uint32_t>& cells, int x, int y, int z, bool wrap, bool is3D) {
+  uint8_t neighbors = 0;
+  for (int dz = is3D ? -1 : 0; dz <= (is3D ? 1 : 0); dz++)
+    for (int dy = -1; dy <= 1; dy++)
+      for (int dx = -1; dx <= 1; dx++) {
+        if (!dx && !dy && !dz) continue;
+        int nx = x + dx, ny = y + dy, nz = z + dz;
+        if (wrap) {
+          nx = (nx + board.sizeX) % board.sizeX;
+          ny = (ny + board.sizeY) % board.sizeY;
+          nz = (nz + board.sizeZ) % board.sizeZ;
+        } else if (nx < 0 || ny < 0 || nz < 0 || nx >= board.sizeX || ny >= board.sizeY || nz >= board.sizeZ)
+          continue;
+        neighbors += board.get(cells.data(), nx, ny, nz);
+      }
+  bool alive = board.get(cells.data(), x, y, z);
+  return ((alive ? board.surviveMask : board.birthMask) >> neighbors) & 1;
+}
+
+static void setRule(const char* birth, const char* survive) {
+  bool b[9] = {}, s[9] = {};
+  for (; *birth; birth++) b[*birth - '0'] = true;
+  for (; *survive; survive++) s[*survive - '0'] = true;
+  board.setRule(b, s);
+}
+
+static void compareWithReference(uint16_t x, uint16_t y, uint16_t z, bool wrap, bool is3D) {
+  board.setSize(x, y, z);
+  std::vector<uint32_t> cells(board.nrOfWords), next(board.nrOfWords);
+  srand(x * 1000 + y * 10 + z + wrap);
+  for (uint16_t cz = 0; cz < z; cz++)
+    for (uint16_t cy = 0; cy < y; cy++)
+      for (uint16_t cx = 0; cx < x; cx++) board.set(cells.data(), cx, cy, cz, rand() % 3 == 0);
+
+  for (uint8_t generation = 0; generation < 8; generation++) {
+    uint32_t alive = board.step(cells.data(), next.data(), wrap, is3D);
+    uint32_t expectedAlive = 0;
+    for (uint16_t cz = 0; cz < z; cz++)
+      for (uint16_t cy = 0; cy < y; cy++)
+        for (uint16_t cx = 0; cx < x; cx++) {
+          bool expected = reference(cells, cx, cy, cz, wrap, is3D);
+          TEST_ASSERT_EQUAL(expected, board.get(next.data(), cx, cy, cz));
+          expectedAlive += expected;
+        }
+    TEST_ASSERT_EQUAL_UINT32(expectedAlive, alive);
+    TEST_ASSERT_EQUAL_UINT32(alive, LifeBoard::count(next.data(), board.nrOfWords));  // no bits beyond sizeX
+    cells.swap(next);
+  }
+}
+
+void test_2d_as_reference() {
+  setRule("3", "23");
+  const uint16_t sizes[][2] = {{8, 8}, {31, 5}, {32, 7}, {33, 9}, {70, 12}, {1, 4}};
+  for (auto& size : sizes) {
+    compareWithReference(size[0], size[1], 1, false, false);
+    compareWithReference(size[0], size[1], 1, true, false);
+  }
+}
+
+void test_3d_as_reference() {
+  setRule("5", "45");
+  const uint16_t sizes[][3] = {{8, 8, 8}, {33, 6, 5}, {16, 3, 3}};
+  for (auto& size : sizes) {
+    compareWithReference(size[0], size[1], size[2], false, true);
+    compareWithReference(size[0], size[1], size[2], true, true);
+  }
+}
+
+void test_blinker() {
+  setRule("3", "23");
+  board.setSize(5, 5, 1);
+  std::vector<uint32_t> cells(board.nrOfWords), next(board.nrOfWords);
+  for (uint16_t x = 1; x <= 3; x++) board.set(cells.data(), x, 2, 0, true);
+  TEST_ASSERT_EQUAL_UINT32(3, board.step(cells.data(), next.data(), false, false));
+  for (uint16_t y = 1; y <= 3; y++) TEST_ASSERT_TRUE(board.get(next.data(), 2, y, 0));
+  TEST_ASSERT_FALSE(board.get(next.data(), 1, 2, 0));
+  board.step(next.data(), cells.data(), false, false);
+  for (uint16_t x = 1; x <= 3; x++) TEST_ASSERT_TRUE(board.get(cells.data(), x, 2, 0));
+}
+
+// a glider crossing the row ends and the first / last rows comes back where it started
+void test_glider_wraps() {
+  setRule("3", "23");
+  board.setSize(40, 10, 1);  // rows of 2 words
+  std::vector<uint32_t> cells(board.nrOfWords), next(board.nrOfWords), start;
+  const uint8_t glider[][2] = {{1, 0}, {2, 1}, {0, 2}, {1, 2}, {2, 2}};
+  for (auto& cell : glider) board.set(cells.data(), cell[0] + 30, cell[1] + 5, 0, true);
+  start = cells;
+  for (uint16_t generation = 0; generation < 4 * 40; generation++) {  // moves 1 cell diagonally per 4 generations
+    TEST_ASSERT_EQUAL_UINT32(5, board.step(cells.data(), next.data(), true, false));
+    cells.swap(next);
+  }
+  for (size_t i = 0; i < start.size(); i++) TEST_ASSERT_EQUAL_UINT32(start[i], cells[i]);
+}
+
+void test_mask() {
+  setRule("3", "23");
+  board.setSize(5, 5, 1);
+  std::vector<uint32_t> cells(board.nrOfWords), next(board.nrOfWords), mask(board.nrOfWords, UINT32_MAX);
+  for (uint16_t x = 1; x <= 3; x++) board.set(cells.data(), x, 2, 0, true);
+  board.set(mask.data(), 2, 1, 0, false);
+  TEST_ASSERT_EQUAL_UINT32(2, board.step(cells.data(), next.data(), false, false, mask.data()));
+  TEST_ASSERT_FALSE(board.get(next.data(), 2, 1, 0));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_2d_as_reference);
+  RUN_TEST(test_3d_as_reference);
+  RUN_TEST(test_blinker);
+  RUN_TEST(test_glider_wraps);
+  RUN_TEST(test_mask);
+  return UNITY_END();
+}
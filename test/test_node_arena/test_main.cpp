@@ -0,0 +1,140 @@
+/**
+    @title     MoonLight
+    @file      test_main.cpp
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/develop/development/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+// NodeArena: blocks carved from the region, holes, heap fallback and sweep
+
+#include <stdlib.h>
+#include <unity.h>
+
+#include "MoonLight/Layers/NodeArena.h"
+
+static uint8_t region[256];
+static NodeArena* arena;
+static int heapBlocks = 0;
+
+static void* heapAlloc(size_t size) {
+  heapBlocks++;
+  return calloc(1, size);
+}
+static void heapFree(void* p) {
+  heapBlocks--;
+  free(p);
+}
+
+void setUp() {
+  arena = new NodeArena();
+  arena->heapAlloc = heapAlloc;
+  arena->heapFree = heapFree;
+  memset(region, 0xAA, sizeof(region));
+  arena->setRegion(region, sizeof(region));
+  heapBlocks = 0;
+}
+void tearDown() {
+  arena->sweep();
+  delete arena;
+  TEST_ASSERT_EQUAL(0, heapBlocks);
+}
+
+void test_carve_aligned_and_zeroed() {
+  uint8_t *a = nullptr, *b = nullptr;
+  arena->alloc((void**)&a, 5);
+  arena->alloc((void**)&b, 16);
+  TEST_ASSERT_TRUE(a == region);
+  TEST_ASSERT_TRUE(b == region + 8);  // 5 rounded up to the alignment
+  TEST_ASSERT_TRUE(arena->contains(b));
+  for (int i = 0; i < 5; i++) TEST_ASSERT_EQUAL_UINT8(0, a[i]);
+  for (int i = 0; i < 16; i++) TEST_ASSERT_EQUAL_UINT8(0, b[i]);
+  TEST_ASSERT_EQUAL_UINT32(24, arena->stats.used);
+  TEST_ASSERT_EQUAL_UINT32(24, arena->stats.demand);
+}
+
+void test_realloc_releases_the_old_block() {
+  uint8_t* a = nullptr;
+  arena->alloc((void**)&a, 64);
+  arena->alloc((void**)&a, 32);  // last block: its bytes are given back first
+  TEST_ASSERT_TRUE(a == region);
+  TEST_ASSERT_EQUAL_UINT32(32, arena->stats.used);
+  TEST_ASSERT_EQUAL_UINT32(32, arena->stats.demand);
+}
+
+void test_holes_and_trim() {
+  uint8_t *a = nullptr, *b = nullptr, *c = nullptr;
+  arena->alloc((void**)&a, 32);
+  arena->alloc((void**)&b, 32);
+  arena->alloc((void**)&c, 32);
+  arena->release((void**)&b);
+  TEST_ASSERT_NULL(b);
+  TEST_ASSERT_EQUAL_UINT32(96, arena->stats.used);  // b is a hole below c
+  TEST_ASSERT_EQUAL_UINT32(32, arena->stats.holes);
+  arena->release((void**)&c);
+  TEST_ASSERT_EQUAL_UINT32(32, arena->stats.used);  // c and the hole below it are given back
+  TEST_ASSERT_EQUAL_UINT32(0, arena->stats.holes);
+  TEST_ASSERT_EQUAL_UINT32(96, arena->stats.peak);
+}
+
+void test_heap_fallback_when_full() {
+  uint8_t *a = nullptr, *b = nullptr;
+  arena->alloc((void**)&a, 200);
+  arena->alloc((void**)&b, 100);  // does not fit
+  TEST_ASSERT_NOT_NULL(b);
+  TEST_ASSERT_FALSE(arena->contains(b));
+  TEST_ASSERT_EQUAL(1, arena->stats.fallbacks);
+  TEST_ASSERT_EQUAL(1, heapBlocks);
+  TEST_ASSERT_EQUAL_UINT32(304, arena->stats.demand);  // 100 aligned to 104
+  arena->release((void**)&b);
+  TEST_ASSERT_EQUAL(0, heapBlocks);
+  TEST_ASSERT_EQUAL(0, arena->stats.fallbacks);
+}
+
+void test_sweep_nulls_the_owners() {
+  uint8_t *a = nullptr, *b = nullptr;
+  arena->alloc((void**)&a, 200);
+  arena->alloc((void**)&b, 100);
+  uint32_t demand = arena->sweep();
+  TEST_ASSERT_EQUAL_UINT32(304, demand);  // to grow the region to before the nodes carve again
+  TEST_ASSERT_NULL(a);
+  TEST_ASSERT_NULL(b);
+  TEST_ASSERT_EQUAL(0, heapBlocks);
+  TEST_ASSERT_EQUAL_UINT32(0, arena->stats.used);
+  TEST_ASSERT_EQUAL(1, arena->stats.sweeps);
+}
+
+void test_more_blocks_than_tracked() {
+  uint8_t* blocks[NodeArena::maxBlocks + 2] = {};
+  for (uint8_t i = 0; i < NodeArena::maxBlocks + 2; i++) arena->alloc((void**)&blocks[i], 1);
+  TEST_ASSERT_TRUE(arena->contains(blocks[NodeArena::maxBlocks - 1]));
+  TEST_ASSERT_FALSE(arena->contains(blocks[NodeArena::maxBlocks]));  // not tracked: on the heap
+  TEST_ASSERT_EQUAL(2, heapBlocks);
+  for (uint8_t i = 0; i < NodeArena::maxBlocks + 2; i++) arena->release((void**)&blocks[i]);
+  TEST_ASSERT_EQUAL(0, heapBlocks);
+}
+
+void test_no_region() {
+  arena->setRegion(nullptr, 0);
+  uint8_t* a = nullptr;
+  arena->alloc((void**)&a, 10);
+  TEST_ASSERT_NOT_NULL(a);
+  TEST_ASSERT_EQUAL(1, arena->stats.fallbacks);
+  TEST_ASSERT_NULL(arena->alloc((void**)&a, 0));
+  TEST_ASSERT_NULL(a);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_carve_aligned_and_zeroed);
+  RUN_TEST(test_realloc_releases_the_old_block);
+  RUN_TEST(test_holes_and_trim);
+  RUN_TEST(test_heap_fallback_when_full);
+  RUN_TEST(test_sweep_nulls_the_owners);
+  RUN_TEST(test_more_blocks_than_tracked);
+  RUN_TEST(test_no_region);
+  return UNITY_END();
+}
@@ -0,0 +1,176 @@
+/**
+    @title     MoonLight
+    @file      test_main.cpp
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/develop/development/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+// OutputStage: the plan of each light preset puts the colors in wire order through the right map, and copies the other channels
+
+#include <unity.h>
+
+#include "MoonLight/Nodes/Drivers/OutputStage.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const uint8_t none = UINT8_MAX;
+
+// as DriverNode::onUpdate lightPreset sets the header: channels per light, offsetRGB, offsetRGB1..3 and the red, green, blue, white offsets
+struct Preset {
+  const char* name;
+  uint8_t channelsPerLight;
+  uint8_t groups[4];
+  uint8_t red, green, blue, white;
+};
+
+static const Preset presets[] = {
+    {"RGB", 3, {0, none, none, none}, 0, 1, 2, none},
+    {"RBG", 3, {0, none, none, none}, 0, 2, 1, none},
+    {"GRB", 3, {0, none, none, none}, 1, 0, 2, none},
+    {"GBR", 3, {0, none, none, none}, 2, 0, 1, none},
+    {"BRG", 3, {0, none, none, none}, 1, 2, 0, none},
+    {"BGR", 3, {0, none, none, none}, 2, 1, 0, none},
+    {"RGBW", 4, {0, none, none, none}, 0, 1, 2, 3},
+    {"GRBW", 4, {0, none, none, none}, 1, 0, 2, 3},
+    {"WRGB", 4, {0, none, none, none}, 1, 2, 3, 0},
+    {"Curtain GRB6", 6, {0, none, none, none}, 1, 0, 2, none},
+    {"Curtain RGB2040", 3, {0, none, none, none}, 0, 1, 2, none},
+    {"Lightbar RGBWYP", 6, {0, none, none, none}, 0, 1, 2, 3},
+    {"MH BeeEyes 150W-15", 15, {10, none, none, none}, 0, 1, 2, none},
+    {"MH BeTopper 19x15W-32", 32, {9, 13, 17, 24}, 0, 1, 2, none},
+    {"MH 19x15W-24", 24, {4, 8, 12, none}, 0, 1, 2, none},
+};
+
+// a different map per color, to see which map is used
+static uint8_t maps8[4][256];
+static OutputStage::Maps maps;
+
+static void makeMaps() {
+  for (uint16_t v = 0; v < 256; v++) {
+    maps8[0][v] = v / 2;
+    maps8[1][v] = v / 3 + 1;
+    maps8[2][v] = 255 - v;
+    maps8[3][v] = v ^ 0x55;
+  }
+  for (uint8_t c = 0; c < 4; c++) maps.map8[c] = maps8[c];
+}
+
+// the conversion per light as the drivers did it before the plan: copy the light, then each color of each group through its map
+static void reference(const Preset& preset, uint8_t* out, const uint8_t* in) {
+  memcpy(out, in, preset.channelsPerLight);
+  const uint8_t order[4] = {preset.red, preset.green, preset.blue, preset.white};
+  for (uint8_t group : preset.groups) {
+    if (group == none) continue;
+    for (uint8_t c = 0; c < (preset.white != none ? 4 : 3); c++)
+      if (group + order[c] < preset.channelsPerLight && group + c < preset.channelsPerLight) out[group + order[c]] = maps8[c][in[group + c]];
+  }
+}
+
+static OutputStage compile(const Preset& preset) {
+  OutputStage stage;
+  stage.compile(preset.channelsPerLight, preset.groups, 4, preset.red, preset.green, preset.blue, preset.white);
+  return stage;
+}
+
+void test_presets_as_reference() {
+  makeMaps();
+  const uint16_t nrOfLights = 7;
+  for (const Preset& preset : presets) {
+    OutputStage stage = compile(preset);
+    TEST_ASSERT_EQUAL(preset.channelsPerLight, stage.channelsPerLight);
+    uint8_t in[32 * nrOfLights], out[32 * nrOfLights], expected[32 * nrOfLights];
+    for (uint16_t i = 0; i < sizeof(in); i++) in[i] = i * 37 + 11;
+    memset(out, 0xEE, sizeof(out));
+    stage.apply(out, in, nrOfLights, 0, maps);
+    for (uint16_t light = 0; light < nrOfLights; light++) reference(preset, &expected[light * preset.channelsPerLight], &in[light * preset.channelsPerLight]);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(expected, out, nrOfLights * preset.channelsPerLight, preset.name);
+  }
+}
+
+void test_grb_wire_order() {
+  makeMaps();
+  OutputStage stage = compile(presets[2]);
+  const uint8_t in[3] = {100, 60, 10};  // red, green, blue in channelsD
+  uint8_t out[3];
+  stage.apply(out, in, 1, 0, maps);
+  TEST_ASSERT_EQUAL_UINT8(maps8[1][60], out[0]);  // green first
+  TEST_ASSERT_EQUAL_UINT8(maps8[0][100], out[1]);
+  TEST_ASSERT_EQUAL_UINT8(maps8[2][10], out[2]);
+}
+
+void test_wrgb_white_first() {
+  makeMaps();
+  OutputStage stage = compile(presets[8]);
+  const uint8_t in[4] = {1, 2, 3, 4};
+  uint8_t out[4];
+  stage.apply(out, in, 1, 0, maps);
+  TEST_ASSERT_EQUAL_UINT8(maps8[3][4], out[0]);
+  TEST_ASSERT_EQUAL_UINT8(maps8[0][1], out[1]);
+  TEST_ASSERT_EQUAL_UINT8(maps8[1][2], out[2]);
+  TEST_ASSERT_EQUAL_UINT8(maps8[2][3], out[3]);
+}
+
+// pan, tilt, zoom ... of a moving head are copied as is
+void test_moving_head_channels_copied() {
+  makeMaps();
+  OutputStage stage = compile(presets[12]);
+  uint8_t in[15], out[15];
+  for (uint8_t i = 0; i < 15; i++) in[i] = 200 + i;
+  stage.apply(out, in, 1, 0, maps);
+  for (uint8_t i = 0; i < 10; i++) TEST_ASSERT_EQUAL_UINT8(in[i], out[i]);
+  TEST_ASSERT_EQUAL_UINT8(maps8[0][in[10]], out[10]);
+  TEST_ASSERT_EQUAL_UINT8(maps8[2][in[12]], out[12]);
+  for (uint8_t i = 13; i < 15; i++) TEST_ASSERT_EQUAL_UINT8(in[i], out[i]);
+}
+
+// a range of lights in one call gives the same as one call per light
+void test_range_as_per_light() {
+  makeMaps();
+  for (const Preset& preset : presets) {
+    OutputStage stage = compile(preset);
+    uint8_t in[32 * 5], range[32 * 5], perLight[32 * 5];
+    for (uint16_t i = 0; i < sizeof(in); i++) in[i] = i * 13;
+    stage.apply(range, in, 5, 0, maps);
+    for (uint16_t light = 0; light < 5; light++) stage.apply(&perLight[light * preset.channelsPerLight], &in[light * preset.channelsPerLight], 1, light * preset.channelsPerLight, maps);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(perLight, range, 5 * preset.channelsPerLight, preset.name);
+  }
+}
+
+// with dither the 8.8 LUT and the threshold of the channel index in channelsD are used
+void test_dither() {
+  makeMaps();
+  static Dither::Lut lut;
+  const uint8_t* const mapPointers[4] = {maps8[0], maps8[1], maps8[2], maps8[3]};
+  lut.build(mapPointers);
+  OutputStage::Maps ditherMaps = maps;
+  ditherMaps.dither = &lut;
+  ditherMaps.threshold = Dither::frameThreshold(5);
+
+  OutputStage stage = compile(presets[7]);  // GRBW
+  uint8_t in[4 * 3], out[4 * 3];
+  for (uint8_t i = 0; i < sizeof(in); i++) in[i] = i * 21;
+  const uint32_t index = 400;  // of in in channelsD
+  stage.apply(out, in, 3, index, ditherMaps);
+  const uint8_t order[4] = {1, 0, 2, 3};
+  for (uint8_t light = 0; light < 3; light++)
+    for (uint8_t c = 0; c < 4; c++) {
+      uint32_t channel = light * 4 + c;
+      TEST_ASSERT_EQUAL_UINT8(Dither::apply(lut.map[c][in[channel]], Dither::threshold(ditherMaps.threshold, index + channel)), out[light * 4 + order[c]]);
+    }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_presets_as_reference);
+  RUN_TEST(test_grb_wire_order);
+  RUN_TEST(test_wrgb_white_first);
+  RUN_TEST(test_moving_head_channels_copied);
+  RUN_TEST(test_range_as_per_light);
+  RUN_TEST(test_dither);
+  return UNITY_END();
+}
@@ -0,0 +1,133 @@
+/**
+    @title     MoonBase
+    @file      test_main.cpp
+    @repo      https://github.com/MoonModules/MoonLight, submit changes to this file as PRs
+    @Authors   https://github.com/MoonModules/MoonLight/commits/main
+    @Doc       https://moonmodules.org/MoonLight/develop/development/
+    @Copyright © 2025 Github MoonLight Commit Authors
+    @license   GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007
+    @license   For non GPL-v3 usage, commercial licenses must be purchased. Contact us for more information.
+**/
+
+// UpdateBus: topics reach the subscribers of the topic and of its folders, once per deliver
+
+#include <unity.h>
+
+#include <string>
+#include <vector>
+
+#include "MoonBase/UpdateBus.h"
+
+static UpdateBus* bus;
+static std::vector<std::string> calls;  // "name topic origin"
+
+static UpdateBus::Callback record(const char* name) {
+  std::string prefix = name;
+  return [prefix](const char* topic, const char* originId) { calls.push_back(prefix + " " + topic + " " + originId); };
+}
+
+void setUp() {
+  bus = new UpdateBus();
+  calls.clear();
+}
+void tearDown() { delete bus; }
+
+void test_topic_and_prefixes() {
+  bus->subscribe("/.config/presets/preset01.json", record("file"));
+  bus->subscribe("/.config/presets/", record("folder"));
+  bus->subscribe("/", record("all"));
+  bus->subscribe("/.config/presets", record("noSlash"));  // not a prefix: only this topic
+  bus->publish("/.config/presets/preset01.json", "ui");
+  TEST_ASSERT_EQUAL(3, bus->deliver());
+  TEST_ASSERT_EQUAL(3, calls.size());
+  TEST_ASSERT_EQUAL_STRING("all /.config/presets/preset01.json ui", calls[0].c_str());  // shortest prefix first
+  TEST_ASSERT_EQUAL_STRING("folder /.config/presets/preset01.json ui", calls[1].c_str());
+  TEST_ASSERT_EQUAL_STRING("file /.config/presets/preset01.json ui", calls[2].c_str());
+}
+
+void test_module_controls() {
+  bus->subscribe("inputoutput/pins", record("pins"));
+  bus->subscribe("inputoutput/", record("io"));
+  bus->publish("inputoutput/maxPower", "server");
+  bus->publish("lightscontrol/brightness", "server");  // no subscribers: dropped
+  TEST_ASSERT_EQUAL(1, bus->pending());
+  bus->deliver();
+  TEST_ASSERT_EQUAL(1, calls.size());
+  TEST_ASSERT_EQUAL_STRING("io inputoutput/maxPower server", calls[0].c_str());
+}
+
+// the same topic published twice before deliver is delivered once
+void test_coalescing() {
+  bus->subscribe("inputoutput/pins", record("pins"));
+  bus->subscribe("inputoutput/maxPower", record("power"));
+  bus->publish("inputoutput/pins", "ui");
+  bus->publish("inputoutput/maxPower", "ui");
+  bus->publish("inputoutput/pins", "ui");
+  TEST_ASSERT_EQUAL(2, bus->pending());
+  TEST_ASSERT_EQUAL(2, bus->deliver());
+  TEST_ASSERT_EQUAL_STRING("pins inputoutput/pins ui", calls[0].c_str());  // in the order of the first publish
+  TEST_ASSERT_EQUAL(0, bus->deliver());
+}
+
+// a change in the UI followed by the write of the state to the file: both are delivered, in that order
+void test_origins_not_coalesced() {
+  bus->subscribe("/.config/effects.json", record("effects"));
+  bus->publish("/.config/effects.json", "ui");
+  bus->publish("/.config/effects.json", "FSPersistence");
+  bus->publish("/.config/effects.json", "ui");
+  TEST_ASSERT_EQUAL(2, bus->pending());
+  TEST_ASSERT_EQUAL(2, bus->deliver());
+  TEST_ASSERT_EQUAL_STRING("effects /.config/effects.json ui", calls[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("effects /.config/effects.json FSPersistence", calls[1].c_str());
+}
+
+void test_unsubscribe() {
+  UpdateBus::Id id = bus->subscribe("/a/", record("a"));
+  bus->subscribe("/a/", record("b"));
+  bus->unsubscribe(id);
+  bus->unsubscribe(id);  // twice is harmless
+  bus->publish("/a/x", "ui");
+  bus->deliver();
+  TEST_ASSERT_EQUAL(1, calls.size());
+  TEST_ASSERT_EQUAL_STRING("b /a/x ui", calls[0].c_str());
+  TEST_ASSERT_EQUAL(id, bus->subscribe("/c", record("c")));  // id reused
+}
+
+// a callback can publish, it is delivered at the next deliver
+void test_publish_in_callback() {
+  bus->subscribe("/a", [](const char*, const char*) { bus->publish("/b", "a"); });
+  bus->subscribe("/b", record("b"));
+  bus->publish("/a", "ui");
+  TEST_ASSERT_EQUAL(1, bus->deliver());
+  TEST_ASSERT_EQUAL(1, bus->deliver());
+  TEST_ASSERT_EQUAL_STRING("b /b a", calls[0].c_str());
+}
+
+static uint32_t fakeClock = 0;
+
+void test_stats() {
+  bus->clock = []() { return fakeClock; };
+  bus->subscribe("/a", [](const char*, const char*) { fakeClock += 50; }, "slow");
+  fakeClock = 1000;
+  bus->publish("/a", "ui");
+  fakeClock = 1300;
+  bus->deliver();
+  bus->forEach([](const UpdateBus::Subscriber& subscriber) {
+    TEST_ASSERT_EQUAL_STRING("slow", subscriber.name.c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, subscriber.stats.calls);
+    TEST_ASSERT_EQUAL_UINT32(300, subscriber.stats.latencyMax);
+    TEST_ASSERT_EQUAL_UINT32(50, subscriber.stats.durationMax);
+  });
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_topic_and_prefixes);
+  RUN_TEST(test_module_controls);
+  RUN_TEST(test_coalescing);
+  RUN_TEST(test_origins_not_coalesced);
+  RUN_TEST(test_unsubscribe);
+  RUN_TEST(test_publish_in_callback);
+  RUN_TEST(test_stats);
+  return UNITY_END();
+}